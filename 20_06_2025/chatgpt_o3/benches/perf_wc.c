@@ -0,0 +1,338 @@
+// benches/perf_wc.c
+// Counter-based microbenchmark for the counting kernels. Every kernel runs
+// on in-memory buffers of each input class with perf_event_open counters
+// around each call. Runs repeat until the 95% confidence interval of the
+// cost per call is within --ci percent of the mean. Reported per kernel
+// and input: bytes/cycle, IPC, branch-miss rate and cache/TLB misses per
+// KiB.
+// Degrades step by step when counters are missing:
+//   hardware counters  cycles, instructions, branches, misses
+//   no PMU (VMs, containers)  the task-clock software counter, CPU time
+//   no perf events at all  (seccomp, paranoid >= 3, not Linux)  wall time
+//   ./perf_wc [--size=BYTES] [--ci=PCT] [--min-runs=N] [--max-runs=N] [--max-secs=S]
+//             [--kernel=NAME] [--input=NAME] [--no-counters]
+#define _GNU_SOURCE  // sched_getcpu, sched_setaffinity
+#include "wc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// ---- counters ----
+
+enum { EV_CYCLES, EV_INSTRUCTIONS, EV_BRANCHES, EV_BRANCH_MISSES,
+       EV_L1D_MISSES, EV_LLC_MISSES, EV_DTLB_MISSES, EV_TASK_CLOCK, NEVENTS };
+
+#ifdef __linux__
+#define HW_CACHE(cache,op,result) \
+    (PERF_COUNT_HW_CACHE_##cache|(PERF_COUNT_HW_CACHE_OP_##op<<8)|(PERF_COUNT_HW_CACHE_RESULT_##result<<16))
+static const struct { const char *name; uint32_t type; uint64_t config; } events[NEVENTS]={
+    {"cycles",PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions",PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS},
+    {"branches",PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+    {"branch-misses",PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES},
+    {"L1D-misses",PERF_TYPE_HW_CACHE,HW_CACHE(L1D,READ,MISS)},
+    {"LLC-misses",PERF_TYPE_HW_CACHE,HW_CACHE(LL,READ,MISS)},
+    {"dTLB-misses",PERF_TYPE_HW_CACHE,HW_CACHE(DTLB,READ,MISS)},
+    {"task-clock",PERF_TYPE_SOFTWARE,PERF_COUNT_SW_TASK_CLOCK},
+};
+#else
+static const struct { const char *name; } events[NEVENTS]={
+    {"cycles"},{"instructions"},{"branches"},{"branch-misses"},
+    {"L1D-misses"},{"LLC-misses"},{"dTLB-misses"},{"task-clock"},
+};
+#endif
+
+// One group, so every member counts exactly the same instructions. A
+// member the CPU lacks is left out; a group too big for the PMU is never
+// scheduled, and is shrunk from the cache events down until it fits.
+typedef struct {
+    int fd[NEVENTS];      // -1: not counted
+    int slot[NEVENTS];    // position in the group read
+    int leader,n;
+} counters_t;
+
+static void counters_close(counters_t *pc){
+    for(int e=0;e<NEVENTS;e++){ if(pc->fd[e]>=0) close(pc->fd[e]); pc->fd[e]=-1; }
+    pc->leader=-1; pc->n=0;
+}
+
+#ifdef __linux__
+static int perf_open(int e,int group){
+    struct perf_event_attr a;
+    memset(&a,0,sizeof(a));
+    a.size=sizeof(a);
+    a.type=events[e].type;
+    a.config=events[e].config;
+    a.disabled=group<0;   // members follow the leader
+    a.exclude_kernel=1;   // allowed at perf_event_paranoid 2, and the kernels make no syscalls
+    a.exclude_hv=1;
+    a.read_format=PERF_FORMAT_GROUP|PERF_FORMAT_TOTAL_TIME_ENABLED|PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open,&a,0,-1,group,0);
+}
+#endif
+
+// Open the events in want[]; the first error is kept for the report
+static void counters_open(counters_t *pc,const int *want,int *err){
+    for(int e=0;e<NEVENTS;e++) pc->fd[e]=-1;
+    pc->leader=-1; pc->n=0;
+#ifdef __linux__
+    for(int e=0;e<NEVENTS;e++){
+        if(!want[e]) continue;
+        int fd=perf_open(e,pc->leader<0?-1:pc->fd[pc->leader]);
+        if(fd<0){ if(!*err) *err=errno; continue; }
+        pc->fd[e]=fd;
+        pc->slot[e]=pc->n++;
+        if(pc->leader<0) pc->leader=e;
+    }
+#else
+    (void)want;
+    *err=ENOSYS;
+#endif
+}
+
+typedef struct {
+    double v[NEVENTS];
+    int scheduled;
+} sample_t;
+
+static void counters_start(counters_t *pc){
+#ifdef __linux__
+    if(pc->leader<0) return;
+    ioctl(pc->fd[pc->leader],PERF_EVENT_IOC_RESET,PERF_IOC_FLAG_GROUP);
+    ioctl(pc->fd[pc->leader],PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+#else
+    (void)pc;
+#endif
+}
+
+static void counters_stop(counters_t *pc,sample_t *s){
+    memset(s,0,sizeof(*s));
+#ifdef __linux__
+    if(pc->leader<0) return;
+    ioctl(pc->fd[pc->leader],PERF_EVENT_IOC_DISABLE,PERF_IOC_FLAG_GROUP);
+    uint64_t buf[3+NEVENTS];
+    if(read(pc->fd[pc->leader],buf,sizeof(buf))<(ssize_t)(3*sizeof(uint64_t))) return;
+    // nr, time enabled, time running, then one value per member
+    s->scheduled=buf[2]>0;
+    for(int e=0;e<NEVENTS;e++)
+        if(pc->fd[e]>=0&&(uint64_t)pc->slot[e]<buf[0]) s->v[e]=(double)buf[3+pc->slot[e]];
+#else
+    (void)pc;
+#endif
+}
+
+// ---- kernels and inputs ----
+
+static volatile uint64_t sink;  // keeps results live
+
+static void run_count(const uint8_t *d,size_t n){
+    wc_counts_t c={0}; wc_count_buffer(d,n,&c); sink+=c.lines+c.words;
+}
+static void run_partial(const uint8_t *d,size_t n){
+    wc_partial_t p; wc_partial_count(d,n,0,n,&p); sink+=p.counts.words;
+}
+static void run_fields(const uint8_t *d,size_t n){
+    wc_fields_t f; wc_fields_count(d,n,',',&f); sink+=f.fields;
+}
+
+static const struct { const char *name; void (*run)(const uint8_t*,size_t); } kernels[]={
+    {"count",run_count},
+    {"partial",run_partial},
+    {"fields",run_fields},
+};
+#define NKERNELS (sizeof(kernels)/sizeof(kernels[0]))
+
+static uint64_t xorshift(uint64_t *s){ *s^=*s<<13; *s^=*s>>7; *s^=*s<<17; return *s; }
+
+static void fill_text(uint8_t *b,size_t n){ for(size_t i=0;i<n;i++) b[i]="lorem ipsum\tdolor sit\n"[i%22]; }
+static void fill_alt(uint8_t *b,size_t n){ for(size_t i=0;i<n;i++) b[i]=i&1?' ':'a'; }
+static void fill_word(uint8_t *b,size_t n){ memset(b,'x',n); }
+static void fill_random(uint8_t *b,size_t n){
+    uint64_t s=0x9e3779b97f4a7c15ULL;
+    for(size_t i=0;i<n;i++) b[i]=(uint8_t)xorshift(&s);
+}
+static void fill_csv(uint8_t *b,size_t n){
+    char line[64];
+    size_t off=0;
+    for(unsigned i=0;off<n;i++){
+        int k=snprintf(line,sizeof(line),"%u,\"name, %u\",\"two\nlines\",%s\n",i,i*7,i%3?"x":"y,z");
+        size_t m=(size_t)k<n-off?(size_t)k:n-off;
+        memcpy(b+off,line,m);
+        off+=m;
+    }
+}
+
+static const struct { const char *name; void (*fill)(uint8_t*,size_t); } inputs[]={
+    {"text",fill_text},      // ordinary prose
+    {"alt",fill_alt},        // a class change at every byte
+    {"word",fill_word},      // one word, no transitions
+    {"random",fill_random},  // unpredictable classes
+    {"csv",fill_csv},        // quoted CSV, for the fields kernel
+};
+#define NINPUTS (sizeof(inputs)/sizeof(inputs[0]))
+
+// ---- statistics ----
+
+static double now_ns(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec*1e9+ts.tv_nsec;
+}
+
+// Two-sided 95% Student t quantile for df degrees of freedom
+static double t95(long df){
+    static const double t[]={12.706,4.303,3.182,2.776,2.571,2.447,2.365,2.306,2.262,2.228,
+                             2.201,2.179,2.160,2.145,2.131,2.120,2.110,2.101,2.093,2.086,
+                             2.080,2.074,2.069,2.064,2.060,2.056,2.052,2.048,2.045,2.042};
+    return df<1?INFINITY:df<=30?t[df-1]:1.96;
+}
+
+typedef struct {
+    long n;
+    double mean[NEVENTS+1],m2;  // [NEVENTS]: wall ns; m2 of the cost metric
+} stats_t;
+
+static int parse_size(const char *s,size_t *out){
+    char *end;
+    unsigned long long v=strtoull(s,&end,10);
+    if(end==s) return -1;
+    switch(*end){
+        case 'G': v<<=10; /* fall through */
+        case 'M': v<<=10; /* fall through */
+        case 'K': v<<=10; end++; break;
+    }
+    if(*end||v==0) return -1;
+    *out=(size_t)v;
+    return 0;
+}
+
+static void usage(const char *prog){
+    fprintf(stderr,"Usage: %s [--size=BYTES] [--ci=PCT] [--min-runs=N] [--max-runs=N] [--max-secs=S]\n"
+                   "          [--kernel=NAME] [--input=NAME] [--no-counters]\n"
+                   "  BYTES takes K/M/G suffixes (default 4M); PCT defaults to 1\n",prog);
+}
+
+int main(int argc,char **argv){
+    size_t size=4u<<20;
+    double ci=1.0,max_secs=2.0;
+    long min_runs=10,max_runs=10000;
+    const char *only_kernel=NULL,*only_input=NULL;
+    int use_counters=1;
+    for(int i=1;i<argc;i++){
+        const char *a=argv[i];
+        if(!strncmp(a,"--size=",7)){ if(parse_size(a+7,&size)){usage(argv[0]);return 1;} }
+        else if(!strncmp(a,"--ci=",5)) ci=atof(a+5);
+        else if(!strncmp(a,"--min-runs=",11)) min_runs=atol(a+11);
+        else if(!strncmp(a,"--max-runs=",11)) max_runs=atol(a+11);
+        else if(!strncmp(a,"--max-secs=",11)) max_secs=atof(a+11);
+        else if(!strncmp(a,"--kernel=",9)) only_kernel=a+9;
+        else if(!strncmp(a,"--input=",8)) only_input=a+8;
+        else if(!strcmp(a,"--no-counters")) use_counters=0;
+        else {usage(argv[0]);return 1;}
+    }
+    if(ci<=0||min_runs<2||max_runs<min_runs||max_secs<=0){usage(argv[0]);return 1;}
+
+#ifdef __linux__
+    // Stay on one CPU: a migration mid-run mixes two caches and two clocks
+    int cpu=sched_getcpu();
+    if(cpu>=0){ cpu_set_t set; CPU_ZERO(&set); CPU_SET(cpu,&set); sched_setaffinity(0,sizeof(set),&set); }
+#endif
+
+    uint8_t *buf=malloc(size);
+    if(!buf){perror("malloc");return 1;}
+
+    // Open what this machine has, then shrink the group until it schedules
+    counters_t pc;
+    int want[NEVENTS],err=0;
+    for(int e=0;e<NEVENTS;e++) want[e]=use_counters;
+    counters_open(&pc,want,&err);
+    fill_text(buf,size);
+    for(int e=EV_DTLB_MISSES;pc.leader>=0;e--){
+        sample_t s;
+        counters_start(&pc); run_count(buf,size); counters_stop(&pc,&s);
+        if(s.scheduled) break;
+        counters_close(&pc);
+        // Drop the cache events one at a time, then every hardware event
+        if(e>=EV_L1D_MISSES) want[e]=0;
+        else if(want[EV_CYCLES]) for(int h=0;h<EV_TASK_CLOCK;h++) want[h]=0;
+        else break;
+        counters_open(&pc,want,&err);
+    }
+    int hw=pc.fd[EV_CYCLES]>=0,cpu_clock=pc.fd[EV_TASK_CLOCK]>=0;
+    // Cost per call that the confidence interval is taken over
+    int cost=hw?EV_CYCLES:cpu_clock?EV_TASK_CLOCK:NEVENTS;
+    printf("counters:");
+    for(int e=0;e<NEVENTS;e++) if(pc.fd[e]>=0) printf(" %s",events[e].name);
+    if(pc.leader<0) printf(" none, wall clock only");
+    printf("\nspan kernel: %s (WC_KERNEL=NAME to pin another)\n",wc_kernel_name());
+    if(use_counters&&!hw)
+        fprintf(stderr,"perf_event_open: %s; no hardware counters, timing with %s\n",
+                err?strerror(err):"group never scheduled",cpu_clock?"task-clock":"the wall clock");
+
+    printf("%-8s %-7s %6s %7s %8s %9s %6s %8s %8s %8s %8s\n","kernel","input","runs","+-95%",
+           "GiB/s","bytes/cyc","IPC","br-miss%","L1D/KiB","LLC/KiB","dTLB/KiB");
+    int unconverged=0;
+    for(size_t ii=0;ii<NINPUTS;ii++){
+        if(only_input&&strcmp(only_input,inputs[ii].name)) continue;
+        inputs[ii].fill(buf,size);
+        for(size_t ki=0;ki<NKERNELS;ki++){
+            if(only_kernel&&strcmp(only_kernel,kernels[ki].name)) continue;
+            stats_t st;
+            memset(&st,0,sizeof(st));
+            kernels[ki].run(buf,size);  // warm caches, TLB and branch predictors
+            double t_end=now_ns()+max_secs*1e9,half=INFINITY;
+            while(st.n<max_runs){
+                sample_t s;
+                double t0=now_ns();
+                counters_start(&pc);
+                kernels[ki].run(buf,size);
+                counters_stop(&pc,&s);
+                double wall=now_ns()-t0;
+                // Welford: running means of every counter, variance of the cost
+                st.n++;
+                double x=cost<NEVENTS?s.v[cost]:wall,delta=x-st.mean[cost];
+                for(int e=0;e<NEVENTS;e++) st.mean[e]+=(s.v[e]-st.mean[e])/st.n;
+                st.mean[NEVENTS]+=(wall-st.mean[NEVENTS])/st.n;
+                st.m2+=delta*(x-st.mean[cost]);
+                half=st.n>1?t95(st.n-1)*sqrt(st.m2/(st.n-1)/st.n):INFINITY;
+                if(st.n>=min_runs&&half<=ci/100.0*st.mean[cost]) break;
+                if(st.n>=min_runs&&now_ns()>t_end) break;
+            }
+            const double *m=st.mean;
+            double rel=m[cost]>0?100.0*half/m[cost]:INFINITY;
+            int converged=rel<=ci;
+            unconverged+=!converged;
+            // task-clock counts nanoseconds of CPU time
+            double ns=cpu_clock?m[EV_TASK_CLOCK]:m[NEVENTS];
+            char col[6][16];
+            double kib=size/1024.0;
+#define COL(i,ok,fmt,v) ((ok)?snprintf(col[i],sizeof(col[i]),fmt,v):snprintf(col[i],sizeof(col[i]),"-"))
+            COL(0,hw,"%.3f",size/m[EV_CYCLES]);
+            COL(1,hw&&pc.fd[EV_INSTRUCTIONS]>=0,"%.2f",m[EV_INSTRUCTIONS]/m[EV_CYCLES]);
+            COL(2,pc.fd[EV_BRANCHES]>=0&&pc.fd[EV_BRANCH_MISSES]>=0&&m[EV_BRANCHES]>0,"%.3f",
+                100.0*m[EV_BRANCH_MISSES]/m[EV_BRANCHES]);
+            COL(3,pc.fd[EV_L1D_MISSES]>=0,"%.2f",m[EV_L1D_MISSES]/kib);
+            COL(4,pc.fd[EV_LLC_MISSES]>=0,"%.3f",m[EV_LLC_MISSES]/kib);
+            COL(5,pc.fd[EV_DTLB_MISSES]>=0,"%.3f",m[EV_DTLB_MISSES]/kib);
+#undef COL
+            printf("%-8s %-7s %6ld %6.2f%%%s %8.2f %9s %6s %8s %8s %8s %8s\n",kernels[ki].name,
+                   inputs[ii].name,st.n,rel,converged?" ":"*",size/ns*1e9/(1u<<30),
+                   col[0],col[1],col[2],col[3],col[4],col[5]);
+            fflush(stdout);
+        }
+    }
+    if(unconverged) printf("* interval wider than %.2f%% after --max-secs or --max-runs\n",ci);
+    counters_close(&pc);
+    free(buf);
+    return 0;
+}
@@ -1,4 +1,21 @@
 make          # build wc
 make test     # correctness & corner-case checks
 make bench FILE=/path/to/large/file  # quick throughput benchmark
+make bench-fields FILE=data.csv DELIM=,  # quote-aware --fields scan
+make bench-sparse GIB=100            # sparse file, 1% data: SEEK_DATA/SEEK_HOLE vs full scan
+make bench-perf ARGS="--ci=0.5"      # per-kernel bytes/cycle, IPC, branch/cache misses (perf_event_open)
 
+# Split counting: any process (or host sharing the file) counts a byte range,
+# and the serialised partials merge to exactly the serial result
+./wc --range=0:1G big.log > part0; ./wc --range=1G: big.log > part1
+./wc --merge part0 part1
+make mpi-test NP=4   # same thing under mpirun on one box (needs an MPI)
+
+# CSV/TSV shape: records, fields, min and max fields per record; delimiters
+# and newlines inside double quotes do not count. Works with --range/--merge.
+./wc --fields=, data.csv; ./wc --fields='\t' data.tsv
+mpirun -np 4 ./wc_mpi --fields=, data.csv
+
+# One binary for every CPU: the line/word kernel (avx512bw, avx2, sse4.2,
+# neon or scalar) is picked at runtime; WC_KERNEL=NAME pins one
+./wc --print-kernel
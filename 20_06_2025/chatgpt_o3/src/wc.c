@@ -1,21 +1,143 @@
-###############################################################################
-# src/wc.c
+// src/wc.c
+#define _GNU_SOURCE  // mmap, getopt_long, SEEK_DATA/SEEK_HOLE under -std=c11 on glibc
 #include "wc.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#if defined(__ARM_NEON)
 #include <arm_neon.h>
+#endif
 
 static inline uint8_t is_ascii_space(uint8_t c){
     return (c==' '||c=='\n'||c=='\t'||c=='\r'||c=='\f'||c=='\v');
 }
 
-void wc_count_buffer(const uint8_t *data,size_t len,wc_counts_t *out){
-    uint64_t lines=0,words=0,bytes=len;
-    uint8_t in_word=0;
+// ---- counting kernels ----
+// Every kernel is compiled into the one binary with its own target
+// attribute, and the best the running CPU supports is resolved on first
+// use, so no -march flag is needed for SIMD. A kernel adds the lines and
+// words of one span; *state carries "inside a word" across spans.
+typedef void (*span_kernel_fn)(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state);
+
+static void span_scalar(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state){
+    uint64_t lines=0,words=0;
+    uint8_t in_word=*state;
+    const uint8_t *ptr=data,*end=data+len;
+    while(ptr<end){
+        uint8_t c=*ptr++;
+        if(c=='\n') lines++;
+        uint8_t is_ws=is_ascii_space(c);
+        if(!is_ws && !in_word){
+            words++;
+            in_word=1;
+        }else if(is_ws){
+            in_word=0;
+        }
+    }
+    out->lines+=lines;
+    out->words+=words;
+    *state=in_word;
+}
+
+#if (defined(__x86_64__)||defined(__i386__))&&defined(__GNUC__)&&!defined(WC_SCALAR)
+#define WC_X86_KERNELS 1
+#include <immintrin.h>
+
+// Whitespace is ' ' or 9..13, i.e. (c-'\t') <= 4 unsigned; a word starts at
+// each non-space byte whose predecessor is a space, taken on the movemask
+// bits with the previous block's last bit shifted in.
+__attribute__((target("sse4.2,popcnt")))
+static void span_sse42(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state){
+    const __m128i nl=_mm_set1_epi8('\n'),sp=_mm_set1_epi8(' ');
+    const __m128i tab=_mm_set1_epi8('\t'),four=_mm_set1_epi8(4);
+    uint32_t prev=*state;
+    uint64_t lines=0,words=0;
+    size_t i=0;
+    for(;i+16<=len;i+=16){
+        __m128i v=_mm_loadu_si128((const __m128i*)(data+i));
+        __m128i t=_mm_sub_epi8(v,tab);
+        __m128i ws=_mm_or_si128(_mm_cmpeq_epi8(v,sp),_mm_cmpeq_epi8(_mm_min_epu8(t,four),t));
+        uint32_t ns=~(uint32_t)_mm_movemask_epi8(ws)&0xFFFF;
+        lines+=(uint64_t)_mm_popcnt_u32((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v,nl)));
+        words+=(uint64_t)_mm_popcnt_u32(ns&~((ns<<1)|prev));
+        prev=ns>>15;
+    }
+    out->lines+=lines;
+    out->words+=words;
+    *state=(uint8_t)prev;
+    span_scalar(data+i,len-i,out,state);
+}
+
+__attribute__((target("avx2,popcnt")))
+static void span_avx2(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state){
+    const __m256i nl=_mm256_set1_epi8('\n'),sp=_mm256_set1_epi8(' ');
+    const __m256i tab=_mm256_set1_epi8('\t'),four=_mm256_set1_epi8(4);
+    uint64_t prev=*state;
+    uint64_t lines=0,words=0;
+    size_t i=0;
+    for(;i+32<=len;i+=32){
+        __m256i v=_mm256_loadu_si256((const __m256i*)(data+i));
+        __m256i t=_mm256_sub_epi8(v,tab);
+        __m256i ws=_mm256_or_si256(_mm256_cmpeq_epi8(v,sp),_mm256_cmpeq_epi8(_mm256_min_epu8(t,four),t));
+        uint64_t ns=~(uint32_t)_mm256_movemask_epi8(ws)&0xFFFFFFFFu;
+        lines+=(uint64_t)_mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v,nl)));
+        words+=(uint64_t)_mm_popcnt_u64(ns&~((ns<<1)|prev));
+        prev=ns>>31;
+    }
+    out->lines+=lines;
+    out->words+=words;
+    *state=(uint8_t)prev;
+    span_scalar(data+i,len-i,out,state);
+}
+
+// AVX-512BW compares straight into 64-bit masks
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static void span_avx512bw(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state){
+    const __m512i nl=_mm512_set1_epi8('\n'),sp=_mm512_set1_epi8(' ');
+    const __m512i tab=_mm512_set1_epi8('\t'),four=_mm512_set1_epi8(4);
+    uint64_t prev=*state;
+    uint64_t lines=0,words=0;
+    size_t i=0;
+    for(;i+64<=len;i+=64){
+        __m512i v=_mm512_loadu_si512((const void*)(data+i));
+        uint64_t ns=~(_mm512_cmpeq_epi8_mask(v,sp)|_mm512_cmple_epu8_mask(_mm512_sub_epi8(v,tab),four));
+        lines+=(uint64_t)_mm_popcnt_u64(_mm512_cmpeq_epi8_mask(v,nl));
+        words+=(uint64_t)_mm_popcnt_u64(ns&~((ns<<1)|prev));
+        prev=ns>>63;
+    }
+    out->lines+=lines;
+    out->words+=words;
+    *state=(uint8_t)prev;
+    span_scalar(data+i,len-i,out,state);
+}
+
+static int cpu_sse42(void){
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2")&&__builtin_cpu_supports("popcnt");
+}
+static int cpu_avx2(void){
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2")&&__builtin_cpu_supports("popcnt");
+}
+static int cpu_avx512bw(void){
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f")&&__builtin_cpu_supports("avx512bw");
+}
+#endif
+
+#if defined(__ARM_NEON)&&!defined(WC_SCALAR)
+#define WC_NEON_KERNEL 1
+// NEON is baseline on AArch64, so this kernel needs no runtime check
+static void span_neon(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state){
+    uint64_t lines=0,words=0;
+    uint8_t in_word=*state;
     const uint8_t *ptr=data,*end=data+len;
 
     // Vectorised loop (16‑byte chunks)
@@ -48,48 +170,539 @@ void wc_count_buffer(const uint8_t *data,size_t len,wc_counts_t *out){
         }
         ptr+=step;
     }
+    out->lines+=lines;
+    out->words+=words;
+    *state=in_word;
+    span_scalar(ptr,(size_t)(end-ptr),out,state);
+}
+#endif
 
-    // Tail loop
-    while(ptr<end){
-        uint8_t c=*ptr++;
-        if(c=='\n') lines++;
-        uint8_t is_ws=is_ascii_space(c);
-        if(!is_ws && !in_word){
-            words++;
-            in_word=1;
-        }else if(is_ws){
-            in_word=0;
+static int cpu_any(void){ return 1; }
+
+// Best first; the first supported entry wins
+static const struct { const char *name,*level; span_kernel_fn fn; int (*supported)(void); } span_kernels[]={
+#if defined(WC_X86_KERNELS)
+    {"avx512bw","x86-64-v4",span_avx512bw,cpu_avx512bw},
+    {"avx2","x86-64-v3",span_avx2,cpu_avx2},
+    {"sse4.2","x86-64-v2",span_sse42,cpu_sse42},
+#endif
+#if defined(WC_NEON_KERNEL)
+    {"neon","armv8-a",span_neon,cpu_any},
+#endif
+    {"scalar","generic",span_scalar,cpu_any},
+};
+#define NSPAN_KERNELS (sizeof(span_kernels)/sizeof(span_kernels[0]))
+
+static size_t span_active=NSPAN_KERNELS;  // NSPAN_KERNELS: not resolved yet
+
+int wc_kernel_select(const char *name){
+    for(size_t k=0;k<NSPAN_KERNELS;k++){
+        if(!strcmp(span_kernels[k].name,name)&&span_kernels[k].supported()){
+            span_active=k;
+            return 0;
         }
     }
+    return -1;
+}
 
-    out->lines+=lines;
-    out->words+=words;
-    out->bytes+=bytes;
+// WC_KERNEL=NAME in the environment pins a kernel for every caller
+static size_t span_resolve(void){
+    if(span_active==NSPAN_KERNELS){
+        const char *forced=getenv("WC_KERNEL");
+        if(forced&&*forced&&wc_kernel_select(forced)==0) return span_active;
+        size_t k=0;
+        while(k+1<NSPAN_KERNELS&&!span_kernels[k].supported()) k++;
+        span_active=k;
+    }
+    return span_active;
 }
 
-static void wc_file(const char *path,wc_counts_t *totals,int print_name,int sel_l,int sel_w,int sel_c){
+size_t wc_kernel_list(wc_kernel_info_t *out,size_t cap){
+    for(size_t k=0;k<NSPAN_KERNELS&&k<cap;k++){
+        out[k].name=span_kernels[k].name;
+        out[k].level=span_kernels[k].level;
+        out[k].supported=span_kernels[k].supported();
+    }
+    return NSPAN_KERNELS;
+}
+
+const char *wc_kernel_name(void){
+    return span_kernels[span_resolve()].name;
+}
+
+// Count one span; *state carries "inside a word" across spans
+static void wc_count_span(const uint8_t *data,size_t len,wc_counts_t *out,uint8_t *state){
+    span_kernels[span_resolve()].fn(data,len,out,state);
+    out->bytes+=len;
+}
+
+void wc_count_buffer(const uint8_t *data,size_t len,wc_counts_t *out){
+    uint8_t in_word=0;
+    wc_count_span(data,len,out,&in_word);
+}
+
+// ---- mergeable partials (--range / --merge) ----
+
+static uint8_t byte_class(uint8_t c){
+    return is_ascii_space(c)?WC_CLASS_SPACE:WC_CLASS_WORD;
+}
+
+void wc_partial_count(const uint8_t *data,size_t len,uint64_t start,uint64_t size,wc_partial_t *p){
+    memset(p,0,sizeof(*p));
+    p->start=start;
+    p->end=start+len;
+    p->size=size;
+    wc_count_buffer(data,len,&p->counts);
+    if(len){
+        p->first_class=byte_class(data[0]);
+        p->last_class=byte_class(data[len-1]);
+    }
+}
+
+static int partial_cmp(const void *a,const void *b){
+    const wc_partial_t *x=a,*y=b;
+    if(x->start!=y->start) return x->start<y->start?-1:1;
+    return x->end<y->end?-1:x->end>y->end;
+}
+
+int wc_partial_merge(wc_partial_t *parts,size_t n,wc_counts_t *out){
+    memset(out,0,sizeof(*out));
+    qsort(parts,n,sizeof(*parts),partial_cmp);
+    uint64_t pos=0;
+    uint8_t last=WC_CLASS_NONE;
+    for(size_t i=0;i<n;i++){
+        const wc_partial_t *p=&parts[i];
+        if(p->start!=pos||p->end<p->start) return -1;  // gap or overlap
+        if(p->size!=parts[0].size) return -1;          // not the same file
+        if(p->end==p->start) continue;
+        out->lines+=p->counts.lines;
+        out->words+=p->counts.words-(last==WC_CLASS_WORD&&p->first_class==WC_CLASS_WORD);
+        out->bytes+=p->counts.bytes;
+        last=p->last_class;
+        pos=p->end;
+    }
+    if(n&&pos!=parts[0].size) return -1;  // the tail is missing
+    return 0;
+}
+
+static const char class_chars[]="-sw";
+
+int wc_partial_format(const wc_partial_t *p,const char *path,char *buf,size_t cap){
+    int n=snprintf(buf,cap,"wcpart 2 %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %c %c %s\n",
+                   p->start,p->end,p->size,p->counts.lines,p->counts.words,p->counts.bytes,
+                   class_chars[p->first_class],class_chars[p->last_class],path);
+    return (n<0||(size_t)n>=cap)?-1:n;
+}
+
+static int parse_class(char c,uint8_t *out){
+    const char *hit=c?strchr(class_chars,c):NULL;
+    if(!hit) return -1;
+    *out=(uint8_t)(hit-class_chars);
+    return 0;
+}
+
+int wc_partial_parse(const char *line,wc_partial_t *p,char *path,size_t cap){
+    char first,last;
+    int off=0;
+    memset(p,0,sizeof(*p));
+    if(sscanf(line,"wcpart 2 %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %c %c %n",
+              &p->start,&p->end,&p->size,&p->counts.lines,&p->counts.words,&p->counts.bytes,
+              &first,&last,&off)!=8||off==0) return -1;
+    if(parse_class(first,&p->first_class)||parse_class(last,&p->last_class)) return -1;
+    if(p->end<p->start||p->end>p->size||p->counts.bytes!=p->end-p->start) return -1;
+    size_t n=strcspn(line+off,"\n");
+    if(n==0||n>=cap) return -1;
+    memcpy(path,line+off,n);
+    path[n]='\0';
+    return 0;
+}
+
+// ---- sparse files ----
+
+// Extents shorter than this are read with pread: below it the mmap, the
+// page faults and the munmap cost more than copying the bytes
+#define WC_MMAP_MIN (64u<<10)
+
+// Count [start, end) of an open file. Data extents found with
+// SEEK_DATA/SEEK_HOLE are mapped and scanned; holes read as NUL, which is
+// not a space, so a hole only adds its bytes and, if no word is in
+// progress, one word. Without hole support the whole range is one extent.
+static int wc_count_fd_range(int fd,uint64_t start,uint64_t end,wc_counts_t *c,uint8_t *state){
+    uint64_t page=(uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t pos=start;
+    while(pos<end){
+        uint64_t data=pos,hole=end;
+#if defined(SEEK_DATA)&&defined(SEEK_HOLE)
+        off_t d=lseek(fd,(off_t)pos,SEEK_DATA);
+        if(d>=0) data=(uint64_t)d<end?(uint64_t)d:end;
+        else if(errno==ENXIO) data=end;  // nothing but a hole up to EOF
+        if(data<end){
+            off_t h=lseek(fd,(off_t)data,SEEK_HOLE);
+            if(h>=0&&(uint64_t)h<end) hole=(uint64_t)h;
+        }
+#endif
+        if(data>pos){
+            c->bytes+=data-pos;
+            c->words+=!*state;
+            *state=1;
+        }
+        if(data<hole&&hole-data<WC_MMAP_MIN){
+            uint8_t buf[WC_MMAP_MIN];
+            size_t want=(size_t)(hole-data),got=0;
+            while(got<want){
+                ssize_t k=pread(fd,buf+got,want-got,(off_t)(data+got));
+                if(k<0&&errno==EINTR) continue;
+                if(k<0){perror("pread");return -1;}
+                if(k==0) break;  // truncated under us
+                got+=(size_t)k;
+            }
+            wc_count_span(buf,got,c,state);
+        }else if(data<hole){
+            // mmap offsets must be page aligned
+            uint64_t base=data-data%page;
+            size_t maplen=(size_t)(hole-base);
+            uint8_t *map=mmap(NULL,maplen,PROT_READ,MAP_PRIVATE,fd,(off_t)base);
+            if(map==MAP_FAILED){perror("mmap");return -1;}
+            madvise(map,maplen,MADV_SEQUENTIAL);
+            wc_count_span(map+(data-base),(size_t)(hole-data),c,state);
+            munmap(map,maplen);
+        }
+        pos=hole;
+    }
+    return 0;
+}
+
+int wc_count_path(const char *path,wc_counts_t *c){
+    int fd=open(path,O_RDONLY);
+    if(fd<0){perror(path);return -1;}
+    struct stat st; if(fstat(fd,&st)){perror("fstat");close(fd);return -1;}
+    uint8_t in_word=0;
+    int rc=wc_count_fd_range(fd,0,(uint64_t)st.st_size,c,&in_word);
+    close(fd);
+    return rc;
+}
+
+static uint8_t byte_class_at(int fd,uint64_t off){
+    uint8_t b=0;  // a hole reads as NUL
+    if(pread(fd,&b,1,(off_t)off)!=1) b=0;
+    return byte_class(b);
+}
+
+// Count [start, end) of a file; end is clamped to the file size
+int wc_partial_file(const char *path,uint64_t start,uint64_t end,wc_partial_t *p){
+    int fd=open(path,O_RDONLY);
+    if(fd<0){perror(path);return -1;}
+    struct stat st; if(fstat(fd,&st)){perror("fstat");close(fd);return -1;}
+    uint64_t size=(uint64_t)st.st_size;
+    if(end>size) end=size;
+    if(start>end) start=end;
+    memset(p,0,sizeof(*p));
+    p->start=start;
+    p->end=end;
+    p->size=size;
+    if(start<end){
+        uint8_t in_word=0;
+        if(wc_count_fd_range(fd,start,end,&p->counts,&in_word)){close(fd);return -1;}
+        p->first_class=byte_class_at(fd,start);
+        p->last_class=byte_class_at(fd,end-1);
+    }
+    close(fd);
+    return 0;
+}
+
+// ---- CSV/TSV record shape (--fields) ----
+
+// Bitmask of the bytes equal to b in one 64-byte block, bit i = byte i
+#if defined(__ARM_NEON)
+static inline uint64_t neon_movemask64(uint8x16_t c0,uint8x16_t c1,uint8x16_t c2,uint8x16_t c3){
+    static const uint8_t weights[16]={1,2,4,8,16,32,64,128,1,2,4,8,16,32,64,128};
+    const uint8x16_t w=vld1q_u8(weights);
+    uint8x16_t s0=vpaddq_u8(vandq_u8(c0,w),vandq_u8(c1,w));
+    uint8x16_t s1=vpaddq_u8(vandq_u8(c2,w),vandq_u8(c3,w));
+    s0=vpaddq_u8(s0,s1);
+    s0=vpaddq_u8(s0,s0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(s0),0);
+}
+#endif
+
+// SWAR: 0x80 in every zero byte of x ^ pattern, gathered to one bit per byte
+static inline uint64_t eq_bits8(uint64_t x,uint64_t pattern){
+    const uint64_t low7=0x7f7f7f7f7f7f7f7fULL;
+    uint64_t t=x^pattern;
+    uint64_t z=~(((t&low7)+low7)|t|low7);
+    return ((z>>7)*0x0102040810204080ULL)>>56;
+}
+
+static inline void fields_masks(const uint8_t *p,uint8_t delim,uint64_t *q,uint64_t *d,uint64_t *n){
+#if defined(__ARM_NEON)
+    uint8x16_t v0=vld1q_u8(p),v1=vld1q_u8(p+16),v2=vld1q_u8(p+32),v3=vld1q_u8(p+48);
+    uint8x16_t vq=vdupq_n_u8('"'),vd=vdupq_n_u8(delim),vn=vdupq_n_u8('\n');
+    *q=neon_movemask64(vceqq_u8(v0,vq),vceqq_u8(v1,vq),vceqq_u8(v2,vq),vceqq_u8(v3,vq));
+    *d=neon_movemask64(vceqq_u8(v0,vd),vceqq_u8(v1,vd),vceqq_u8(v2,vd),vceqq_u8(v3,vd));
+    *n=neon_movemask64(vceqq_u8(v0,vn),vceqq_u8(v1,vn),vceqq_u8(v2,vn),vceqq_u8(v3,vn));
+#else
+    const uint64_t ones=0x0101010101010101ULL;
+    uint64_t mq=0,md=0,mn=0;
+    for(int i=0;i<8;i++){
+        uint64_t x; memcpy(&x,p+8*i,8);  // little-endian: byte i in bits 8i..8i+7
+        mq|=eq_bits8(x,ones*'"')<<(8*i);
+        md|=eq_bits8(x,ones*delim)<<(8*i);
+        mn|=eq_bits8(x,ones*'\n')<<(8*i);
+    }
+    *q=mq; *d=md; *n=mn;
+#endif
+}
+
+// Bit i set when byte i is inside quotes: the XOR of all quote bits at or
+// below i, i.e. a carry-less multiply by all ones (PMULL with the crypto
+// extension, six shift/XOR steps otherwise)
+static inline uint64_t prefix_xor(uint64_t x){
+#if defined(__ARM_NEON)&&defined(__ARM_FEATURE_AES)
+    return vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64(x,~0ULL)),0);
+#else
+    x^=x<<1; x^=x<<2; x^=x<<4; x^=x<<8; x^=x<<16; x^=x<<32;
+    return x;
+#endif
+}
+
+typedef struct {
+    wc_fields_run_t r;
+    uint64_t cur;       // delimiters in the record in progress
+    uint64_t last_end;  // offset just past the last end
+} fields_state_t;
+
+static inline void fields_end_record(fields_state_t *s,uint64_t at){
+    if(s->r.ends==0){
+        s->r.head=s->cur;
+    }else{
+        uint64_t f=s->cur+1;
+        if(s->r.ends==1||f<s->r.min_fields) s->r.min_fields=f;
+        if(s->r.ends==1||f>s->r.max_fields) s->r.max_fields=f;
+        s->r.fields+=f;
+    }
+    s->r.ends++;
+    s->cur=0;
+    s->last_end=at;
+}
+
+// Unquoted delimiters and newlines of one block for one quote state
+static inline void fields_block(fields_state_t *s,uint64_t dm,uint64_t nm,uint64_t base){
+    while(nm){
+        uint64_t bit=nm&-nm;
+        uint64_t upto=bit|(bit-1);
+        s->cur+=(uint64_t)__builtin_popcountll(dm&upto);
+        dm&=~upto;
+        fields_end_record(s,base+(uint64_t)__builtin_ctzll(nm)+1);
+        nm&=nm-1;
+    }
+    s->cur+=(uint64_t)__builtin_popcountll(dm);
+}
+
+// Both quote states come out of the one set of masks: starting inside
+// quotes just inverts the in-quote mask. For the state that does not apply,
+// ordinary newlines look quoted, so that side mostly costs a popcount.
+void wc_fields_partial_count(const uint8_t *data,size_t len,uint8_t delim,uint64_t start,
+                             uint64_t size,wc_fields_partial_t *p){
+    fields_state_t st[2];
+    memset(st,0,sizeof(st));
+    uint64_t carry=0;  // all ones while inside quotes, for the outside start
+    for(size_t i=0;i<len;i+=64){
+        uint64_t q,d,n;
+        if(len-i>=64){
+            fields_masks(data+i,delim,&q,&d,&n);
+        }else{
+            uint8_t pad[64]={0};
+            uint64_t valid=(1ULL<<(len-i))-1;
+            memcpy(pad,data+i,len-i);
+            fields_masks(pad,delim,&q,&d,&n);
+            q&=valid; d&=valid; n&=valid;
+        }
+        uint64_t inside=prefix_xor(q)^carry;
+        carry=(uint64_t)((int64_t)inside>>63);
+        fields_block(&st[0],d&~inside,n&~inside,i);
+        fields_block(&st[1],d&inside,n&inside,i);
+    }
+    memset(p,0,sizeof(*p));
+    p->start=start;
+    p->end=start+len;
+    p->size=size;
+    p->delim=delim;
+    p->quotes_odd=carry!=0;
+    for(int v=0;v<2;v++){
+        wc_fields_run_t *r=&p->run[v];
+        *r=st[v].r;
+        if(r->ends==0) r->head=st[v].cur;
+        else r->tail=st[v].cur;
+        r->tail_bytes=r->ends?st[v].last_end<len:len>0;
+    }
+}
+
+static void fields_run_join(wc_fields_run_t *a,const wc_fields_run_t *b){
+    if(b->ends==0){
+        if(a->ends==0) a->head+=b->head;
+        else a->tail+=b->head;
+        a->tail_bytes|=b->tail_bytes;
+        return;
+    }
+    if(a->ends==0){
+        uint64_t head=a->head+b->head;
+        *a=*b;
+        a->head=head;
+        return;
+    }
+    // The record that ends at b's first end began after a's last one
+    uint64_t mid=a->tail+b->head+1;
+    uint64_t lo=mid,hi=mid;
+    if(a->ends>1){ if(a->min_fields<lo) lo=a->min_fields; if(a->max_fields>hi) hi=a->max_fields; }
+    if(b->ends>1){ if(b->min_fields<lo) lo=b->min_fields; if(b->max_fields>hi) hi=b->max_fields; }
+    a->fields+=mid+b->fields;
+    a->min_fields=lo;
+    a->max_fields=hi;
+    a->ends+=b->ends;
+    a->tail=b->tail;
+    a->tail_bytes=b->tail_bytes;
+}
+
+void wc_fields_partial_join(wc_fields_partial_t *a,const wc_fields_partial_t *b){
+    wc_fields_run_t r0=a->run[0],r1=a->run[1];
+    fields_run_join(&r0,&b->run[a->quotes_odd]);
+    fields_run_join(&r1,&b->run[!a->quotes_odd]);
+    a->run[0]=r0;
+    a->run[1]=r1;
+    a->end=b->end;
+    a->quotes_odd^=b->quotes_odd;
+}
+
+// Totals for a partial that starts at the beginning of the file
+static void fields_finish(const wc_fields_partial_t *p,wc_fields_t *out){
+    const wc_fields_run_t *r=&p->run[0];
+    wc_fields_t f={0,0,0,0};
+    if(r->ends){
+        // First record, the ones in between, then an unterminated last one
+        uint64_t first=r->head+1;
+        f.records=r->ends;
+        f.fields=first+r->fields;
+        f.min_fields=f.max_fields=first;
+        if(r->ends>1){
+            if(r->min_fields<f.min_fields) f.min_fields=r->min_fields;
+            if(r->max_fields>f.max_fields) f.max_fields=r->max_fields;
+        }
+        if(r->tail_bytes){
+            uint64_t last=r->tail+1;
+            f.records++;
+            f.fields+=last;
+            if(last<f.min_fields) f.min_fields=last;
+            if(last>f.max_fields) f.max_fields=last;
+        }
+    }else if(r->tail_bytes){
+        f.records=1;
+        f.fields=f.min_fields=f.max_fields=r->head+1;
+    }
+    *out=f;
+}
+
+static int fields_partial_cmp(const void *a,const void *b){
+    const wc_fields_partial_t *x=a,*y=b;
+    if(x->start!=y->start) return x->start<y->start?-1:1;
+    return x->end<y->end?-1:x->end>y->end;
+}
+
+int wc_fields_partial_merge(wc_fields_partial_t *parts,size_t n,wc_fields_t *out){
+    memset(out,0,sizeof(*out));
+    if(n==0) return 0;
+    qsort(parts,n,sizeof(*parts),fields_partial_cmp);
+    if(parts[0].start!=0) return -1;
+    wc_fields_partial_t acc=parts[0];
+    for(size_t i=1;i<n;i++){
+        const wc_fields_partial_t *p=&parts[i];
+        if(p->start!=acc.end||p->end<p->start||p->delim!=acc.delim||p->size!=acc.size) return -1;
+        wc_fields_partial_join(&acc,p);
+    }
+    if(acc.end!=acc.size) return -1;  // the tail is missing
+    fields_finish(&acc,out);
+    return 0;
+}
+
+void wc_fields_count(const uint8_t *data,size_t len,uint8_t delim,wc_fields_t *out){
+    wc_fields_partial_t p;
+    wc_fields_partial_count(data,len,delim,0,len,&p);
+    fields_finish(&p,out);
+}
+
+// Shape of [start, end) of a file; end is clamped to the file size
+int wc_fields_partial_file(const char *path,uint64_t start,uint64_t end,uint8_t delim,
+                           wc_fields_partial_t *p){
     int fd=open(path,O_RDONLY);
-    if(fd<0){perror(path);return;}
-    struct stat st; if(fstat(fd,&st)){perror("fstat");close(fd);return;}
-    size_t len=st.st_size;
-    uint8_t *data=mmap(NULL,len,PROT_READ,MAP_PRIVATE,fd,0);
-    if(data==MAP_FAILED){perror("mmap");close(fd);return;}
+    if(fd<0){perror(path);return -1;}
+    struct stat st; if(fstat(fd,&st)){perror("fstat");close(fd);return -1;}
+    uint64_t size=(uint64_t)st.st_size;
+    if(end>size) end=size;
+    if(start>end) start=end;
+    uint64_t page=(uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t base=start-start%page;
+    if(start==end){
+        wc_fields_partial_count(NULL,0,delim,start,size,p);
+        close(fd);
+        return 0;
+    }
+    size_t maplen=(size_t)(end-base);
+    uint8_t *map=mmap(NULL,maplen,PROT_READ,MAP_PRIVATE,fd,(off_t)base);
+    close(fd);
+    if(map==MAP_FAILED){perror("mmap");return -1;}
+    madvise(map,maplen,MADV_SEQUENTIAL);
+    wc_fields_partial_count(map+(start-base),(size_t)(end-start),delim,start,size,p);
+    munmap(map,maplen);
+    return 0;
+}
+
+#define FIELDS_RUN_FMT " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %u"
 
+int wc_fields_partial_format(const wc_fields_partial_t *p,const char *path,char *buf,size_t cap){
+    const wc_fields_run_t *a=&p->run[0],*b=&p->run[1];
+    int n=snprintf(buf,cap,"wcfields 2 %" PRIu64 " %" PRIu64 " %" PRIu64 " %u %u" FIELDS_RUN_FMT FIELDS_RUN_FMT " %s\n",
+                   p->start,p->end,p->size,(unsigned)p->delim,(unsigned)p->quotes_odd,
+                   a->ends,a->head,a->tail,a->fields,a->min_fields,a->max_fields,(unsigned)a->tail_bytes,
+                   b->ends,b->head,b->tail,b->fields,b->min_fields,b->max_fields,(unsigned)b->tail_bytes,path);
+    return (n<0||(size_t)n>=cap)?-1:n;
+}
+
+int wc_fields_partial_parse(const char *line,wc_fields_partial_t *p,char *path,size_t cap){
+    unsigned delim,odd,tb[2];
+    int off=0;
+    wc_fields_run_t *a=&p->run[0],*b=&p->run[1];
+    memset(p,0,sizeof(*p));
+    if(sscanf(line,"wcfields 2 %" SCNu64 " %" SCNu64 " %" SCNu64 " %u %u"
+              " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %u"
+              " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %u %n",
+              &p->start,&p->end,&p->size,&delim,&odd,
+              &a->ends,&a->head,&a->tail,&a->fields,&a->min_fields,&a->max_fields,&tb[0],
+              &b->ends,&b->head,&b->tail,&b->fields,&b->min_fields,&b->max_fields,&tb[1],&off)!=19||off==0) return -1;
+    if(delim>255||odd>1||tb[0]>1||tb[1]>1||p->end<p->start||p->end>p->size) return -1;
+    p->delim=(uint8_t)delim;
+    p->quotes_odd=(uint8_t)odd;
+    a->tail_bytes=(uint8_t)tb[0];
+    b->tail_bytes=(uint8_t)tb[1];
+    size_t n=strcspn(line+off,"\n");
+    if(n==0||n>=cap) return -1;
+    memcpy(path,line+off,n);
+    path[n]='\0';
+    return 0;
+}
+
+#ifndef WC_NO_MAIN
+static void wc_file(const char *path,wc_counts_t *totals,int print_name,int sel_l,int sel_w,int sel_c){
     wc_counts_t c={0};
-    wc_count_buffer(data,len,&c);
+    if(wc_count_path(path,&c)) return;
 
-    if(sel_l) printf("%7llu",(unsigned long long)c.lines);
-    if(sel_w) printf("%7llu",(unsigned long long)c.words);
-    if(sel_c) printf("%7llu",(unsigned long long)c.bytes);
+    if(sel_l) printf(" %6llu",(unsigned long long)c.lines);
+    if(sel_w) printf(" %6llu",(unsigned long long)c.words);
+    if(sel_c) printf(" %6llu",(unsigned long long)c.bytes);
     if(print_name) printf(" %s",path);
     putchar('\n');
 
     totals->lines+=c.lines;
     totals->words+=c.words;
     totals->bytes+=c.bytes;
-
-    munmap(data,len);
-    close(fd);
 }
 
 static void wc_stream(FILE *fp,const char *name,wc_counts_t *totals,int sel_l,int sel_w,int sel_c){
@@ -97,13 +710,13 @@ static void wc_stream(FILE *fp,const char *name,wc_counts_t *totals,int sel_l,in
     if(!buf){perror("malloc");exit(1);}    
     wc_counts_t c={0};
     size_t n;
-    uint8_t in_word=0;
+    uint8_t in_word=0;  // a word may straddle two reads
     while((n=fread(buf,1,cap,fp))){
-        wc_count_buffer(buf,n,&c);
+        wc_count_span(buf,n,&c,&in_word);
     }
-    if(sel_l) printf("%7llu",(unsigned long long)c.lines);
-    if(sel_w) printf("%7llu",(unsigned long long)c.words);
-    if(sel_c) printf("%7llu",(unsigned long long)c.bytes);
+    if(sel_l) printf(" %6llu",(unsigned long long)c.lines);
+    if(sel_w) printf(" %6llu",(unsigned long long)c.words);
+    if(sel_c) printf(" %6llu",(unsigned long long)c.bytes);
     printf(" %s\n",name);
     totals->lines+=c.lines;
     totals->words+=c.words;
@@ -111,27 +724,268 @@ static void wc_stream(FILE *fp,const char *name,wc_counts_t *totals,int sel_l,in
     free(buf);
 }
 
+static void print_counts(const wc_counts_t *c,const char *name,int sel_l,int sel_w,int sel_c){
+    if(sel_l) printf(" %6llu",(unsigned long long)c->lines);
+    if(sel_w) printf(" %6llu",(unsigned long long)c->words);
+    if(sel_c) printf(" %6llu",(unsigned long long)c->bytes);
+    if(name) printf(" %s",name);
+    putchar('\n');
+}
+
+// ---- --fields output ----
+static void print_fields(const wc_fields_t *f,const char *name){
+    printf(" %6llu %6llu %6llu %6llu",(unsigned long long)f->records,(unsigned long long)f->fields,
+           (unsigned long long)f->min_fields,(unsigned long long)f->max_fields);
+    if(name) printf(" %s",name);
+    putchar('\n');
+}
+
+static void add_fields(wc_fields_t *totals,const wc_fields_t *f){
+    if(!f->records) return;
+    if(!totals->records||f->min_fields<totals->min_fields) totals->min_fields=f->min_fields;
+    if(f->max_fields>totals->max_fields) totals->max_fields=f->max_fields;
+    totals->records+=f->records;
+    totals->fields+=f->fields;
+}
+
+static int fields_file(const char *path,uint8_t delim,wc_fields_t *totals,int print_name){
+    wc_fields_partial_t p;
+    wc_fields_t f;
+    if(wc_fields_partial_file(path,0,UINT64_MAX,delim,&p)) return -1;
+    wc_fields_partial_merge(&p,1,&f);
+    print_fields(&f,print_name?path:NULL);
+    add_fields(totals,&f);
+    return 0;
+}
+
+// Pipes: count each buffer on its own and join, no carry between reads
+static void fields_stream(FILE *fp,const char *name,uint8_t delim,wc_fields_t *totals){
+    size_t cap=1024*1024; uint8_t *buf=malloc(cap);
+    if(!buf){perror("malloc");exit(1);}
+    wc_fields_partial_t acc,p;
+    wc_fields_t f;
+    uint64_t off=0;
+    size_t n;
+    wc_fields_partial_count(buf,0,delim,0,0,&acc);
+    while((n=fread(buf,1,cap,fp))){
+        wc_fields_partial_count(buf,n,delim,off,0,&p);  // size is only known at EOF
+        wc_fields_partial_join(&acc,&p);
+        off+=n;
+    }
+    acc.size=off;
+    wc_fields_partial_merge(&acc,1,&f);
+    print_fields(&f,name);
+    add_fields(totals,&f);
+    free(buf);
+}
+
+// --fields=DELIM: one byte, "\t" or "tab"; never a quote or line break
+static int parse_delim(const char *s,uint8_t *out){
+    uint8_t c;
+    if(!strcmp(s,"\\t")||!strcmp(s,"tab")) c='\t';
+    else if(s[0]&&!s[1]) c=(uint8_t)s[0];
+    else return -1;
+    if(c=='"'||c=='\n'||c=='\r') return -1;
+    *out=c;
+    return 0;
+}
+
+// --range=START:END, END empty = to EOF; sizes take K/M/G/T suffixes
+static int parse_offset(const char *s,char **end,uint64_t *out){
+    unsigned long long v=strtoull(s,end,10);
+    if(*end==s) return -1;
+    switch(**end){
+        case 'T': v<<=10; /* fall through */
+        case 'G': v<<=10; /* fall through */
+        case 'M': v<<=10; /* fall through */
+        case 'K': v<<=10; (*end)++; break;
+    }
+    *out=v;
+    return 0;
+}
+
+static int parse_range(const char *arg,uint64_t *start,uint64_t *end){
+    char *p;
+    if(parse_offset(arg,&p,start)||*p!=':') return -1;
+    *end=UINT64_MAX;
+    if(p[1]&&(parse_offset(p+1,&p,end)||*p)) return -1;
+    return *end<*start?-1:0;
+}
+
+typedef struct {
+    char *path;
+    wc_partial_t *parts;
+    size_t n,cap;
+    wc_fields_partial_t *fparts;  // wcfields lines, kept apart from wcpart ones
+    size_t fn,fcap;
+} merge_file_t;
+
+#define GROW(arr,n,cap) do{ if((n)==(cap)){ (cap)=(cap)?(cap)*2:16; \
+    (arr)=realloc((arr),(cap)*sizeof(*(arr))); if(!(arr)){perror("realloc");exit(1);} } }while(0)
+
+// Read partials (from files or stdin), group them by path and print totals
+static int merge_partials(int argc,char **argv,int sel_l,int sel_w,int sel_c){
+    merge_file_t *files=NULL;
+    size_t nfiles=0;
+    char line[WC_FIELDS_MAX_LINE],path[WC_FIELDS_MAX_LINE];
+    int rc=0;
+
+    for(int i=0;i<(argc?argc:1);i++){
+        FILE *fp=argc?fopen(argv[i],"r"):stdin;
+        if(!fp){perror(argv[i]);rc=1;continue;}
+        while(fgets(line,sizeof(line),fp)){
+            wc_partial_t p;
+            wc_fields_partial_t fp;
+            int is_fields=!strncmp(line,"wcfields ",9);
+            if(is_fields?wc_fields_partial_parse(line,&fp,path,sizeof(path)):
+                         wc_partial_parse(line,&p,path,sizeof(path))){
+                fprintf(stderr,"wc: bad partial: %s",line);
+                rc=1;
+                continue;
+            }
+            size_t f=0;
+            while(f<nfiles&&strcmp(files[f].path,path)) f++;
+            if(f==nfiles){
+                files=realloc(files,(nfiles+1)*sizeof(*files));
+                if(!files){perror("realloc");exit(1);}
+                files[nfiles++]=(merge_file_t){strdup(path),NULL,0,0,NULL,0,0};
+            }
+            merge_file_t *mf=&files[f];
+            if(is_fields){
+                GROW(mf->fparts,mf->fn,mf->fcap);
+                mf->fparts[mf->fn++]=fp;
+            }else{
+                GROW(mf->parts,mf->n,mf->cap);
+                mf->parts[mf->n++]=p;
+            }
+        }
+        if(argc) fclose(fp);
+    }
+
+    wc_counts_t totals={0};
+    wc_fields_t ftotals={0,0,0,0};
+    size_t ncounted=0,nfields=0;
+    for(size_t f=0;f<nfiles;f++){
+        wc_counts_t c;
+        wc_fields_t fs;
+        if(files[f].n){
+            if(wc_partial_merge(files[f].parts,files[f].n,&c)){
+                fprintf(stderr,"wc: %s: partials leave a gap or overlap or miss the end of the file\n",files[f].path);
+                rc=1;
+            }else{
+                print_counts(&c,files[f].path,sel_l,sel_w,sel_c);
+                totals.lines+=c.lines;
+                totals.words+=c.words;
+                totals.bytes+=c.bytes;
+                ncounted++;
+            }
+        }
+        if(files[f].fn){
+            if(wc_fields_partial_merge(files[f].fparts,files[f].fn,&fs)){
+                fprintf(stderr,"wc: %s: fields partials leave a gap or overlap or miss the end of the file\n",files[f].path);
+                rc=1;
+            }else{
+                print_fields(&fs,files[f].path);
+                add_fields(&ftotals,&fs);
+                nfields++;
+            }
+        }
+        free(files[f].path);
+        free(files[f].parts);
+        free(files[f].fparts);
+    }
+    if(ncounted>1) print_counts(&totals,"total",sel_l,sel_w,sel_c);
+    if(nfields>1) print_fields(&ftotals,"total");
+    free(files);
+    return rc;
+}
+
 int main(int argc,char **argv){
     int opt; int sel_l=1,sel_w=1,sel_c=1;
-    while((opt=getopt(argc,argv,"clw"))!=-1){
+    int merge=0,ranged=0,fields=0;
+    uint8_t delim=',';
+    uint64_t range_start=0,range_end=UINT64_MAX;
+    static const struct option long_opts[]={
+        {"range",required_argument,NULL,'r'},
+        {"merge",no_argument,NULL,'m'},
+        {"fields",required_argument,NULL,'f'},
+        {"print-kernel",no_argument,NULL,'k'},
+        {NULL,0,NULL,0}
+    };
+    // WC_KERNEL=NAME pins a kernel, e.g. to benchmark one against another;
+    // an unknown name is an error here rather than a silent fallback
+    const char *forced=getenv("WC_KERNEL");
+    if(forced&&*forced&&wc_kernel_select(forced)){
+        fprintf(stderr,"wc: kernel '%s' is not available on this CPU\n",forced);
+        return 1;
+    }
+    while((opt=getopt_long(argc,argv,"clw",long_opts,NULL))!=-1){
         if(opt=='c'){sel_l=sel_w=0;sel_c=1;}
         else if(opt=='l'){sel_w=sel_c=0;sel_l=1;}
         else if(opt=='w'){sel_l=sel_c=0;sel_w=1;}
-        else {fprintf(stderr,"Usage: %s [-clw] [file ...]\n",argv[0]);return 1;}
+        else if(opt=='r'){
+            if(parse_range(optarg,&range_start,&range_end)){
+                fprintf(stderr,"wc: bad --range '%s' (want START:END)\n",optarg);
+                return 1;
+            }
+            ranged=1;
+        }
+        else if(opt=='m') merge=1;
+        else if(opt=='k'){
+            // chosen kernel, then every one built in and whether it runs here
+            wc_kernel_info_t k[8];
+            size_t n=wc_kernel_list(k,8);
+            printf("%s\n",wc_kernel_name());
+            for(size_t i=0;i<n&&i<8;i++)
+                printf("  %-9s %-10s %s\n",k[i].name,k[i].level,k[i].supported?"supported":"unsupported");
+            return 0;
+        }
+        else if(opt=='f'){
+            if(parse_delim(optarg,&delim)){
+                fprintf(stderr,"wc: bad --fields delimiter '%s' (one byte, not '\"' or newline)\n",optarg);
+                return 1;
+            }
+            fields=1;
+        }
+        else {fprintf(stderr,"Usage: %s [-clw] [--fields=DELIM] [--range=START:END | --merge] [--print-kernel] [file ...]\n",argv[0]);return 1;}
     }
     int files=argc-optind;
+    if(merge) return merge_partials(files,argv+optind,sel_l,sel_w,sel_c);
+    if(ranged){
+        // One serialised partial per file, for a later --merge
+        char line[WC_FIELDS_MAX_LINE];
+        int rc=0;
+        if(files==0){fprintf(stderr,"wc: --range needs a file\n");return 1;}
+        for(int i=optind;i<argc;i++){
+            wc_partial_t p;
+            wc_fields_partial_t fp;
+            if(fields){
+                if(wc_fields_partial_file(argv[i],range_start,range_end,delim,&fp)||
+                   wc_fields_partial_format(&fp,argv[i],line,sizeof(line))<0){rc=1;continue;}
+            }else if(wc_partial_file(argv[i],range_start,range_end,&p)||
+                     wc_partial_format(&p,argv[i],line,sizeof(line))<0){rc=1;continue;}
+            fputs(line,stdout);
+        }
+        return rc;
+    }
+    if(fields){
+        // records, fields, min and max fields per record
+        wc_fields_t ftotals={0,0,0,0};
+        int rc=0;
+        if(files==0) fields_stream(stdin,"-",delim,&ftotals);
+        for(int i=optind;i<argc;i++)
+            if(fields_file(argv[i],delim,&ftotals,files>1)) rc=1;
+        if(files>1) print_fields(&ftotals,"total");
+        return rc;
+    }
     wc_counts_t totals={0};
     if(files==0){
         wc_stream(stdin,"-",&totals,sel_l,sel_w,sel_c);
     }else{
         for(int i=optind;i<argc;i++)
             wc_file(argv[i],&totals, files>1,sel_l,sel_w,sel_c);
-        if(files>1){
-            if(sel_l) printf("%7llu",(unsigned long long)totals.lines);
-            if(sel_w) printf("%7llu",(unsigned long long)totals.words);
-            if(sel_c) printf("%7llu",(unsigned long long)totals.bytes);
-            printf(" total\n");
-        }
+        if(files>1) print_counts(&totals,"total",sel_l,sel_w,sel_c);
     }
     return 0;
 }
+#endif
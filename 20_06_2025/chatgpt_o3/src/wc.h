@@ -1,5 +1,4 @@
-###############################################################################
-# src/wc.h
+// src/wc.h
 #ifndef WC_H
 #define WC_H
 #include <stdint.h>
@@ -13,4 +12,93 @@ typedef struct {
 
 void wc_count_buffer(const uint8_t *data, size_t len, wc_counts_t *c);
 
+// Line and word counting runs through one SIMD kernel, resolved on first
+// use as the best this CPU supports (avx512bw, avx2, sse4.2, neon, scalar)
+// or as named by WC_KERNEL in the environment
+typedef struct {
+    const char *name;
+    const char *level;  // ISA level it needs, e.g. "x86-64-v3"
+    int supported;      // the running CPU can execute it
+} wc_kernel_info_t;
+
+// Kernels built in, best first; fills up to cap entries, returns the total
+size_t wc_kernel_list(wc_kernel_info_t *out, size_t cap);
+const char *wc_kernel_name(void);
+// Pin a kernel by name; -1 if it is not built in or the CPU lacks it
+int wc_kernel_select(const char *name);
+// Count a whole file, scanning only its data extents (holes read as NUL)
+int wc_count_path(const char *path, wc_counts_t *c);
+
+// Byte classes at the edges of a partial; NONE only for an empty range
+enum { WC_CLASS_NONE = 0, WC_CLASS_SPACE = 1, WC_CLASS_WORD = 2 };
+
+// Counts for the byte range [start, end) of one file of size bytes. Words
+// are counted at their first byte as if the range began after whitespace,
+// so adjacent partials merge exactly: a word running across the seam (last
+// class WORD, next first class WORD) was counted twice and is taken off once.
+typedef struct {
+    uint64_t start, end, size;
+    wc_counts_t counts;
+    uint8_t first_class, last_class;
+} wc_partial_t;
+
+#define WC_PARTIAL_MAX_LINE 4200  // serialised partial incl. a PATH_MAX path
+
+// data holds bytes [start, start+len) of an input of size bytes
+void wc_partial_count(const uint8_t *data, size_t len, uint64_t start, uint64_t size, wc_partial_t *p);
+// Combine partials covering one file (any order) into totals; -1 on a gap,
+// an overlap, a missing tail or partials that disagree on the file size
+int wc_partial_merge(wc_partial_t *parts, size_t n, wc_counts_t *out);
+// "wcpart 2 START END SIZE LINES WORDS BYTES FIRST LAST PATH\n", classes as - s w
+int wc_partial_format(const wc_partial_t *p, const char *path, char *buf, size_t cap);
+// Parse one serialised line; path (may hold spaces) is copied into path[cap]
+int wc_partial_parse(const char *line, wc_partial_t *p, char *path, size_t cap);
+int wc_partial_file(const char *path, uint64_t start, uint64_t end, wc_partial_t *p);
+
+// ---- CSV/TSV record shape (--fields) ----
+// Records end at newlines outside double quotes; fields are separated by
+// the delimiter outside quotes. Every '"' toggles the quote state, so ""
+// inside a quoted field is an escaped quote.
+typedef struct {
+    uint64_t records;
+    uint64_t fields;
+    uint64_t min_fields, max_fields;  // per record; 0 with no records
+} wc_fields_t;
+
+// Shape of a byte range for one quote state at its start. Records wholly
+// inside the range are folded in; delimiters before the first and after
+// the last record end are kept apart for joining with neighbours.
+typedef struct {
+    uint64_t ends;                   // record-ending newlines
+    uint64_t head;                   // delimiters before the first end (all of them if none)
+    uint64_t tail;                   // delimiters after the last end
+    uint64_t fields;                 // fields of the records between first and last end
+    uint64_t min_fields, max_fields; // of those records, valid when ends > 1
+    uint8_t tail_bytes;              // bytes follow the last end (no end: range not empty)
+} wc_fields_run_t;
+
+// A range counted for both possible quote states, so ranges counted
+// independently (chunks, ranks) join exactly once the state is known
+typedef struct {
+    uint64_t start, end, size;       // size: of the whole file
+    uint8_t delim;
+    uint8_t quotes_odd;              // odd number of '"' in the range
+    wc_fields_run_t run[2];          // [0] starts outside quotes, [1] inside
+} wc_fields_partial_t;
+
+void wc_fields_partial_count(const uint8_t *data, size_t len, uint8_t delim, uint64_t start,
+                             uint64_t size, wc_fields_partial_t *p);
+// Append b (which must start where a ends) to a
+void wc_fields_partial_join(wc_fields_partial_t *a, const wc_fields_partial_t *b);
+// Combine partials covering one file (any order); -1 on a gap, an overlap, a
+// missing tail, mixed delimiters or partials that disagree on the file size
+int wc_fields_partial_merge(wc_fields_partial_t *parts, size_t n, wc_fields_t *out);
+void wc_fields_count(const uint8_t *data, size_t len, uint8_t delim, wc_fields_t *out);
+int wc_fields_partial_file(const char *path, uint64_t start, uint64_t end, uint8_t delim,
+                           wc_fields_partial_t *p);
+// "wcfields 2 START END SIZE DELIM ODD" + 7 numbers per run + " PATH\n"
+#define WC_FIELDS_MAX_LINE 4500  // serialised fields partial incl. a PATH_MAX path
+int wc_fields_partial_format(const wc_fields_partial_t *p, const char *path, char *buf, size_t cap);
+int wc_fields_partial_parse(const char *line, wc_fields_partial_t *p, char *path, size_t cap);
+
 #endif // WC_H
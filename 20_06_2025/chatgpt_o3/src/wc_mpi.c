@@ -0,0 +1,139 @@
+// src/wc_mpi.c
+// MPI launcher: every rank counts one contiguous slice of each file as a
+// partial, rank 0 gathers the serialised partials and merges them.
+//   mpirun -np N ./wc_mpi [-clw] [--fields=DELIM] file ...
+#define _DEFAULT_SOURCE
+#include "wc.h"
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/stat.h>
+
+static void print_counts(const wc_counts_t *c,const char *name,int sel_l,int sel_w,int sel_c){
+    if(sel_l) printf(" %6llu",(unsigned long long)c->lines);
+    if(sel_w) printf(" %6llu",(unsigned long long)c->words);
+    if(sel_c) printf(" %6llu",(unsigned long long)c->bytes);
+    if(name) printf(" %s",name);
+    putchar('\n');
+}
+
+static void print_fields(const wc_fields_t *f,const char *name){
+    printf(" %6llu %6llu %6llu %6llu",(unsigned long long)f->records,(unsigned long long)f->fields,
+           (unsigned long long)f->min_fields,(unsigned long long)f->max_fields);
+    if(name) printf(" %s",name);
+    putchar('\n');
+}
+
+static int parse_delim(const char *s,uint8_t *out){
+    uint8_t c;
+    if(!strcmp(s,"\\t")||!strcmp(s,"tab")) c='\t';
+    else if(s[0]&&!s[1]) c=(uint8_t)s[0];
+    else return -1;
+    if(c=='"'||c=='\n'||c=='\r') return -1;
+    *out=c;
+    return 0;
+}
+
+int main(int argc,char **argv){
+    MPI_Init(&argc,&argv);
+    int rank,nranks;
+    MPI_Comm_rank(MPI_COMM_WORLD,&rank);
+    MPI_Comm_size(MPI_COMM_WORLD,&nranks);
+
+    int opt; int sel_l=1,sel_w=1,sel_c=1;
+    int fields=0; uint8_t delim=',';
+    static const struct option long_opts[]={
+        {"fields",required_argument,NULL,'f'},
+        {NULL,0,NULL,0}
+    };
+    while((opt=getopt_long(argc,argv,"clw",long_opts,NULL))!=-1){
+        if(opt=='c'){sel_l=sel_w=0;sel_c=1;}
+        else if(opt=='l'){sel_w=sel_c=0;sel_l=1;}
+        else if(opt=='w'){sel_l=sel_c=0;sel_w=1;}
+        else if(opt=='f'&&parse_delim(optarg,&delim)==0) fields=1;
+        else {
+            if(rank==0) fprintf(stderr,"Usage: %s [-clw] [--fields=DELIM] file ...\n",argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    int files=argc-optind,rc=0;
+    // Fields partials carry both quote states and need the longer line
+    const int cap=fields?WC_FIELDS_MAX_LINE:WC_PARTIAL_MAX_LINE;
+    char *line=malloc(cap);
+    char *all=rank==0?malloc((size_t)nranks*cap):NULL;
+    char *path=malloc(cap);
+    wc_partial_t *parts=malloc((size_t)nranks*sizeof(*parts));
+    wc_fields_partial_t *fparts=malloc((size_t)nranks*sizeof(*fparts));
+    if(!line||!path||!parts||!fparts||(rank==0&&!all)){perror("malloc");MPI_Abort(MPI_COMM_WORLD,1);}
+    wc_counts_t totals={0};
+    wc_fields_t ftotals={0,0,0,0};
+
+    for(int i=optind;i<argc;i++){
+        // Rank 0 stats the file so every rank splits the same size
+        unsigned long long size=0;
+        if(rank==0){
+            struct stat st;
+            size=stat(argv[i],&st)==0?(unsigned long long)st.st_size:0;
+        }
+        MPI_Bcast(&size,1,MPI_UNSIGNED_LONG_LONG,0,MPI_COMM_WORLD);
+        uint64_t start=size*(uint64_t)rank/(uint64_t)nranks;
+        uint64_t end=size*(uint64_t)(rank+1)/(uint64_t)nranks;
+
+        wc_partial_t p;
+        wc_fields_partial_t fp;
+        memset(line,0,cap);
+        if(fields){
+            if(wc_fields_partial_file(argv[i],start,end,delim,&fp)==0)
+                wc_fields_partial_format(&fp,argv[i],line,cap);
+        }else if(wc_partial_file(argv[i],start,end,&p)==0)
+            wc_partial_format(&p,argv[i],line,cap);
+        MPI_Gather(line,cap,MPI_CHAR,all,cap,MPI_CHAR,0,MPI_COMM_WORLD);
+        if(rank!=0) continue;
+
+        if(fields){
+            wc_fields_t f;
+            int ok=1;
+            for(int r=0;r<nranks&&ok;r++)
+                ok=wc_fields_partial_parse(all+(size_t)r*cap,&fparts[r],path,cap)==0;
+            if(!ok||wc_fields_partial_merge(fparts,(size_t)nranks,&f)){
+                fprintf(stderr,"wc_mpi: %s: missing partials\n",argv[i]);
+                rc=1;
+                continue;
+            }
+            print_fields(&f,argv[i]);
+            if(f.records){
+                if(!ftotals.records||f.min_fields<ftotals.min_fields) ftotals.min_fields=f.min_fields;
+                if(f.max_fields>ftotals.max_fields) ftotals.max_fields=f.max_fields;
+                ftotals.records+=f.records;
+                ftotals.fields+=f.fields;
+            }
+            continue;
+        }
+
+        wc_counts_t c;
+        int ok=1;
+        for(int r=0;r<nranks&&ok;r++)
+            ok=wc_partial_parse(all+(size_t)r*cap,&parts[r],path,cap)==0;
+        if(!ok||wc_partial_merge(parts,(size_t)nranks,&c)){
+            fprintf(stderr,"wc_mpi: %s: missing partials\n",argv[i]);
+            rc=1;
+            continue;
+        }
+        print_counts(&c,argv[i],sel_l,sel_w,sel_c);
+        totals.lines+=c.lines;
+        totals.words+=c.words;
+        totals.bytes+=c.bytes;
+    }
+    if(rank==0&&files>1){
+        if(fields) print_fields(&ftotals,"total");
+        else print_counts(&totals,"total",sel_l,sel_w,sel_c);
+    }
+
+    free(line); free(all); free(path); free(parts); free(fparts);
+    MPI_Finalize();
+    return rc;
+}
@@ -1,9 +1,12 @@
-###############################################################################
-# tests/test_wc.c
+// tests/test_wc.c
+#define _GNU_SOURCE  // ftruncate, pread, pwrite under -std=c11
 #include "wc.h"
 #include <assert.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 static void run_case(const char *str,uint64_t l,uint64_t w,uint64_t b){
     wc_counts_t c={0};
@@ -13,14 +16,305 @@ static void run_case(const char *str,uint64_t l,uint64_t w,uint64_t b){
     assert(c.bytes==b);
 }
 
+// Every kernel the CPU can run against a byte-at-a-time count, on slices
+// that start and end at every offset around the vector widths
+static void kernel_tests(void){
+    static uint8_t buf[1024];
+    const char *best=wc_kernel_name();
+    srand(11);
+    for(size_t i=0;i<sizeof(buf);i++) buf[i]=(uint8_t)" \t\n\v\f\rab\x80\xff\0x"[rand()%12];
+    wc_kernel_info_t k[8];
+    size_t n=wc_kernel_list(k,8);
+    for(size_t i=0;i<n&&i<8;i++){
+        if(!k[i].supported) continue;
+        assert(wc_kernel_select(k[i].name)==0);
+        for(size_t off=0;off<70;off++){
+            for(size_t len=0;off+len<=sizeof(buf);len+=len<140?1:61){
+                wc_counts_t want={0},got={0};
+                uint8_t in_word=0;
+                for(size_t j=off;j<off+len;j++){
+                    uint8_t c=buf[j],ws=c==' '||(uint8_t)(c-'\t')<=4;
+                    want.lines+=c=='\n';
+                    want.words+=!ws&&!in_word;
+                    in_word=!ws;
+                }
+                wc_count_buffer(buf+off,len,&got);
+                assert(got.lines==want.lines&&got.words==want.words&&got.bytes==len);
+            }
+        }
+        printf("Kernel %s passed.\n",k[i].name);
+    }
+    assert(wc_kernel_select("no-such-kernel")==-1);
+    assert(wc_kernel_select(best)==0);
+}
+
+// Split str at every pair of cut points, shuffle the pieces and merge them back
+static void partial_case(const char *str){
+    size_t len=strlen(str);
+    wc_counts_t want={0},got;
+    wc_count_buffer((const uint8_t*)str,len,&want);
+    for(size_t a=0;a<=len;a++){
+        for(size_t b=a;b<=len;b++){
+            wc_partial_t parts[3];
+            wc_partial_count((const uint8_t*)str+b,len-b,b,len,&parts[0]);
+            wc_partial_count((const uint8_t*)str,a,0,len,&parts[1]);
+            wc_partial_count((const uint8_t*)str+a,b-a,a,len,&parts[2]);
+            assert(wc_partial_merge(parts,3,&got)==0);
+            assert(got.lines==want.lines);
+            assert(got.words==want.words);
+            assert(got.bytes==want.bytes);
+        }
+    }
+}
+
+static void partial_tests(void){
+    partial_case("");
+    partial_case("hello world\n");
+    partial_case("  leading and trailing  \n");
+    partial_case("one two\nthree\tfour\nfive");
+    partial_case("a\vb\fc\r\nd  e");
+
+    // Many small pieces in random order
+    char buf[4096];
+    srand(7);
+    for(size_t i=0;i<sizeof(buf)-1;i++) buf[i]=" \nab\tcd"[rand()%8];
+    buf[sizeof(buf)-1]='\0';
+    wc_partial_t parts[64];
+    size_t n=0,pos=0;
+    while(pos<sizeof(buf)-1&&n<63){
+        size_t take=1+rand()%128;
+        if(take>sizeof(buf)-1-pos) take=sizeof(buf)-1-pos;
+        wc_partial_count((const uint8_t*)buf+pos,take,pos,sizeof(buf)-1,&parts[n++]);
+        pos+=take;
+    }
+    wc_partial_count((const uint8_t*)buf+pos,sizeof(buf)-1-pos,pos,sizeof(buf)-1,&parts[n++]);
+    for(size_t i=n-1;i>0;i--){
+        size_t j=(size_t)rand()%(i+1);
+        wc_partial_t t=parts[i]; parts[i]=parts[j]; parts[j]=t;
+    }
+    wc_counts_t want={0},got;
+    wc_count_buffer((const uint8_t*)buf,sizeof(buf)-1,&want);
+    assert(wc_partial_merge(parts,n,&got)==0);
+    assert(got.words==want.words&&got.lines==want.lines&&got.bytes==want.bytes);
+
+    // Gaps, overlaps, a missing tail and mixed file sizes are refused
+    const uint8_t *s=(const uint8_t*)"abc def ghi";
+    wc_partial_count(s,3,0,11,&parts[0]);
+    wc_partial_count(s+4,7,4,11,&parts[1]);
+    assert(wc_partial_merge(parts,2,&got)==-1);
+    wc_partial_count(s,5,0,11,&parts[0]);
+    wc_partial_count(s+4,7,4,11,&parts[1]);
+    assert(wc_partial_merge(parts,2,&got)==-1);
+    wc_partial_count(s,4,0,11,&parts[0]);
+    wc_partial_count(s+4,4,4,11,&parts[1]);
+    assert(wc_partial_merge(parts,2,&got)==-1);
+    wc_partial_count(s+4,7,4,12,&parts[1]);
+    assert(wc_partial_merge(parts,2,&got)==-1);
+    wc_partial_count(s+4,7,4,11,&parts[1]);
+    assert(wc_partial_merge(parts,2,&got)==0&&got.words==3);
+
+    // Serialisation round trip, including a path with spaces
+    char line[WC_PARTIAL_MAX_LINE],path[WC_PARTIAL_MAX_LINE];
+    wc_partial_t p,q;
+    wc_partial_count(s+2,7,2,11,&p);
+    assert(wc_partial_format(&p,"dir/my file.txt",line,sizeof(line))>0);
+    assert(wc_partial_parse(line,&q,path,sizeof(path))==0);
+    assert(strcmp(path,"dir/my file.txt")==0);
+    assert(q.start==2&&q.end==9&&q.size==11&&q.counts.words==p.counts.words);
+    assert(q.first_class==WC_CLASS_WORD&&q.last_class==WC_CLASS_WORD);
+    assert(wc_partial_parse("wcpart 2 0 5 5 0 1 4 w w x\n",&q,path,sizeof(path))==-1);
+    assert(wc_partial_parse("wcpart 2 0 5 4 0 1 5 w w x\n",&q,path,sizeof(path))==-1);
+    assert(wc_partial_parse("wcpart 1 0 5 0 1 5 w w x\n",&q,path,sizeof(path))==-1);
+    assert(wc_partial_parse("garbage\n",&q,path,sizeof(path))==-1);
+    puts("Partial merge tests passed!");
+}
+
+// Byte-at-a-time reference for --fields
+static void fields_ref(const char *s,size_t len,char delim,wc_fields_t *out){
+    wc_fields_t f={0,0,0,0};
+    uint64_t cur=1; int inq=0,open=0;
+    for(size_t i=0;i<len;i++){
+        if(s[i]=='"') inq=!inq;
+        if(inq){open=1;continue;}
+        if(s[i]==delim) cur++;
+        if(s[i]!='\n'){open=1;continue;}
+        if(!f.records||cur<f.min_fields) f.min_fields=cur;
+        if(cur>f.max_fields) f.max_fields=cur;
+        f.records++; f.fields+=cur;
+        cur=1; open=0;
+    }
+    if(open){
+        if(!f.records||cur<f.min_fields) f.min_fields=cur;
+        if(cur>f.max_fields) f.max_fields=cur;
+        f.records++; f.fields+=cur;
+    }
+    *out=f;
+}
+
+static void fields_check(const char *s,size_t len,char delim){
+    wc_fields_t want,got;
+    fields_ref(s,len,delim,&want);
+    wc_fields_count((const uint8_t*)s,len,(uint8_t)delim,&got);
+    assert(got.records==want.records&&got.fields==want.fields);
+    assert(got.min_fields==want.min_fields&&got.max_fields==want.max_fields);
+}
+
+static void fields_tests(void){
+    wc_fields_t f;
+    wc_fields_count((const uint8_t*)"",0,',',&f);
+    assert(f.records==0&&f.fields==0&&f.min_fields==0&&f.max_fields==0);
+    const char *csv="a,b,c\n\"x,\ny\",2\n\n\"say \"\"hi\"\", ok\",3,4,5";
+    wc_fields_count((const uint8_t*)csv,strlen(csv),',',&f);
+    assert(f.records==4&&f.fields==10&&f.min_fields==1&&f.max_fields==4);
+    const char *tsv="a\tb\t\"c\td\"\n";
+    wc_fields_count((const uint8_t*)tsv,strlen(tsv),'\t',&f);
+    assert(f.records==1&&f.fields==3);
+
+    // Random quoted CSV across the 64-byte block edges, against the reference
+    char buf[1024];
+    srand(11);
+    for(int t=0;t<400;t++){
+        size_t len=(size_t)rand()%sizeof(buf);
+        for(size_t i=0;i<len;i++) buf[i]="ab,,\"\n\t ;"[rand()%9];
+        fields_check(buf,len,',');
+        fields_check(buf,len,'\t');
+    }
+
+    // Every split point joins back, whatever the quote state at the seam
+    size_t len=200;
+    for(size_t i=0;i<len;i++) buf[i]="a,\"\n,b\""[rand()%7];
+    wc_fields_t want;
+    fields_ref(buf,len,',',&want);
+    for(size_t a=0;a<=len;a++){
+        for(size_t b=a;b<=len;b+=7){
+            wc_fields_partial_t parts[3];
+            wc_fields_partial_count((const uint8_t*)buf+b,len-b,',',b,len,&parts[0]);
+            wc_fields_partial_count((const uint8_t*)buf,a,',',0,len,&parts[1]);
+            wc_fields_partial_count((const uint8_t*)buf+a,b-a,',',a,len,&parts[2]);
+            assert(wc_fields_partial_merge(parts,3,&f)==0);
+            assert(f.records==want.records&&f.fields==want.fields);
+            assert(f.min_fields==want.min_fields&&f.max_fields==want.max_fields);
+        }
+    }
+
+    // Gaps, mixed delimiters and a missing tail are refused; serialisation round trips
+    wc_fields_partial_t parts[2],q;
+    wc_fields_partial_count((const uint8_t*)buf,10,',',0,20,&parts[0]);
+    wc_fields_partial_count((const uint8_t*)buf+11,9,',',11,20,&parts[1]);
+    assert(wc_fields_partial_merge(parts,2,&f)==-1);
+    wc_fields_partial_count((const uint8_t*)buf+10,10,'\t',10,20,&parts[1]);
+    assert(wc_fields_partial_merge(parts,2,&f)==-1);
+    wc_fields_partial_count((const uint8_t*)buf+10,5,',',10,20,&parts[1]);
+    assert(wc_fields_partial_merge(parts,2,&f)==-1);
+    wc_fields_partial_count((const uint8_t*)buf+10,10,',',10,20,&parts[1]);
+    assert(wc_fields_partial_merge(parts,2,&f)==0);
+    char line[WC_FIELDS_MAX_LINE],path[WC_FIELDS_MAX_LINE];
+    wc_fields_partial_count((const uint8_t*)buf+5,100,',',5,len,&parts[0]);
+    assert(wc_fields_partial_format(&parts[0],"dir/my file.csv",line,sizeof(line))>0);
+    assert(wc_fields_partial_parse(line,&q,path,sizeof(path))==0);
+    assert(strcmp(path,"dir/my file.csv")==0);
+    assert(memcmp(&q.run,&parts[0].run,sizeof(q.run))==0);
+    assert(q.start==5&&q.end==105&&q.size==len&&q.delim==','&&q.quotes_odd==parts[0].quotes_odd);
+    puts("Fields tests passed!");
+}
+
+// Count src/wc.c as four --range partials and merge them with --merge
+static void range_merge_test(const char *path){
+    char cmd[512];
+    snprintf(cmd,sizeof(cmd),
+             "sz=$(wc -c < %s); q=$((sz/4)); rm -f /tmp/wc_parts;"
+             " for r in 0:$q $q:$((2*q)) $((2*q)):$((3*q)) $((3*q)):; do ./wc --range=$r %s >> /tmp/wc_parts; done;"
+             " ./wc --merge /tmp/wc_parts | awk '{print $1,$2,$3}' > /tmp/self_wc_merged",path,path);
+    assert(system(cmd)==0);
+    assert(system("diff -q /tmp/self_wc_merged /tmp/sys_wc")==0);
+    puts("Range/merge integration test passed.");
+}
+
+// --merge refuses partials that stop short of EOF instead of printing a prefix
+static void merge_tail_test(void){
+    assert(system("head -c 65537 /dev/zero | tr '\\0' x > /tmp/wc_tail.txt;"
+                  " ./wc --range=0:10 /tmp/wc_tail.txt > /tmp/wc_tail_parts;"
+                  " ./wc --fields=, --range=0:10 /tmp/wc_tail.txt > /tmp/wc_tail_fparts")==0);
+    assert(system("./wc --merge /tmp/wc_tail_parts > /dev/null 2>&1")!=0);
+    assert(system("./wc --merge /tmp/wc_tail_fparts > /dev/null 2>&1")!=0);
+    assert(system("./wc --range=10: /tmp/wc_tail.txt >> /tmp/wc_tail_parts;"
+                  " ./wc --merge /tmp/wc_tail_parts | awk '{exit !($3==65537)}'")==0);
+    puts("Merge tail test passed.");
+}
+
+// --fields over a quoted CSV, whole and as three --range partials
+static void fields_cli_test(void){
+    FILE *fp=fopen("/tmp/wc_fields.csv","w");
+    assert(fp);
+    for(int i=0;i<5000;i++) fprintf(fp,"%d,\"name, %d\",\"multi\nline\",%s\n",i,i,i%3?"x":"y,z");
+    fclose(fp);
+    assert(system("./wc --fields=, /tmp/wc_fields.csv | awk '{print $1,$2,$3,$4}' > /tmp/wc_fields_whole")==0);
+    assert(system("rm -f /tmp/wc_fields_parts;"
+                  " for r in 0:1000 1000:77777 77777:; do ./wc --fields=, --range=$r /tmp/wc_fields.csv >> /tmp/wc_fields_parts; done;"
+                  " ./wc --merge /tmp/wc_fields_parts | awk '{print $1,$2,$3,$4}' | diff -q - /tmp/wc_fields_whole")==0);
+    assert(system("awk '{exit !($1==5000&&$2==21667&&$3==4&&$4==5)}' /tmp/wc_fields_whole")==0);
+    puts("Fields range/merge integration test passed.");
+}
+
+// A word longer than one stdin read is still one word
+static void stdin_straddle_test(void){
+    assert(system("head -c 200000 /dev/zero | tr '\\0' x | ./wc | awk '{exit !($1==0&&$2==1&&$3==200000)}'")==0);
+    puts("Stdin straddle test passed.");
+}
+
+// Sparse file: holes at the start, the end and between words; counts
+// from the hole-skipping path must match a scan of every byte
+static void sparse_test(void){
+    const char *path="/tmp/wc_sparse_test";
+    const uint64_t size=64ull<<20;
+    static const struct { uint64_t off; const char *s; } extents[]={
+        {1u<<20,"hello wo"},           // word runs into a hole
+        {(2u<<20)+5,"rld\n\n"},        // and out of it
+        {(8u<<20)-3," a b\n"},
+        {(8u<<20)+4096,"   \n"},       // spaces, then a hole starts a word
+        {(40u<<20),"tail words"},
+    };
+    int fd=open(path,O_RDWR|O_CREAT|O_TRUNC,0644);
+    assert(fd>=0);
+    assert(ftruncate(fd,(off_t)size)==0);
+    for(size_t i=0;i<sizeof(extents)/sizeof(extents[0]);i++){
+        size_t n=strlen(extents[i].s);
+        assert(pwrite(fd,extents[i].s,n,(off_t)extents[i].off)==(ssize_t)n);
+    }
+    uint8_t *all=calloc(1,size);
+    assert(all);
+    assert(pread(fd,all,size,0)==(ssize_t)size);
+    close(fd);
+
+    wc_counts_t want={0},got={0};
+    wc_count_buffer(all,size,&want);
+    assert(wc_count_path(path,&got)==0);
+    assert(got.lines==want.lines&&got.words==want.words&&got.bytes==want.bytes);
+
+    // Range partials that start and end inside holes merge to the same counts
+    const uint64_t cuts[]={0,1000,(1u<<20)+3,(2u<<20)+6,(8u<<20)-1,(30u<<20),size};
+    wc_partial_t parts[6];
+    for(int i=0;i<6;i++) assert(wc_partial_file(path,cuts[i],cuts[i+1],&parts[i])==0);
+    assert(wc_partial_merge(parts,6,&got)==0);
+    assert(got.lines==want.lines&&got.words==want.words&&got.bytes==want.bytes);
+
+    free(all);
+    unlink(path);
+    puts("Sparse file tests passed!");
+}
+
 int main(void){
     run_case("",0,0,0);
     run_case("hello\n",1,1,6);
     run_case("hello world\n",1,2,12);
-    run_case("  leading and trailing  \n",1,3,27);
+    run_case("  leading and trailing  \n",1,3,25);
     run_case("\n\n\n",3,0,3);
     run_case("one two\nthree\tfour\n",2,4,19);
     puts("All unit tests passed!");
+    kernel_tests();
+    partial_tests();
+    fields_tests();
+    sparse_test();
 
     // Integration test: compare with system wc for this source file
     const char *path="src/wc.c";
@@ -28,8 +322,13 @@ int main(void){
     snprintf(cmd,sizeof(cmd),"./wc %s | awk '{print $1,$2,$3}' > /tmp/self_wc",path);
     system(cmd);
     snprintf(cmd,sizeof(cmd),"/usr/bin/wc %s | awk '{print $1,$2,$3}' > /tmp/sys_wc",path);
+    system(cmd);
     int diff=system("diff -q /tmp/self_wc /tmp/sys_wc");
     assert(diff==0);
     puts("Integration test passed (output matches BSD wc).\n");
+    range_merge_test(path);
+    merge_tail_test();
+    fields_cli_test();
+    stdin_straddle_test();
     return 0;
 }
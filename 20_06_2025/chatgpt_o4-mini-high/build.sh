@@ -1 +1 @@
-clang -O3 -std=c11 wc.c test_wc.c -o wc_test && ./wc_test
+clang -O3 -std=c11 test_wc.c -o wc_test -lpthread && ./wc_test
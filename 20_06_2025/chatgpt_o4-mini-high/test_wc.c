@@ -1,5 +1,5 @@
 // test_wc.c
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -8,6 +8,8 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/mman.h>
+#define WC_NO_MAIN
 #include "wc.c"  // bring in count_buffer & process_fd
 
 // Helper to run process_fd on a temp file with given content
@@ -20,7 +22,7 @@ static void integration_test(const char *content,
     assert(fd >= 0);
     write(fd, content, strlen(content));
     lseek(fd, 0, SEEK_SET);
-    struct stats s = {0,0,0};
+    struct stats s = {0,0,0,0};
     int rc = process_fd(fd, &s);
     assert(rc == 0);
     assert(s.lines == exp_lines);
@@ -43,14 +45,11 @@ static void unit_tests() {
     // Single word, no newline
     memset(&s,0,sizeof(s));
     count_buffer("hello",5,&s);
-    // finalize trailing word
-    if (5 > 0 && !is_ascii_space('o')) s.words++;
     assert(s.lines == 0 && s.words == 1 && s.bytes == 5);
 
     // Spaces only
     memset(&s,0,sizeof(s));
     count_buffer("   \t\n",5,&s);
-    if (5 > 0 && !is_ascii_space('\n')) s.words++;
     assert(s.lines == 1 && s.words == 0 && s.bytes == 5);
 
     // Multiple words
@@ -62,6 +61,16 @@ static void unit_tests() {
     // words: foo,bar,baz,qux
     assert(s.words == 4);
     assert(s.bytes == strlen(txt));
+
+    // A word split across buffers counts once; one ending at a seam too
+    memset(&s,0,sizeof(s));
+    count_buffer("hel",3,&s);
+    count_buffer("lo world",8,&s);
+    assert(s.words == 2 && s.in_word);
+    memset(&s,0,sizeof(s));
+    count_buffer("hello",5,&s);
+    count_buffer(" world",6,&s);
+    assert(s.words == 2);
 }
 
 // Integration tests
@@ -70,7 +79,7 @@ static void run_integration() {
     integration_test("one two three", 0, 3, 13);
     integration_test("line1\nline2\n", 2, 2, 12);
     integration_test("multi\n\nnewline\n", 3, 2, 15);
-    integration_test("tab\tseparated\twords", 0, 3, 21);
+    integration_test("tab\tseparated\twords", 0, 3, 19);
 }
 
 // Simple performance test: process a big buffer N times
@@ -81,7 +90,7 @@ static void perf_test() {
     for (size_t i = 0; i < chunk; i++) {
         buf[i] = (i % 64 == 0 ? '\n' : 'a');
     }
-    struct stats s = {0,0,0};
+    struct stats s = {0,0,0,0};
     const int reps = 10;
     struct timespec t0, t1;
     clock_gettime(CLOCK_MONOTONIC, &t0);
@@ -92,11 +101,175 @@ static void perf_test() {
     double sec = (t1.tv_sec - t0.tv_sec)
                + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
     double total_mb = (chunk * reps) / (1024.0 * 1024.0);
-    printf("\nPerformance: %.2f MiB in %.3f s -> %.2f MiB/s\n",
-           total_mb, sec, total_mb / sec);
+    printf("\nPerformance: %.2f MiB in %.3f s -> %.2f MiB/s (%" PRIu64 " lines)\n",
+           total_mb, sec, total_mb / sec, s.lines);
     free(buf);
 }
 
+// Fraction of a file's pages in the page cache
+static double resident_fraction(const char *path) {
+    int fd = open(path, O_RDONLY);
+    assert(fd >= 0);
+    struct stat st;
+    fstat(fd, &st);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t npages = ((size_t)st.st_size + page - 1) / page;
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    unsigned char *vec = malloc(npages);
+    assert(map != MAP_FAILED && vec != NULL);
+    assert(mincore(map, (size_t)st.st_size, (void *)vec) == 0);
+    size_t resident = 0;
+    for (size_t i = 0; i < npages; i++) resident += vec[i] & 1;
+    free(vec);
+    munmap(map, (size_t)st.st_size);
+    close(fd);
+    return (double)resident / (double)npages;
+}
+
+static void evict(const char *path) {
+    int fd = open(path, O_RDONLY);
+    assert(fd >= 0);
+    fsync(fd);
+#if defined(POSIX_FADV_DONTNEED)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    close(fd);
+}
+
+static double now_sec(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// --direct: same counts as buffered reads at awkward sizes, and no page
+// cache growth on a cold file
+static void direct_tests() {
+    char fn[] = "/tmp/wc_direct_XXXXXX";
+    int fd = mkstemp(fn);
+    assert(fd >= 0);
+    // 9 MiB + 123 bytes: blocks, a partial block and an unaligned tail.
+    // Words straddle the 4 MiB block seams.
+    const size_t size = 9 * 1024 * 1024 + 123;
+    char *data = malloc(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (i % 61 == 0) ? '\n' : (i % 7 == 0) ? ' ' : 'x';
+    }
+    assert(write(fd, data, size) == (ssize_t)size);
+    free(data);
+
+    struct stats want = {0,0,0,0}, got = {0,0,0,0};
+    lseek(fd, 0, SEEK_SET);
+    assert(process_fd(fd, &want) == 0);
+    close(fd);
+    for (int qd = 1; qd <= 8; qd *= 2) {
+        memset(&got, 0, sizeof(got));
+        assert(process_path_direct(fn, qd, &got) == 0);
+        assert(got.lines == want.lines && got.words == want.words && got.bytes == want.bytes);
+    }
+
+    // Small files: shorter than one alignment unit, and empty
+    const char *smalls[] = {"abc", ""};
+    for (int i = 0; i < 2; i++) {
+        fd = open(fn, O_WRONLY | O_TRUNC);
+        assert(write(fd, smalls[i], strlen(smalls[i])) == (ssize_t)strlen(smalls[i]));
+        close(fd);
+        memset(&got, 0, sizeof(got));
+        assert(process_path_direct(fn, 4, &got) == 0);
+        assert(got.bytes == strlen(smalls[i]) && got.words == (i == 0));
+    }
+
+    // Cold-cache run: buffered reads fill the page cache, --direct must not
+    const size_t big = 128u << 20;
+    fd = open(fn, O_WRONLY | O_TRUNC);
+    char *chunk = malloc(1 << 20);
+    for (size_t i = 0; i < (1 << 20); i++) chunk[i] = (i % 64 == 0) ? '\n' : 'a';
+    for (size_t i = 0; i < big; i += 1 << 20) assert(write(fd, chunk, 1 << 20) == 1 << 20);
+    free(chunk);
+    close(fd);
+
+    evict(fn);
+    if (resident_fraction(fn) < 0.05) {
+        double t0 = now_sec();
+        fd = open(fn, O_RDONLY);
+        assert(process_fd(fd, &want) == 0);
+        close(fd);
+        double buffered_sec = now_sec() - t0;
+        double buffered_res = resident_fraction(fn);
+
+        evict(fn);
+        t0 = now_sec();
+        assert(process_path_direct(fn, DIRECT_DEFAULT_QD, &got) == 0);
+        double direct_sec = now_sec() - t0;
+        double direct_res = resident_fraction(fn);
+        assert(got.lines == want.lines && got.words == want.words);
+        assert(direct_res < 0.05);
+
+        printf("Cold 128 MiB: buffered %.0f MiB/s (%.0f%% cached after), "
+               "--direct %.0f MiB/s (%.0f%% cached after)\n",
+               128 / buffered_sec, buffered_res * 100, 128 / direct_sec, direct_res * 100);
+    } else {
+        printf("Cold-cache check skipped (cannot evict pages here)\n");
+    }
+    unlink(fn);
+}
+
+// Limits: reached exactly at the threshold, not one short of it, on every
+// driver; a small limit on a big file returns after the first block
+static void limit_tests() {
+    char fn[] = "/tmp/wc_limit_XXXXXX";
+    int fd = mkstemp(fn);
+    assert(fd >= 0);
+    // 64 MiB of 63-byte lines, 4 words each
+    const size_t size = 64u << 20;
+    char *data = malloc(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (i % 64 == 63) ? '\n' : (i % 16 == 15) ? ' ' : 'x';
+    }
+    assert(write(fd, data, size) == (ssize_t)size);
+    free(data);
+    const uint64_t lines = size / 64, nonspace = size / 64 * 60;
+
+    struct {
+        struct limits lim;
+        int reached;
+    } cases[] = {
+        {{lines, 0}, 1},
+        {{lines + 1, 0}, 0},
+        {{0, nonspace}, 1},
+        {{0, nonspace + 1}, 0},
+        {{lines + 1, nonspace + 1}, 0},
+        {{lines + 1, 1}, 1},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        struct stats s;
+        lseek(fd, 0, SEEK_SET);
+        assert(process_fd_limited(fd, &cases[c].lim, &s) == cases[c].reached);
+        if (!cases[c].reached) assert(s.lines == lines && s.bytes == size);
+        for (int qd = 1; qd <= 4; qd *= 4) {
+            assert(process_path_direct_limited(fn, qd, &cases[c].lim, &s) == cases[c].reached);
+        }
+    }
+
+    // Small threshold on a big file
+    struct limits small = {1000, 0};
+    struct stats s;
+    double t0 = now_sec();
+    lseek(fd, 0, SEEK_SET);
+    assert(process_fd_limited(fd, &small, &s) == 1);
+    double limited_sec = now_sec() - t0;
+    assert(s.bytes == LIMIT_BLOCK);
+    t0 = now_sec();
+    lseek(fd, 0, SEEK_SET);
+    assert(process_fd(fd, &s) == 0);
+    double full_sec = now_sec() - t0;
+    printf("--at-least=1000 on 64 MiB: %.0f us (full count %.0f us)\n",
+           limited_sec * 1e6, full_sec * 1e6);
+
+    close(fd);
+    unlink(fn);
+}
+
 int main(void) {
     printf("Running unit tests...\n");
     unit_tests();
@@ -106,6 +279,14 @@ int main(void) {
     run_integration();
     printf("Integration tests passed.\n");
 
+    printf("Running --direct tests...\n");
+    direct_tests();
+    printf("--direct tests passed.\n");
+
+    printf("Running limit tests...\n");
+    limit_tests();
+    printf("Limit tests passed.\n");
+
     printf("Running performance test...\n");
     perf_test();
 
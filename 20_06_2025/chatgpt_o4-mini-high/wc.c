@@ -1,17 +1,22 @@
 // wc.c
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE  // O_DIRECT, getopt_long
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 struct stats {
     uint64_t lines;
     uint64_t words;
     uint64_t bytes;
+    int in_word;  // last byte seen was part of a word
 };
 
 // Return non‐zero if ASCII whitespace (space, \n, \t, \v, \f, \r)
@@ -21,8 +26,10 @@ static inline int is_ascii_space(char c) {
 }
 
 // Process a single buffer, update stats.
+// Words are counted at their first byte; s->in_word carries the state into
+// the next buffer, so a word split across two reads is counted once.
 void count_buffer(const char *buf, size_t len, struct stats *s) {
-    uint64_t in_word = 0;
+    uint64_t in_word = s->in_word;
     s->bytes += len;
     for (size_t i = 0; i < len; i++) {
         char c = buf[i];
@@ -30,80 +37,477 @@ void count_buffer(const char *buf, size_t len, struct stats *s) {
             s->lines++;
         }
         int sp = is_ascii_space(c);
-        // Transition from non-space to space ends a word
-        if (!sp) {
-            in_word = 1;
-        } else if (in_word) {
-            s->words++;
-            in_word = 0;
-        }
+        // Transition from space to non-space starts a word
+        s->words += !sp & !in_word;
+        in_word = !sp;
     }
-    // If buffer ends in a word, we defer counting until next chunk or end‐of‐file.
-    // Caller must finalize.
+    s->in_word = (int)in_word;
 }
 
-// Process one file descriptor
-int process_fd(int fd, struct stats *s) {
+// ---- --at-least / --max-lines / --max-nonspace: stop once decided ----
+
+enum {
+    LIMIT_BLOCK = 64 << 10,    // limits are checked after every block this size
+    WC_EXIT_LIMIT = 3,         // exit status when a file reached a limit
+};
+
+// Counts at which reading stops; 0 leaves that count unchecked
+struct limits {
+    uint64_t lines;
+    uint64_t nonspace;         // bytes that are not ASCII whitespace
+};
+
+static inline int limit_reached(const struct limits *lim, uint64_t lines, uint64_t nonspace) {
+    return (lim->lines && lines >= lim->lines) ||
+           (lim->nonspace && nonspace >= lim->nonspace);
+}
+
+static uint64_t count_nonspace(const char *buf, size_t len) {
+    uint64_t n = 0;
+    for (size_t i = 0; i < len; i++) n += !is_ascii_space(buf[i]);
+    return n;
+}
+
+// count_buffer() one block at a time, checking the limits after each.
+// Returns 1 as soon as one is reached; the rest of buf is left uncounted.
+static int count_limited(const char *buf, size_t len, struct stats *s,
+                         uint64_t *nonspace, const struct limits *lim) {
+    if (!lim) {
+        count_buffer(buf, len, s);
+        return 0;
+    }
+    for (size_t off = 0; off < len; off += LIMIT_BLOCK) {
+        size_t n = len - off < LIMIT_BLOCK ? len - off : LIMIT_BLOCK;
+        count_buffer(buf + off, n, s);
+        if (lim->nonspace) *nonspace += count_nonspace(buf + off, n);
+        if (limit_reached(lim, s->lines, *nonspace)) return 1;
+    }
+    return 0;
+}
+
+// Process one file descriptor, stopping early once lim (may be NULL) is
+// reached. Returns 1 if it was, 0 at EOF, -1 on error.
+int process_fd_limited(int fd, const struct limits *lim, struct stats *s) {
     enum { BUF_SIZE = 1 << 20 }; // 1 MiB
     char *buf = malloc(BUF_SIZE);
     if (!buf) {
         perror("malloc");
         return -1;
     }
-    struct stats local = {0,0,0};
+    struct stats local = {0,0,0,0};
+    uint64_t nonspace = 0;
+    // With a limit, start with one block so a small one is decided before
+    // a full buffer has been read, then grow back to BUF_SIZE
+    size_t want = lim ? LIMIT_BLOCK : BUF_SIZE;
+    int reached = 0;
     ssize_t r;
-    while ((r = read(fd, buf, BUF_SIZE)) > 0) {
-        count_buffer(buf, (size_t)r, &local);
+    while (!reached && (r = read(fd, buf, want)) > 0) {
+        reached = count_limited(buf, (size_t)r, &local, &nonspace, lim);
+        if (want < BUF_SIZE) want *= 2;
     }
-    if (r < 0) {
+    if (!reached && r < 0) {
         perror("read");
         free(buf);
         return -1;
     }
-    // If file did not end in whitespace, we have one trailing word
-    // Check last byte:
-    if (local.bytes > 0) {
-        char last = buf[(size_t)( (local.bytes - 1) % BUF_SIZE )];
-        if (!is_ascii_space(last))
-            local.words++;
-    }
     *s = local;
     free(buf);
+    return reached;
+}
+
+// Process one file descriptor
+int process_fd(int fd, struct stats *s) {
+    return process_fd_limited(fd, NULL, s) < 0 ? -1 : 0;
+}
+
+// ---- --direct: O_DIRECT reads that bypass the page cache ----
+
+enum {
+    DIRECT_ALIGN = 4096,       // covers 512e and 4Kn devices
+    DIRECT_BLOCK = 4 << 20,    // bytes per request
+    DIRECT_DEFAULT_QD = 4,     // reader threads = requests in flight
+};
+
+// Counts for one block, counted with no word in progress. When blocks are
+// stitched back together, a word that runs across the seam was counted
+// twice and is taken off again.
+struct block_stats {
+    uint64_t lines;
+    uint64_t words;
+    uint64_t bytes;
+    uint8_t first_in_word;
+    uint8_t last_in_word;
+};
+
+struct direct_job {
+    int fd;                    // O_DIRECT descriptor
+    int tail_fd;               // plain descriptor for a tail O_DIRECT refuses
+    uint64_t size;
+    uint64_t nblocks;
+    uint64_t next;             // next block to claim
+    int failed;                // errno of the first failed read, 0 if none
+    const struct limits *lim;  // NULL unless counting against a limit
+    uint64_t lines;            // limit mode: totals over finished blocks
+    uint64_t nonspace;
+    int reached;               // a limit was reached; no more blocks are claimed
+    pthread_mutex_t lock;
+    struct block_stats *blocks;
+};
+
+static int direct_claim(struct direct_job *job, uint64_t *k) {
+    pthread_mutex_lock(&job->lock);
+    int ok = !job->failed && !job->reached && job->next < job->nblocks;
+    if (ok) *k = job->next++;
+    pthread_mutex_unlock(&job->lock);
+    return ok;
+}
+
+static void direct_fail(struct direct_job *job, int err) {
+    pthread_mutex_lock(&job->lock);
+    if (!job->failed) job->failed = err;
+    pthread_mutex_unlock(&job->lock);
+}
+
+static void *direct_reader(void *arg) {
+    struct direct_job *job = arg;
+    char *buf;
+    if (posix_memalign((void **)&buf, DIRECT_ALIGN, DIRECT_BLOCK) != 0) {
+        direct_fail(job, ENOMEM);
+        return NULL;
+    }
+
+    uint64_t k;
+    while (direct_claim(job, &k)) {
+        off_t off = (off_t)(k * DIRECT_BLOCK);
+        size_t want = job->size - (uint64_t)off < DIRECT_BLOCK ? job->size - (uint64_t)off : DIRECT_BLOCK;
+        size_t got = 0;
+        while (got < want) {
+            ssize_t r;
+            if (got % DIRECT_ALIGN == 0) {
+                // Round the request up; at EOF the kernel returns a short count
+                size_t req = (want - got + DIRECT_ALIGN - 1) / DIRECT_ALIGN * DIRECT_ALIGN;
+                r = pread(job->fd, buf + got, req, off + (off_t)got);
+                if (r < 0 && errno == EINVAL && req != want - got) {
+                    // Some filesystems refuse an unaligned tail; read it through the cache
+                    r = pread(job->tail_fd, buf + got, want - got, off + (off_t)got);
+                }
+            } else {
+                r = pread(job->tail_fd, buf + got, want - got, off + (off_t)got);
+            }
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) {
+                direct_fail(job, errno);
+                break;
+            }
+            if (r == 0) break;  // file shrank under us
+            got += (size_t)r;
+        }
+        if (got > want) got = want;  // file grew under us
+
+        struct stats s = {0,0,0,0};
+        count_buffer(buf, got, &s);
+        struct block_stats *b = &job->blocks[k];
+        b->lines = s.lines;
+        b->words = s.words;
+        b->bytes = s.bytes;
+        b->first_in_word = got > 0 && !is_ascii_space(buf[0]);
+        b->last_in_word = (uint8_t)s.in_word;
+
+        if (job->lim) {
+            // Blocks finish out of order, but both limits are plain sums
+            uint64_t ns = job->lim->nonspace ? count_nonspace(buf, got) : 0;
+            pthread_mutex_lock(&job->lock);
+            job->lines += s.lines;
+            job->nonspace += ns;
+            if (limit_reached(job->lim, job->lines, job->nonspace)) job->reached = 1;
+            pthread_mutex_unlock(&job->lock);
+        }
+    }
+    free(buf);
+    return NULL;
+}
+
+static int open_direct(const char *path) {
+#if defined(O_DIRECT)
+    return open(path, O_RDONLY | O_DIRECT);
+#elif defined(F_NOCACHE)
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0 && fcntl(fd, F_NOCACHE, 1) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    (void)path;
+    errno = EINVAL;
+    return -1;
+#endif
+}
+
+// Buffered fallback that still keeps the cache footprint flat: every chunk
+// is dropped from the page cache once it has been counted.
+static int process_fd_dropbehind(int fd, const struct limits *lim, struct stats *s) {
+    enum { BUF_SIZE = 1 << 20 };
+    char *buf = malloc(BUF_SIZE);
+    if (!buf) {
+        perror("malloc");
+        return -1;
+    }
+    struct stats local = {0,0,0,0};
+    uint64_t nonspace = 0;
+    int reached = 0;
+    off_t off = 0;
+    ssize_t r;
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    while (!reached && (r = read(fd, buf, BUF_SIZE)) > 0) {
+        reached = count_limited(buf, (size_t)r, &local, &nonspace, lim);
+#if defined(POSIX_FADV_DONTNEED)
+        posix_fadvise(fd, off, r, POSIX_FADV_DONTNEED);
+#endif
+        off += r;
+    }
+    free(buf);
+    if (!reached && r < 0) {
+        perror("read");
+        return -1;
+    }
+    *s = local;
+    return reached;
+}
+
+// Count a regular file with O_DIRECT and `qd` concurrent reads. Falls back
+// to drop-behind buffered reads when the file or filesystem can't do it.
+// With a limit, reaching it stops the readers claiming further blocks and
+// returns 1; blocks already in flight still finish.
+int process_path_direct_limited(const char *path, int qd, const struct limits *lim,
+                                struct stats *s) {
+    int fd = open_direct(path);
+    int direct_errno = errno;
+    int tail_fd = open(path, O_RDONLY);
+    struct stat st;
+    if (tail_fd < 0) {
+        fprintf(stderr, "wc: cannot open '%s': %s\n", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    if (fd < 0 || fstat(tail_fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        if (fd < 0) {
+            fprintf(stderr, "wc: %s: O_DIRECT not supported (%s), using buffered reads\n",
+                    path, strerror(direct_errno));
+        } else {
+            close(fd);
+        }
+        int rc = process_fd_dropbehind(tail_fd, lim, s);
+        close(tail_fd);
+        return rc;
+    }
+
+    if (qd < 1) qd = 1;
+    struct direct_job job = {
+        .fd = fd,
+        .tail_fd = tail_fd,
+        .size = (uint64_t)st.st_size,
+        .nblocks = ((uint64_t)st.st_size + DIRECT_BLOCK - 1) / DIRECT_BLOCK,
+        .lim = lim,
+    };
+    if ((uint64_t)qd > job.nblocks) qd = job.nblocks ? (int)job.nblocks : 1;
+    job.blocks = calloc(job.nblocks ? job.nblocks : 1, sizeof(*job.blocks));
+    pthread_t *threads = malloc((size_t)qd * sizeof(*threads));
+    if (!job.blocks || !threads) {
+        perror("malloc");
+        free(job.blocks);
+        free(threads);
+        close(fd);
+        close(tail_fd);
+        return -1;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+
+    int started = 0;
+    for (; started < qd; started++) {
+        if (pthread_create(&threads[started], NULL, direct_reader, &job) != 0) break;
+    }
+    if (started == 0) direct_reader(&job);
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&job.lock);
+
+    int rc = 0;
+    if (job.failed == EINVAL) {
+        // Open accepted O_DIRECT but reads do not (e.g. some FUSE/NFS mounts)
+        fprintf(stderr, "wc: %s: O_DIRECT reads rejected, using buffered reads\n", path);
+        lseek(tail_fd, 0, SEEK_SET);
+        rc = process_fd_dropbehind(tail_fd, lim, s);
+    } else if (job.failed) {
+        fprintf(stderr, "wc: %s: read: %s\n", path, strerror(job.failed));
+        rc = -1;
+    } else if (job.reached) {
+        // Only the limited counts mean anything for a partial read
+        struct stats local = {job.lines, 0, 0, 0};
+        *s = local;
+        rc = 1;
+    } else {
+        struct stats local = {0,0,0,0};
+        for (uint64_t k = 0; k < job.nblocks; k++) {
+            const struct block_stats *b = &job.blocks[k];
+            local.lines += b->lines;
+            local.words += b->words - (local.in_word && b->first_in_word);
+            local.bytes += b->bytes;
+            if (b->bytes) local.in_word = b->last_in_word;
+        }
+        *s = local;
+    }
+
+    free(job.blocks);
+    free(threads);
+    close(fd);
+    close(tail_fd);
+    return rc;
+}
+
+int process_path_direct(const char *path, int qd, struct stats *s) {
+    return process_path_direct_limited(path, qd, NULL, s);
+}
+
+#ifndef WC_NO_MAIN
+// Parse a non-negative count for a limit option
+static int parse_count(const char *arg, const char *opt, uint64_t *out) {
+    char *end;
+    errno = 0;
+    unsigned long long v = strtoull(arg, &end, 10);
+    if (errno || end == arg || *end || arg[0] == '-') {
+        fprintf(stderr, "wc: invalid %s count '%s'\n", opt, arg);
+        return -1;
+    }
+    *out = v;
     return 0;
 }
 
+// Keep the tighter of two stop counts, 0 meaning none
+static uint64_t tighter(uint64_t a, uint64_t b) {
+    return !a ? b : !b ? a : a < b ? a : b;
+}
+
 int main(int argc, char *argv[]) {
-    struct stats total = {0,0,0};
+    struct stats total = {0,0,0,0};
     int files = 0;
-    if (argc == 1) {
+    int direct = 0;
+    int qd = DIRECT_DEFAULT_QD;
+    struct limits lim = {0, 0};
+    int limited = 0;
+    uint64_t n;
+
+    static struct option long_options[] = {
+        {"direct",       no_argument,       0, 'd'},
+        {"queue-depth",  required_argument, 0, 'q'},
+        {"at-least",     required_argument, 0, 'a'},
+        {"max-lines",    required_argument, 0, 'm'},
+        {"max-nonspace", required_argument, 0, 'n'},
+        {0, 0, 0, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'd': direct = 1; break;
+        case 'q': qd = atoi(optarg); break;
+        case 'a':
+            if (parse_count(optarg, "--at-least", &n) != 0) return 1;
+            if (n == 0) {
+                // Holds before reading anything
+                fprintf(stderr, "wc: --at-least needs a count of 1 or more\n");
+                return 1;
+            }
+            lim.lines = tighter(lim.lines, n);
+            limited = 1;
+            break;
+        case 'm':
+            if (parse_count(optarg, "--max-lines", &n) != 0) return 1;
+            lim.lines = tighter(lim.lines, n == UINT64_MAX ? n : n + 1);
+            limited = 1;
+            break;
+        case 'n':
+            if (parse_count(optarg, "--max-nonspace", &n) != 0) return 1;
+            lim.nonspace = tighter(lim.nonspace, n == UINT64_MAX ? n : n + 1);
+            limited = 1;
+            break;
+        default:
+            fprintf(stderr, "usage: wc [--direct [--queue-depth=N]] "
+                            "[--at-least=N] [--max-lines=M] [--max-nonspace=M] [file...]\n");
+            return 1;
+        }
+    }
+
+    if (limited) {
+        // Threshold mode: no counts, just the files that reached a limit
+        // (like grep -l) and exit status WC_EXIT_LIMIT if any did
+        int any = 0, failed = 0;
+        if (optind == argc) {
+            struct stats s;
+            int rc = process_fd_limited(STDIN_FILENO, &lim, &s);
+            if (rc < 0) return 1;
+            return rc ? WC_EXIT_LIMIT : 0;
+        }
+        for (int i = optind; i < argc; i++) {
+            struct stats s;
+            int rc;
+            if (direct) {
+                rc = process_path_direct_limited(argv[i], qd, &lim, &s);
+            } else {
+                int fd = open(argv[i], O_RDONLY);
+                if (fd < 0) {
+                    fprintf(stderr, "wc: cannot open '%s': %s\n",
+                            argv[i], strerror(errno));
+                    failed = 1;
+                    continue;
+                }
+                rc = process_fd_limited(fd, &lim, &s);
+                close(fd);
+            }
+            if (rc < 0) failed = 1;
+            if (rc > 0) {
+                printf("%s\n", argv[i]);
+                any = 1;
+            }
+        }
+        return failed ? 1 : any ? WC_EXIT_LIMIT : 0;
+    }
+
+    if (optind == argc) {
         struct stats s;
         if (process_fd(STDIN_FILENO, &s) != 0) return 1;
-        printf("%8" PRIu64 "%8" PRIu64 "%8" PRIu64 "\n",
+        printf(" %7" PRIu64 " %7" PRIu64 " %7" PRIu64 "\n",
                s.lines, s.words, s.bytes);
     } else {
-        for (int i = 1; i < argc; i++) {
-            int fd = open(argv[i], O_RDONLY);
-            if (fd < 0) {
-                fprintf(stderr, "wc: cannot open '%s': %s\n",
-                        argv[i], strerror(errno));
-                continue;
+        for (int i = optind; i < argc; i++) {
+            struct stats s = {0,0,0,0};
+            int rc;
+            if (direct) {
+                rc = process_path_direct(argv[i], qd, &s);
+            } else {
+                int fd = open(argv[i], O_RDONLY);
+                if (fd < 0) {
+                    fprintf(stderr, "wc: cannot open '%s': %s\n",
+                            argv[i], strerror(errno));
+                    continue;
+                }
+                rc = process_fd(fd, &s);
+                close(fd);
             }
-            struct stats s = {0,0,0};
-            if (process_fd(fd, &s) == 0) {
-                printf("%8" PRIu64 "%8" PRIu64 "%8" PRIu64 " %s\n",
+            if (rc == 0) {
+                printf(" %7" PRIu64 " %7" PRIu64 " %7" PRIu64 " %s\n",
                        s.lines, s.words, s.bytes, argv[i]);
                 total.lines  += s.lines;
                 total.words  += s.words;
                 total.bytes  += s.bytes;
                 files++;
             }
-            close(fd);
         }
         if (files > 1) {
-            printf("%8" PRIu64 "%8" PRIu64 "%8" PRIu64 " total\n",
+            printf(" %7" PRIu64 " %7" PRIu64 " %7" PRIu64 " total\n",
                    total.lines, total.words, total.bytes);
         }
     }
     return 0;
 }
-
+#endif
@@ -24,12 +24,12 @@ log_info() {
 
 log_success() {
     echo -e "${GREEN}[PASS]${NC} $1"
-    ((TESTS_PASSED++))
+    TESTS_PASSED=$((TESTS_PASSED + 1))
 }
 
 log_error() {
     echo -e "${RED}[FAIL]${NC} $1"
-    ((TESTS_FAILED++))
+    TESTS_FAILED=$((TESTS_FAILED + 1))
 }
 
 log_warning() {
@@ -96,7 +96,7 @@ print('short line')
     printf "hello\x00world\ntest\x00\x00line\n" > "$TEST_DIR/binary.txt"
     
     # Unicode content (but still ASCII for our implementation)
-    printf "ASCII text\nwith special chars: !@#$%^&*()\ntabs\there\n" > "$TEST_DIR/special_chars.txt"
+    printf "ASCII text\nwith special chars: !@#$%%^&*()\ntabs\there\n" > "$TEST_DIR/special_chars.txt"
     
     # File with no final newline but multiple lines
     printf "line1\nline2\nline3" > "$TEST_DIR/no_final_newline.txt"
@@ -281,11 +281,11 @@ performance_benchmark() {
     
     log_info "Benchmarking system wc..."
     local system_time
-    system_time=$(time (wc "$TEST_DIR/benchmark.txt" >/dev/null) 2>&1 | grep real | awk '{print $2}')
+    system_time=$( { time wc "$TEST_DIR/benchmark.txt" >/dev/null; } 2>&1 | grep real | awk '{print $2}')
     
     log_info "Benchmarking our wc..."
     local our_time
-    our_time=$(time (./wc "$TEST_DIR/benchmark.txt" >/dev/null) 2>&1 | grep real | awk '{print $2}')
+    our_time=$( { time ./wc "$TEST_DIR/benchmark.txt" >/dev/null; } 2>&1 | grep real | awk '{print $2}')
     
     log_info "System wc time: $system_time"
     log_info "Our wc time: $our_time"
@@ -378,6 +378,33 @@ test_command_line_options() {
     fi
 }
 
+# Test line-length statistics against awk
+test_line_histogram() {
+    log_info "Testing line-length histogram..."
+    
+    local file="$TEST_DIR/long_lines.txt"
+    local awk_max=$(awk '{ if (length($0) > m) m = length($0) } END { print m + 0 }' "$file")
+    local our_max=$(./wc -L "$file" | awk '{ print $1 }')
+    if [[ "$awk_max" == "$our_max" ]]; then
+        log_success "Max line length matches awk"
+    else
+        log_error "Max line length mismatch (awk: $awk_max, ours: $our_max)"
+    fi
+    
+    local our_lines=$(./wc --line-histogram=json "$file" | python3 -c "
+import json, sys
+h = json.load(sys.stdin)
+assert sum(b['count'] for b in h['buckets']) == h['lines']
+print(h['lines'])
+" 2>/dev/null || echo "ERROR")
+    local awk_lines=$(awk 'END { print NR }' "$file")
+    if [[ "$awk_lines" == "$our_lines" ]]; then
+        log_success "Line histogram JSON is consistent"
+    else
+        log_error "Line histogram JSON mismatch (awk: $awk_lines, ours: $our_lines)"
+    fi
+}
+
 # Stress testing
 stress_test() {
     log_info "Running stress tests..."
@@ -455,6 +482,7 @@ main() {
     test_error_handling
     test_corner_cases
     test_command_line_options
+    test_line_histogram
     stress_test
     performance_benchmark
     test_memory_usage
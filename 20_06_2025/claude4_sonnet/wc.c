@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE  // POSIX clocks and mmap flags under -std=c99 on glibc
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,10 +11,38 @@
 #include <ctype.h>
 #include <assert.h>
 #include <time.h>
+#include <stdint.h>
 
 #ifdef __ARM_NEON
 #include <arm_neon.h>
 #endif
+#ifdef __ARM_FEATURE_SVE
+#include <arm_sve.h>
+#endif
+
+// Line-length statistics for -L and --line-histogram.
+// Bucket 0 holds empty lines, bucket b holds lengths in [2^(b-1), 2^b).
+#define LINE_HIST_BUCKETS 64
+
+typedef struct {
+    size_t lines;          // lines measured, including an unterminated last line
+    size_t min;
+    size_t max;
+    size_t total_length;
+    size_t current;        // length of the line still in progress
+    size_t buckets[LINE_HIST_BUCKETS];
+} wc_line_stats_t;
+
+// Byte profile for --profile: the class counts are always filled in,
+// the 256-bin histogram only in full mode
+typedef struct {
+    size_t nul;
+    size_t cr;
+    size_t lf;
+    size_t tab;
+    size_t high;           // bytes >= 0x80
+    size_t histogram[256];
+} wc_profile_t;
 
 // Structure to hold counts
 typedef struct {
@@ -21,8 +50,14 @@ typedef struct {
     size_t words;
     size_t chars;
     size_t bytes;
+    size_t max_line_length;
+    wc_line_stats_t line_stats;
+    wc_profile_t profile;
 } wc_counts_t;
 
+enum { HIST_NONE = 0, HIST_TEXT, HIST_JSON };
+enum { PROFILE_NONE = 0, PROFILE_FULL, PROFILE_CLASSES };
+
 // Options structure
 typedef struct {
     int count_lines;
@@ -30,11 +65,79 @@ typedef struct {
     int count_chars;
     int count_bytes;
     int max_line_length;
+    int line_histogram;
+    int profile;
+    struct wc_line_index *index;   // --index: filled in by the counting pass
 } wc_options_t;
 
-// SIMD-optimized line counting for ARM64
-static size_t count_lines_simd(const char *data, size_t size) {
+#ifdef __ARM_FEATURE_SVE
+// Vector-length agnostic kernels for SVE/SVE2 cores (Graviton 3/4, Neoverse V).
+// Predicated loads cover the tail, so there is no scalar remainder loop; per-lane
+// u8 counters are only widened with svaddv every 255 iterations.
+
+static inline svbool_t sve_is_space(svbool_t pg, svuint8_t v) {
+    // ' ' or '\t'..'\r', the same set as count_words_optimized
+    return svorr_b_z(pg, svcmpeq_n_u8(pg, v, ' '),
+                     svcmple_n_u8(pg, svsub_n_u8_x(pg, v, '\t'), '\r' - '\t'));
+}
+
+static size_t count_lines_sve(const char *data, size_t size) {
+    const uint8_t *p = (const uint8_t *)data;
+    const uint64_t step = svcntb();
+    uint64_t count = 0, i = 0;
+    
+    while (i < size) {
+        svuint8_t acc = svdup_n_u8(0);
+        for (int k = 0; k < 255 && i < size; k++, i += step) {
+            svbool_t pg = svwhilelt_b8_u64(i, size);
+            svuint8_t v = svld1_u8(pg, p + i);
+            acc = svadd_n_u8_m(svcmpeq_n_u8(pg, v, '\n'), acc, 1);
+        }
+        count += svaddv_u8(svptrue_b8(), acc);
+    }
+    return count;
+}
+
+// A word starts at every non-space byte preceded by a space; the preceding
+// bytes are simply a second load at offset -1
+static size_t count_words_sve(const char *data, size_t size) {
+    if (size == 0) return 0;
+    
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t count = !(p[0] == ' ' || (uint8_t)(p[0] - '\t') <= '\r' - '\t');
+    
+    for (uint64_t i = 1; i < size; i += svcntb()) {
+        svbool_t pg = svwhilelt_b8_u64(i, size);
+        svbool_t cur = sve_is_space(pg, svld1_u8(pg, p + i));
+        svbool_t prev = sve_is_space(pg, svld1_u8(pg, p + i - 1));
+        count += svcntp_b8(pg, svbic_b_z(pg, prev, cur));
+    }
+    return count;
+}
+
+// UTF-8 characters are the bytes that are not continuations (10xxxxxx),
+// i.e. >= -64 as signed bytes
+static size_t count_chars_sve(const char *data, size_t size) {
+    const int8_t *p = (const int8_t *)data;
+    const uint64_t step = svcntb();
+    uint64_t count = 0, i = 0;
+    
+    while (i < size) {
+        svuint8_t acc = svdup_n_u8(0);
+        for (int k = 0; k < 255 && i < size; k++, i += step) {
+            svbool_t pg = svwhilelt_b8_u64(i, size);
+            svint8_t v = svld1_s8(pg, p + i);
+            acc = svadd_n_u8_m(svcmpge_n_s8(pg, v, -64), acc, 1);
+        }
+        count += svaddv_u8(svptrue_b8(), acc);
+    }
+    return count;
+}
+#endif
+
 #ifdef __ARM_NEON
+// 128-bit NEON line counting, also the baseline the SVE kernel is measured against
+static size_t count_lines_neon(const char *data, size_t size) {
     const char *ptr = data;
     const char *end = data + size;
     size_t count = 0;
@@ -65,6 +168,15 @@ static size_t count_lines_simd(const char *data, size_t size) {
     }
     
     return count;
+}
+#endif
+
+// SIMD-optimized line counting for ARM64
+static size_t count_lines_simd(const char *data, size_t size) {
+#if defined(__ARM_FEATURE_SVE)
+    return count_lines_sve(data, size);
+#elif defined(__ARM_NEON)
+    return count_lines_neon(data, size);
 #else
     // Fallback for non-NEON systems
     size_t count = 0;
@@ -75,10 +187,398 @@ static size_t count_lines_simd(const char *data, size_t size) {
 #endif
 }
 
+static inline void line_stats_add(wc_line_stats_t *st, size_t len) {
+    int bucket = len ? 64 - __builtin_clzll((unsigned long long)len) : 0;
+    if (bucket >= LINE_HIST_BUCKETS) bucket = LINE_HIST_BUCKETS - 1;
+    
+    if (st->lines == 0 || len < st->min) st->min = len;
+    if (len > st->max) st->max = len;
+    st->lines++;
+    st->total_length += len;
+    st->buckets[bucket]++;
+}
+
+// Line-length scan for -L and --line-histogram. Uses the same NEON
+// newline compare as count_lines_simd, but turns each match mask into
+// newline offsets so every line length comes out of the one pass.
+// Returns the newline count; an unterminated last line stays in
+// st->current until line_stats_finish().
+static size_t line_stats_simd(const char *data, size_t size, wc_line_stats_t *st) {
+    size_t newlines = 0;
+    size_t start = 0;              // offset where the current line began
+    size_t carry = st->current;    // part of that line seen in earlier buffers
+    size_t i = 0;
+    
+#ifdef __ARM_NEON
+    uint8x16_t newline_vec = vdupq_n_u8('\n');
+    
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t cmp = vceqq_u8(vld1q_u8((const uint8_t*)data + i), newline_vec);
+        
+        // Narrow to 4 bits per byte, keep one bit per byte
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL;
+        
+        while (mask) {
+            size_t pos = i + (__builtin_ctzll(mask) >> 2);
+            line_stats_add(st, carry + pos - start);
+            carry = 0;
+            start = pos + 1;
+            newlines++;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    
+    // Remainder (or everything without NEON): libc memchr is vectorised too
+    while (i < size) {
+        const char *nl = memchr(data + i, '\n', size - i);
+        if (!nl) break;
+        size_t pos = (size_t)(nl - data);
+        line_stats_add(st, carry + pos - start);
+        carry = 0;
+        start = pos + 1;
+        newlines++;
+        i = pos + 1;
+    }
+    
+    st->current = carry + size - start;
+    return newlines;
+}
+
+static void line_stats_finish(wc_line_stats_t *st) {
+    if (st->current > 0) line_stats_add(st, st->current);
+    st->current = 0;
+}
+
+static void line_stats_merge(wc_line_stats_t *dst, const wc_line_stats_t *src) {
+    if (src->lines == 0) return;
+    if (dst->lines == 0 || src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    dst->lines += src->lines;
+    dst->total_length += src->total_length;
+    for (int b = 0; b < LINE_HIST_BUCKETS; b++) dst->buckets[b] += src->buckets[b];
+}
+
+// Line-offset index for --index / --line. The counting pass records the
+// byte offset where every stride-th line starts (line 1, stride + 1, ...)
+// as LEB128 deltas. Every LINE_INDEX_INTERVAL-th entry also gets a
+// checkpoint with its absolute offset and its position in the delta
+// stream, so a lookup is three fixed-size reads of the index however
+// large the file is. On disk (all integers little-endian u64):
+//
+//   header       magic, stride, interval, lines, size, mtime, entries, checkpoints
+//   checkpoints  {offset, stream position after that entry} per checkpoint
+//   deltas       one varint per entry, offset - previous offset
+#define LINE_INDEX_MAGIC "WCLIDX1\n"
+#define LINE_INDEX_HEADER 64
+#define LINE_INDEX_INTERVAL 64
+#define LINE_INDEX_DEFAULT_STRIDE 1024
+#define LINE_INDEX_BLOCK 4096      // newlines are counted a block at a time
+
+typedef struct {
+    uint64_t stride;
+    uint64_t interval;
+    uint64_t lines;        // including an unterminated last line
+    uint64_t size;
+    uint64_t mtime;        // source modification time, 0 for stdin
+    uint64_t entries;
+    uint64_t checkpoints;
+} wc_index_header_t;
+
+typedef struct wc_line_index {
+    wc_index_header_t hdr;
+    uint64_t newlines;     // newlines seen so far
+    uint64_t next;         // newline count at which the next entry starts
+    uint64_t last;         // offset of the previous entry
+    uint8_t *deltas;
+    size_t len, cap;
+    uint64_t *checks;      // offset/position pairs
+    size_t check_cap;
+    int failed;
+} wc_line_index_t;
+
+static void line_index_init(wc_line_index_t *idx, uint64_t stride) {
+    memset(idx, 0, sizeof(*idx));
+    idx->hdr.stride = stride;
+    idx->hdr.interval = LINE_INDEX_INTERVAL;
+}
+
+static void line_index_free(wc_line_index_t *idx) {
+    free(idx->deltas);
+    free(idx->checks);
+    idx->deltas = NULL;
+    idx->checks = NULL;
+}
+
+static void line_index_add(wc_line_index_t *idx, uint64_t offset) {
+    if (idx->failed) return;
+    if (idx->cap - idx->len < 10) {
+        size_t cap = idx->cap ? idx->cap * 2 : 4096;
+        uint8_t *p = realloc(idx->deltas, cap);
+        if (!p) { idx->failed = 1; return; }
+        idx->deltas = p;
+        idx->cap = cap;
+    }
+    
+    uint64_t delta = offset - idx->last;
+    do {
+        uint8_t b = delta & 0x7f;
+        delta >>= 7;
+        idx->deltas[idx->len++] = b | (delta ? 0x80 : 0);
+    } while (delta);
+    idx->last = offset;
+    
+    if (idx->hdr.entries % idx->hdr.interval == 0) {
+        if (idx->hdr.checkpoints * 2 == idx->check_cap) {
+            size_t cap = idx->check_cap ? idx->check_cap * 2 : 64;
+            uint64_t *p = realloc(idx->checks, cap * sizeof(*p));
+            if (!p) { idx->failed = 1; return; }
+            idx->checks = p;
+            idx->check_cap = cap;
+        }
+        idx->checks[idx->hdr.checkpoints * 2] = offset;
+        idx->checks[idx->hdr.checkpoints * 2 + 1] = idx->len;
+        idx->hdr.checkpoints++;
+    }
+    idx->hdr.entries++;
+}
+
+// Index the next size bytes of the input and return their newline count;
+// call once per buffer, in order, starting at offset 0. Blocks without an
+// entry boundary cost one count_lines_simd call; only blocks that cross
+// one are walked with memchr to find the offset.
+static size_t line_index_scan(const char *data, size_t size, wc_line_index_t *idx) {
+    uint64_t base = idx->hdr.size, before = idx->newlines;
+    if (idx->hdr.entries == 0) {
+        line_index_add(idx, 0);
+        idx->next = idx->hdr.stride;
+    }
+    
+    for (size_t i = 0; i < size; i += LINE_INDEX_BLOCK) {
+        size_t n = size - i < LINE_INDEX_BLOCK ? size - i : LINE_INDEX_BLOCK;
+        size_t nl = count_lines_simd(data + i, n);
+        if (idx->newlines + nl < idx->next) {
+            idx->newlines += nl;
+            continue;
+        }
+        
+        const char *p = data + i;
+        const char *end = data + i + n;
+        while (nl && (p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+            p++;
+            nl--;
+            if (++idx->newlines == idx->next) {
+                line_index_add(idx, base + (uint64_t)(p - data));
+                idx->next += idx->hdr.stride;
+                if (idx->newlines + nl < idx->next) break;
+            }
+        }
+        idx->newlines += nl;
+    }
+    
+    idx->hdr.size = base + size;
+    if (size) idx->hdr.lines = idx->newlines + (data[size - 1] != '\n');
+    return (size_t)(idx->newlines - before);
+}
+
+static void put_u64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_u64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len) {
+        ssize_t w = write(fd, p, len);
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0) return -1;
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+static int line_index_write(const wc_line_index_t *idx, const char *path) {
+    if (idx->failed) {
+        fprintf(stderr, "wc: %s: memory allocation failed\n", path);
+        return -1;
+    }
+    
+    uint8_t hdr[LINE_INDEX_HEADER];
+    const wc_index_header_t *h = &idx->hdr;
+    memcpy(hdr, LINE_INDEX_MAGIC, 8);
+    put_u64(hdr + 8, h->stride);
+    put_u64(hdr + 16, h->interval);
+    put_u64(hdr + 24, h->lines);
+    put_u64(hdr + 32, h->size);
+    put_u64(hdr + 40, h->mtime);
+    put_u64(hdr + 48, h->entries);
+    put_u64(hdr + 56, h->checkpoints);
+    
+    size_t check_bytes = h->checkpoints * 16;
+    uint8_t *checks = malloc(check_bytes ? check_bytes : 1);
+    if (!checks) {
+        fprintf(stderr, "wc: %s: memory allocation failed\n", path);
+        return -1;
+    }
+    for (size_t i = 0; i < h->checkpoints * 2; i++) put_u64(checks + 8 * i, idx->checks[i]);
+    
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int rc = -1;
+    if (fd != -1 &&
+        write_all(fd, hdr, sizeof(hdr)) == 0 &&
+        write_all(fd, checks, check_bytes) == 0 &&
+        write_all(fd, idx->deltas, idx->len) == 0) {
+        rc = 0;
+    }
+    if (rc != 0) fprintf(stderr, "wc: %s: %s\n", path, strerror(errno));
+    if (fd != -1 && close(fd) != 0 && rc == 0) {
+        fprintf(stderr, "wc: %s: %s\n", path, strerror(errno));
+        rc = -1;
+    }
+    free(checks);
+    return rc;
+}
+
+static int line_index_read_header(int fd, wc_index_header_t *h) {
+    uint8_t hdr[LINE_INDEX_HEADER];
+    if (pread(fd, hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+        memcmp(hdr, LINE_INDEX_MAGIC, 8) != 0) {
+        return -1;
+    }
+    h->stride = get_u64(hdr + 8);
+    h->interval = get_u64(hdr + 16);
+    h->lines = get_u64(hdr + 24);
+    h->size = get_u64(hdr + 32);
+    h->mtime = get_u64(hdr + 40);
+    h->entries = get_u64(hdr + 48);
+    h->checkpoints = get_u64(hdr + 56);
+    if (h->stride == 0 || h->interval == 0 || h->interval > 4096 ||
+        h->checkpoints != (h->entries + h->interval - 1) / h->interval) {
+        return -1;
+    }
+    return 0;
+}
+
+// Byte offset of the indexed line at or before line (1-based); *skip gets
+// the number of lines still to step over from there
+static int line_index_find(int fd, const wc_index_header_t *h, uint64_t line,
+                           uint64_t *offset, uint64_t *skip) {
+    uint64_t entry = (line - 1) / h->stride;
+    if (line == 0 || entry >= h->entries) return -1;
+    uint64_t check = entry / h->interval;
+    
+    uint8_t cp[16];
+    off_t cp_pos = LINE_INDEX_HEADER + (off_t)check * 16;
+    if (pread(fd, cp, sizeof(cp), cp_pos) != (ssize_t)sizeof(cp)) return -1;
+    uint64_t pos = get_u64(cp);
+    uint64_t stream = get_u64(cp + 8);
+    
+    // At most interval - 1 varints of up to 10 bytes follow the checkpoint
+    uint64_t want = entry - check * h->interval;
+    uint8_t buf[4096 * 10];
+    off_t base = LINE_INDEX_HEADER + (off_t)h->checkpoints * 16;
+    ssize_t got = want ? pread(fd, buf, (size_t)(want * 10), base + (off_t)stream) : 0;
+    if (got < 0) return -1;
+    
+    size_t i = 0;
+    for (uint64_t e = 0; e < want; e++) {
+        uint64_t delta = 0;
+        int shift = 0;
+        do {
+            if (i >= (size_t)got || shift > 63) return -1;
+            delta |= (uint64_t)(buf[i] & 0x7f) << shift;
+            shift += 7;
+        } while (buf[i++] & 0x80);
+        pos += delta;
+    }
+    
+    *offset = pos;
+    *skip = (line - 1) - entry * h->stride;
+    return 0;
+}
+
+// --line=N: print line N of filename using the index written by --index
+static int line_lookup(const char *index_path, const char *filename, uint64_t line) {
+    int ifd = open(index_path, O_RDONLY);
+    if (ifd == -1) {
+        fprintf(stderr, "wc: %s: %s\n", index_path, strerror(errno));
+        return 1;
+    }
+    wc_index_header_t h;
+    if (line_index_read_header(ifd, &h) != 0) {
+        fprintf(stderr, "wc: %s: not a line index\n", index_path);
+        close(ifd);
+        return 1;
+    }
+    
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        fprintf(stderr, "wc: %s: %s\n", filename, strerror(errno));
+        if (fd != -1) close(fd);
+        close(ifd);
+        return 1;
+    }
+    if ((uint64_t)st.st_size != h.size || (h.mtime && (uint64_t)st.st_mtime != h.mtime)) {
+        fprintf(stderr, "wc: %s: index is stale for %s\n", index_path, filename);
+        close(fd);
+        close(ifd);
+        return 1;
+    }
+    if (line == 0 || line > h.lines) {
+        fprintf(stderr, "wc: %s: line %llu out of range (%llu lines)\n",
+                filename, (unsigned long long)line, (unsigned long long)h.lines);
+        close(fd);
+        close(ifd);
+        return 1;
+    }
+    
+    uint64_t offset, skip;
+    int rc = line_index_find(ifd, &h, line, &offset, &skip);
+    close(ifd);
+    if (rc != 0 || lseek(fd, (off_t)offset, SEEK_SET) == -1) {
+        fprintf(stderr, "wc: %s: corrupt line index\n", index_path);
+        close(fd);
+        return 1;
+    }
+    
+    // Step over at most stride - 1 lines, then copy the target line out
+    char buf[64 * 1024];
+    ssize_t n;
+    int done = 0, printed = 0;
+    while (!done && (n = read(fd, buf, sizeof(buf))) > 0) {
+        const char *p = buf, *end = buf + n;
+        while (skip && p < end) {
+            const char *nl = memchr(p, '\n', (size_t)(end - p));
+            if (!nl) { p = end; break; }
+            p = nl + 1;
+            skip--;
+        }
+        if (skip) continue;
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        if (nl) { end = nl + 1; done = 1; }
+        fwrite(p, 1, (size_t)(end - p), stdout);
+        printed |= end > p;
+    }
+    if (!done && printed) putchar('\n');
+    close(fd);
+    return 0;
+}
+
 // Optimized word counting with state machine
 static size_t count_words_optimized(const char *data, size_t size) {
     if (size == 0) return 0;
     
+#ifdef __ARM_FEATURE_SVE
+    return count_words_sve(data, size);
+#else
     size_t count = 0;
     int in_word = 0;
     
@@ -95,108 +595,292 @@ static size_t count_words_optimized(const char *data, size_t size) {
     }
     
     return count;
+#endif
 }
 
-// Fast character counting (just return size for ASCII)
-static size_t count_chars_ascii(const char *data, size_t size) {
-    return size;
+// Whitespace lookup for the profile kernel's branch-free word state
+static const unsigned char space_table[256] = {
+    ['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1, [' '] = 1,
+};
+
+// Full byte histogram and word count in one pass (--profile).
+// Four sub-histograms take consecutive bytes so that runs of the same
+// byte don't serialise on a store-to-load dependency through one counter.
+// The 32-bit bins are flushed to the size_t histogram every 1 GiB.
+static size_t profile_bytes(const char *data, size_t size, wc_profile_t *prof) {
+    static uint32_t h[4][256];
+    const unsigned char *p = (const unsigned char*)data;
+    size_t words = 0;
+    unsigned in_word = 0;
+    
+    while (size > 0) {
+        size_t n = size < ((size_t)1 << 30) ? size : ((size_t)1 << 30);
+        size_t i = 0;
+        memset(h, 0, sizeof(h));
+        
+        for (; i + 4 <= n; i += 4) {
+            unsigned c0 = p[i], c1 = p[i + 1], c2 = p[i + 2], c3 = p[i + 3];
+            h[0][c0]++;
+            h[1][c1]++;
+            h[2][c2]++;
+            h[3][c3]++;
+            
+            unsigned s0 = space_table[c0], s1 = space_table[c1];
+            unsigned s2 = space_table[c2], s3 = space_table[c3];
+            words += (!in_word & !s0) + (s0 & !s1) + (s1 & !s2) + (s2 & !s3);
+            in_word = !s3;
+        }
+        for (; i < n; i++) {
+            unsigned c = p[i], sp = space_table[c];
+            h[0][c]++;
+            words += !in_word & !sp;
+            in_word = !sp;
+        }
+        
+        for (int b = 0; b < 256; b++) {
+            prof->histogram[b] += (size_t)h[0][b] + h[1][b] + h[2][b] + h[3][b];
+        }
+        p += n;
+        size -= n;
+    }
+    
+    prof->nul = prof->histogram[0];
+    prof->cr = prof->histogram['\r'];
+    prof->lf = prof->histogram['\n'];
+    prof->tab = prof->histogram['\t'];
+    prof->high = 0;
+    for (int b = 0x80; b < 256; b++) prof->high += prof->histogram[b];
+    return words;
 }
 
-// Main counting function
-static wc_counts_t count_data(const char *data, size_t size, const wc_options_t *opts) {
-    wc_counts_t counts = {0};
+// Class counts only (--profile=classes): NUL, CR, LF, TAB and high-bit
+// bytes, counted with NEON compares into per-lane byte accumulators that
+// are widened before they can wrap
+static void profile_classes_simd(const char *data, size_t size, wc_profile_t *prof) {
+    const unsigned char *p = (const unsigned char*)data;
+    size_t i = 0;
+    
+#ifdef __ARM_NEON
+    const uint8x16_t cr_vec = vdupq_n_u8('\r');
+    const uint8x16_t lf_vec = vdupq_n_u8('\n');
+    const uint8x16_t tab_vec = vdupq_n_u8('\t');
+    
+    while (i + 16 <= size) {
+        uint8x16_t nul = vdupq_n_u8(0), cr = nul, lf = nul, tab = nul, high = nul;
+        size_t blocks = (size - i) / 16;
+        if (blocks > 255) blocks = 255;
+        
+        for (size_t b = 0; b < blocks; b++, i += 16) {
+            uint8x16_t v = vld1q_u8(p + i);
+            // Compare results are 0xFF (-1) per match, so subtracting adds 1
+            nul = vsubq_u8(nul, vceqzq_u8(v));
+            cr = vsubq_u8(cr, vceqq_u8(v, cr_vec));
+            lf = vsubq_u8(lf, vceqq_u8(v, lf_vec));
+            tab = vsubq_u8(tab, vceqq_u8(v, tab_vec));
+            high = vaddq_u8(high, vshrq_n_u8(v, 7));
+        }
+        
+        prof->nul += vaddlvq_u8(nul);
+        prof->cr += vaddlvq_u8(cr);
+        prof->lf += vaddlvq_u8(lf);
+        prof->tab += vaddlvq_u8(tab);
+        prof->high += vaddlvq_u8(high);
+    }
+#endif
+    
+    // Locals rather than prof-> fields so the compiler can vectorise this
+    size_t nul = 0, cr = 0, lf = 0, tab = 0, high = 0;
+    for (; i < size; i++) {
+        unsigned c = p[i];
+        nul += c == 0;
+        cr += c == '\r';
+        lf += c == '\n';
+        tab += c == '\t';
+        high += c >> 7;
+    }
+    prof->nul += nul;
+    prof->cr += cr;
+    prof->lf += lf;
+    prof->tab += tab;
+    prof->high += high;
+}
+
+static void profile_merge(wc_profile_t *dst, const wc_profile_t *src) {
+    dst->nul += src->nul;
+    dst->cr += src->cr;
+    dst->lf += src->lf;
+    dst->tab += src->tab;
+    dst->high += src->high;
+    for (int b = 0; b < 256; b++) dst->histogram[b] += src->histogram[b];
+}
+
+// UTF-8 character counting: every byte except continuation bytes (10xxxxxx)
+static size_t count_chars_utf8(const char *data, size_t size) {
+#if defined(__ARM_FEATURE_SVE)
+    return count_chars_sve(data, size);
+#else
+    size_t count = 0;
+    size_t i = 0;
+#ifdef __ARM_NEON
+    const int8x16_t cont_limit = vdupq_n_s8(-64);
+    while (i + 16 <= size) {
+        // 0xFF lanes subtract as -1; widen before a lane can wrap
+        uint8x16_t acc = vdupq_n_u8(0);
+        for (int k = 0; k < 255 && i + 16 <= size; k++, i += 16) {
+            int8x16_t v = vld1q_s8((const int8_t *)data + i);
+            acc = vsubq_u8(acc, vcgeq_s8(v, cont_limit));
+        }
+        count += vaddlvq_u8(acc);
+    }
+#endif
+    for (; i < size; i++) {
+        count += ((unsigned char)data[i] & 0xC0) != 0x80;
+    }
+    return count;
+#endif
+}
+
+// Main counting function, over one buffer of a longer input. Counts add
+// into *counts; *in_word says whether the previous buffer ended inside a
+// word, and the line in progress (-L, --line-histogram) and the index
+// carry over too. `last` closes the input.
+static void count_data_chunk(const char *data, size_t size, const wc_options_t *opts,
+                             wc_counts_t *counts, int *in_word, int last) {
+    // Every word kernel starts outside a word: a word running across the
+    // seam was counted again at this buffer's first byte
+    int seam_word = *in_word && size > 0 && !space_table[(unsigned char)data[0]];
+    if (size > 0) *in_word = !space_table[(unsigned char)data[size - 1]];
     
     if (opts->count_bytes) {
-        counts.bytes = size;
+        counts->bytes += size;
     }
     
     if (opts->count_chars) {
-        counts.chars = count_chars_ascii(data, size);
+        counts->chars += count_chars_utf8(data, size);
     }
     
-    if (opts->count_lines) {
-        counts.lines = count_lines_simd(data, size);
+    size_t newlines = 0;
+    int have_newlines = 0;
+    if (opts->index) {
+        newlines = line_index_scan(data, size, opts->index);
+        have_newlines = 1;
     }
     
-    if (opts->count_words) {
-        counts.words = count_words_optimized(data, size);
+    if (opts->max_line_length || opts->line_histogram) {
+        // The offset scan already finds every newline
+        size_t n = line_stats_simd(data, size, &counts->line_stats);
+        if (!have_newlines) newlines = n;
+        have_newlines = 1;
+        if (last) line_stats_finish(&counts->line_stats);
+        counts->max_line_length = counts->line_stats.max;
+    } else if (opts->count_lines && !opts->index && opts->profile != PROFILE_FULL) {
+        newlines = count_lines_simd(data, size);
+        have_newlines = 1;
     }
+    if (opts->count_lines && have_newlines) counts->lines += newlines;
     
-    return counts;
+    if (opts->profile == PROFILE_FULL) {
+        // Words and the newline count come out of the histogram pass
+        size_t words = profile_bytes(data, size, &counts->profile);
+        if (opts->count_words) counts->words += words - seam_word;
+        if (opts->count_lines && !have_newlines) counts->lines = counts->profile.lf;
+        return;
+    }
+    
+    if (opts->profile == PROFILE_CLASSES) {
+        profile_classes_simd(data, size, &counts->profile);
+    }
+    
+    if (opts->count_words) {
+        counts->words += count_words_optimized(data, size) - seam_word;
+    }
 }
 
-// Process file using memory mapping for large files
-static wc_counts_t process_file(const char *filename, const wc_options_t *opts) {
+// Count a whole input held in one buffer
+static wc_counts_t count_data(const char *data, size_t size, const wc_options_t *opts) {
     wc_counts_t counts = {0};
+    int in_word = 0;
+    count_data_chunk(data, size, opts, &counts, &in_word, 1);
+    return counts;
+}
+
+// Process file using memory mapping for large files; -1 if it could not
+// be read in full
+static int process_file(const char *filename, const wc_options_t *opts, wc_counts_t *counts) {
+    memset(counts, 0, sizeof(*counts));
     
     int fd = (filename && strcmp(filename, "-") != 0) ? 
              open(filename, O_RDONLY) : STDIN_FILENO;
     
     if (fd == -1) {
         fprintf(stderr, "wc: %s: %s\n", filename ? filename : "stdin", strerror(errno));
-        return counts;
+        return -1;
     }
     
     struct stat st;
     if (fstat(fd, &st) == -1) {
         fprintf(stderr, "wc: %s: %s\n", filename ? filename : "stdin", strerror(errno));
         if (fd != STDIN_FILENO) close(fd);
-        return counts;
+        return -1;
     }
+    int rc = 0;
     
     // Use mmap for regular files larger than 4KB
     if (S_ISREG(st.st_mode) && st.st_size > 4096) {
         void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
         if (data != MAP_FAILED) {
-            counts = count_data((const char*)data, st.st_size, opts);
+            *counts = count_data((const char*)data, st.st_size, opts);
             munmap(data, st.st_size);
         } else {
             fprintf(stderr, "wc: %s: mmap failed: %s\n", filename ? filename : "stdin", strerror(errno));
+            rc = -1;
         }
     } else {
-        // Read in chunks for stdin or small files
-        const size_t BUFFER_SIZE = 64 * 1024;
+        // Stdin and small files are counted a fixed-size buffer at a time,
+        // so memory stays flat however much arrives on a pipe
+        const size_t BUFFER_SIZE = 256 * 1024;
         char *buffer = malloc(BUFFER_SIZE);
         if (!buffer) {
             fprintf(stderr, "wc: memory allocation failed\n");
             if (fd != STDIN_FILENO) close(fd);
-            return counts;
+            return -1;
         }
         
-        size_t total_size = 0;
-        char *all_data = NULL;
-        
+        int in_word = 0;
         ssize_t bytes_read;
-        while ((bytes_read = read(fd, buffer, BUFFER_SIZE)) > 0) {
-            all_data = realloc(all_data, total_size + bytes_read);
-            if (!all_data) {
-                fprintf(stderr, "wc: memory allocation failed\n");
-                free(buffer);
-                if (fd != STDIN_FILENO) close(fd);
-                return counts;
-            }
-            memcpy(all_data + total_size, buffer, bytes_read);
-            total_size += bytes_read;
+        for (;;) {
+            bytes_read = read(fd, buffer, BUFFER_SIZE);
+            if (bytes_read < 0 && errno == EINTR) continue;
+            if (bytes_read <= 0) break;
+            count_data_chunk(buffer, (size_t)bytes_read, opts, counts, &in_word, 0);
         }
-        
-        if (all_data) {
-            counts = count_data(all_data, total_size, opts);
-            free(all_data);
+        if (bytes_read < 0) {
+            fprintf(stderr, "wc: %s: %s\n", filename ? filename : "stdin", strerror(errno));
+            rc = -1;
         }
-        
+        count_data_chunk(buffer, 0, opts, counts, &in_word, 1);
         free(buffer);
     }
     
+    // Lets --line tell a stale index from a current one
+    if (opts->index && S_ISREG(st.st_mode)) opts->index->hdr.mtime = (uint64_t)st.st_mtime;
+    
     if (fd != STDIN_FILENO) close(fd);
-    return counts;
+    return rc;
 }
 
 // Print results
 static void print_counts(const wc_counts_t *counts, const wc_options_t *opts, const char *filename) {
+    if (!opts->count_lines && !opts->count_words && !opts->count_chars &&
+        !opts->count_bytes && !opts->max_line_length) {
+        return;  // --line-histogram on its own
+    }
+    
     if (opts->count_lines) printf("%8zu ", counts->lines);
     if (opts->count_words) printf("%8zu ", counts->words);
     if (opts->count_chars) printf("%8zu ", counts->chars);
     if (opts->count_bytes && !opts->count_chars) printf("%8zu ", counts->bytes);
+    if (opts->max_line_length) printf("%8zu ", counts->max_line_length);
     
     if (filename && strcmp(filename, "-") != 0) {
         printf("%s", filename);
@@ -204,6 +888,59 @@ static void print_counts(const wc_counts_t *counts, const wc_options_t *opts, co
     printf("\n");
 }
 
+// Print the line-length histogram as text or as one JSON object per file
+static void print_line_histogram(const wc_line_stats_t *st, const wc_options_t *opts, const char *filename) {
+    const char *name = (filename && strcmp(filename, "-") != 0) ? filename : "-";
+    double mean = st->lines ? (double)st->total_length / st->lines : 0.0;
+    size_t min = st->lines ? st->min : 0;
+    
+    if (opts->line_histogram == HIST_JSON) {
+        printf("{\"file\":\"");
+        for (const char *p = name; *p; p++) {
+            if (*p == '"' || *p == '\\') putchar('\\');
+            putchar(*p);
+        }
+        printf("\",\"lines\":%zu,\"min\":%zu,\"max\":%zu,\"mean\":%.2f,\"buckets\":[",
+               st->lines, min, st->max, mean);
+        int first = 1;
+        for (int b = 0; b < LINE_HIST_BUCKETS; b++) {
+            if (!st->buckets[b]) continue;
+            size_t lo = b ? (size_t)1 << (b - 1) : 0;
+            size_t hi = b ? ((size_t)1 << b) - 1 : 0;
+            printf("%s{\"min\":%zu,\"max\":%zu,\"count\":%zu}", first ? "" : ",", lo, hi, st->buckets[b]);
+            first = 0;
+        }
+        printf("]}\n");
+        return;
+    }
+    
+    printf("%s: %zu lines, length min %zu, max %zu, mean %.2f\n", name, st->lines, min, st->max, mean);
+    for (int b = 0; b < LINE_HIST_BUCKETS; b++) {
+        if (!st->buckets[b]) continue;
+        size_t lo = b ? (size_t)1 << (b - 1) : 0;
+        size_t hi = b ? ((size_t)1 << b) - 1 : 0;
+        printf("  %10zu - %-10zu %12zu\n", lo, hi, st->buckets[b]);
+    }
+}
+
+// Print the byte profile: class counts, then every non-empty bin
+static void print_profile(const wc_profile_t *prof, const wc_options_t *opts, const char *filename) {
+    const char *name = (filename && strcmp(filename, "-") != 0) ? filename : "-";
+    
+    printf("%s: NUL %zu, CR %zu, LF %zu, TAB %zu, high-bit %zu\n",
+           name, prof->nul, prof->cr, prof->lf, prof->tab, prof->high);
+    if (opts->profile != PROFILE_FULL) return;
+    
+    for (int b = 0; b < 256; b++) {
+        if (!prof->histogram[b]) continue;
+        if (b >= 0x21 && b < 0x7f) {
+            printf("  0x%02x '%c' %12zu\n", b, b, prof->histogram[b]);
+        } else {
+            printf("  0x%02x     %12zu\n", b, prof->histogram[b]);
+        }
+    }
+}
+
 // Usage information
 static void usage(void) {
     printf("Usage: wc [OPTION]... [FILE]...\n");
@@ -211,15 +948,59 @@ static void usage(void) {
     printf("  -c, --bytes            print the byte counts\n");
     printf("  -m, --chars            print the character counts\n");
     printf("  -l, --lines            print the newline counts\n");
-    printf("  -L, --max-line-length  print the maximum display width\n");
+    printf("  -L, --max-line-length  print the length of the longest line in bytes\n");
     printf("  -w, --words            print the word counts\n");
+    printf("      --line-histogram[=text|json]\n");
+    printf("                         print min/max/mean line length and a log2\n");
+    printf("                         histogram of line lengths\n");
+    printf("      --profile[=full|classes]\n");
+    printf("                         print NUL/CR/LF/TAB/high-bit counts and, in\n");
+    printf("                         full mode (default), the 256-bin byte histogram\n");
+    printf("      --index=IDX        write a line-offset index of the single FILE to IDX\n");
+    printf("      --index-stride=K   index every K-th line (default %d)\n", LINE_INDEX_DEFAULT_STRIDE);
+    printf("      --line=N           print line N of FILE using the index given by --index\n");
     printf("      --help             display this help and exit\n");
     printf("      --version          output version information and exit\n");
 }
 
+#ifdef UNIT_TESTS
+void run_unit_tests(void);
+#endif
+#ifdef INTEGRATION_TESTS
+void test_integration(void);
+#endif
+#ifdef PERFORMANCE_TESTS
+void performance_test(void);
+#endif
+#ifdef STRESS_TESTS
+void stress_test(void);
+#endif
+
 int main(int argc, char *argv[]) {
     wc_options_t opts = {0};
     int opt;
+    const char *index_path = NULL;
+    uint64_t index_stride = LINE_INDEX_DEFAULT_STRIDE;
+    uint64_t line_number = 0;
+    char *endp;
+    
+    // Test builds (see Makefile) run their suite instead of counting
+#ifdef UNIT_TESTS
+    run_unit_tests();
+    return 0;
+#endif
+#ifdef INTEGRATION_TESTS
+    test_integration();
+    return 0;
+#endif
+#ifdef PERFORMANCE_TESTS
+    performance_test();
+    return 0;
+#endif
+#ifdef STRESS_TESTS
+    stress_test();
+    return 0;
+#endif
     
     static struct option long_options[] = {
         {"bytes", no_argument, 0, 'c'},
@@ -227,6 +1008,11 @@ int main(int argc, char *argv[]) {
         {"lines", no_argument, 0, 'l'},
         {"max-line-length", no_argument, 0, 'L'},
         {"words", no_argument, 0, 'w'},
+        {"line-histogram", optional_argument, 0, 'H'},
+        {"profile", optional_argument, 0, 'P'},
+        {"index", required_argument, 0, 'I'},
+        {"index-stride", required_argument, 0, 'K'},
+        {"line", required_argument, 0, 'N'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0}
@@ -239,45 +1025,119 @@ int main(int argc, char *argv[]) {
             case 'l': opts.count_lines = 1; break;
             case 'L': opts.max_line_length = 1; break;
             case 'w': opts.count_words = 1; break;
+            case 'H':
+                if (!optarg || strcmp(optarg, "text") == 0) {
+                    opts.line_histogram = HIST_TEXT;
+                } else if (strcmp(optarg, "json") == 0) {
+                    opts.line_histogram = HIST_JSON;
+                } else {
+                    fprintf(stderr, "wc: invalid --line-histogram format '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'P':
+                if (!optarg || strcmp(optarg, "full") == 0) {
+                    opts.profile = PROFILE_FULL;
+                } else if (strcmp(optarg, "classes") == 0) {
+                    opts.profile = PROFILE_CLASSES;
+                } else {
+                    fprintf(stderr, "wc: invalid --profile mode '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'I': index_path = optarg; break;
+            case 'K':
+                index_stride = strtoull(optarg, &endp, 10);
+                if (*endp || index_stride == 0) {
+                    fprintf(stderr, "wc: invalid --index-stride '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'N':
+                line_number = strtoull(optarg, &endp, 10);
+                if (*endp || line_number == 0) {
+                    fprintf(stderr, "wc: invalid line number '%s'\n", optarg);
+                    return 1;
+                }
+                break;
             case 'h': usage(); return 0;
             case 'v': printf("wc (efficient) 1.0\n"); return 0;
             default: usage(); return 1;
         }
     }
     
+    // The index covers exactly one input; --line reads it back instead
+    if ((index_path || line_number) && argc - optind > 1) {
+        fprintf(stderr, "wc: --index and --line take a single FILE\n");
+        return 1;
+    }
+    if (line_number) {
+        if (!index_path || optind >= argc) {
+            fprintf(stderr, "wc: --line needs --index=IDX and a FILE\n");
+            return 1;
+        }
+        return line_lookup(index_path, argv[optind], line_number);
+    }
+    wc_line_index_t line_index;
+    if (index_path) {
+        line_index_init(&line_index, index_stride);
+        opts.index = &line_index;
+    }
+    
     // Default behavior: count lines, words, and bytes
     if (!opts.count_lines && !opts.count_words && !opts.count_chars && 
-        !opts.count_bytes && !opts.max_line_length) {
+        !opts.count_bytes && !opts.max_line_length && !opts.line_histogram &&
+        !opts.profile) {
         opts.count_lines = opts.count_words = opts.count_bytes = 1;
     }
     
     wc_counts_t total_counts = {0};
     int file_count = 0;
+    int status = 0;
     
     if (optind >= argc) {
         // No files specified, read from stdin
-        wc_counts_t counts = process_file("-", &opts);
+        wc_counts_t counts;
+        if (process_file("-", &opts, &counts) != 0) status = 1;
         print_counts(&counts, &opts, NULL);
+        if (opts.line_histogram) print_line_histogram(&counts.line_stats, &opts, NULL);
+        if (opts.profile) print_profile(&counts.profile, &opts, NULL);
     } else {
         // Process each file
         for (int i = optind; i < argc; i++) {
-            wc_counts_t counts = process_file(argv[i], &opts);
+            wc_counts_t counts;
+            if (process_file(argv[i], &opts, &counts) != 0) status = 1;
             print_counts(&counts, &opts, argv[i]);
+            if (opts.line_histogram) print_line_histogram(&counts.line_stats, &opts, argv[i]);
+            if (opts.profile) print_profile(&counts.profile, &opts, argv[i]);
             
             total_counts.lines += counts.lines;
             total_counts.words += counts.words;
             total_counts.chars += counts.chars;
             total_counts.bytes += counts.bytes;
+            if (counts.max_line_length > total_counts.max_line_length) {
+                total_counts.max_line_length = counts.max_line_length;
+            }
+            line_stats_merge(&total_counts.line_stats, &counts.line_stats);
+            profile_merge(&total_counts.profile, &counts.profile);
             file_count++;
         }
         
         // Print total if multiple files
         if (file_count > 1) {
             print_counts(&total_counts, &opts, "total");
+            if (opts.line_histogram) print_line_histogram(&total_counts.line_stats, &opts, "total");
+            if (opts.profile) print_profile(&total_counts.profile, &opts, "total");
         }
     }
     
-    return 0;
+    // An index of input that was not read in full would send --line astray
+    if (opts.index) {
+        if (status == 0 && line_index_write(opts.index, index_path) != 0) status = 1;
+        line_index_free(opts.index);
+    }
+    
+    return status;
 }
 
 // ============================================================================
@@ -287,7 +1147,7 @@ int main(int argc, char *argv[]) {
 #ifdef UNIT_TESTS
 #include <assert.h>
 
-void test_count_lines_simd() {
+void test_count_lines_simd(void) {
     printf("Testing count_lines_simd...\n");
     
     // Test empty string
@@ -312,13 +1172,13 @@ void test_count_lines_simd() {
     for (int i = 10; i < 99; i += 10) {
         large[i] = '\n';
     }
-    size_t expected_lines = 8; // newlines at positions 10,20,30,40,50,60,70,80
+    size_t expected_lines = 9; // newlines at positions 10,20,30,40,50,60,70,80,90
     assert(count_lines_simd(large, 99) == expected_lines);
     
     printf("✓ count_lines_simd tests passed\n");
 }
 
-void test_count_words_optimized() {
+void test_count_words_optimized(void) {
     printf("Testing count_words_optimized...\n");
     
     // Test empty string
@@ -342,25 +1202,67 @@ void test_count_words_optimized() {
     printf("✓ count_words_optimized tests passed\n");
 }
 
-void test_count_chars_ascii() {
-    printf("Testing count_chars_ascii...\n");
+void test_count_chars_utf8(void) {
+    printf("Testing count_chars_utf8...\n");
     
     // Test empty string
-    assert(count_chars_ascii("", 0) == 0);
+    assert(count_chars_utf8("", 0) == 0);
     
     // Test regular string
-    assert(count_chars_ascii("hello", 5) == 5);
+    assert(count_chars_utf8("hello", 5) == 5);
     
     // Test string with special characters
-    assert(count_chars_ascii("hello\n\tworld", 12) == 12);
+    assert(count_chars_utf8("hello\n\tworld", 12) == 12);
+    
+    // Test multi-byte sequences: é (2 bytes), € (3 bytes), 😀 (4 bytes)
+    assert(count_chars_utf8("caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", 14) == 8);
+    
+    printf("✓ count_chars_utf8 tests passed\n");
+}
+
+// Compare the vector kernels with plain byte loops at every length and alignment
+// around the vector widths, plus spans long enough to hit the 255-block widening
+void test_simd_kernels(void) {
+    printf("Testing SIMD kernels against scalar reference...\n");
+    
+    static char buf[70000];
+    const char alphabet[] = "ab \t\n\r\v\f\xc3\xa9\xe2\x82\xac";
+    srand(7);
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    }
     
-    printf("✓ count_chars_ascii tests passed\n");
+    size_t lens[] = {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 255, 256, 257,
+                     4095, 4096, 4097, 16 * 255 + 1, 256 * 255 + 3, 69990};
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        for (size_t off = 0; off < 8; off++) {
+            const char *d = buf + off;
+            size_t n = lens[l];
+            size_t lines = 0, words = 0, chars = 0;
+            int in_word = 0;
+            for (size_t i = 0; i < n; i++) {
+                unsigned char c = (unsigned char)d[i];
+                lines += c == '\n';
+                chars += (c & 0xC0) != 0x80;
+                words += !space_table[c] && !in_word;
+                in_word = !space_table[c];
+            }
+            assert(count_lines_simd(d, n) == lines);
+            assert(count_words_optimized(d, n) == words);
+            assert(count_chars_utf8(d, n) == chars);
+#if defined(__ARM_FEATURE_SVE) && defined(__ARM_NEON)
+            assert(count_lines_neon(d, n) == lines);
+#endif
+        }
+    }
+    
+    printf("✓ SIMD kernel tests passed\n");
 }
 
-void test_count_data() {
+void test_count_data(void) {
     printf("Testing count_data...\n");
     
-    wc_options_t opts = {1, 1, 1, 1, 0}; // Count all
+    wc_options_t opts = {.count_lines = 1, .count_words = 1, .count_chars = 1, .count_bytes = 1}; // Count all
     
     // Test empty data
     wc_counts_t counts = count_data("", 0, &opts);
@@ -377,14 +1279,187 @@ void test_count_data() {
     assert(counts.chars == strlen(test_str));
     assert(counts.bytes == strlen(test_str));
     
+    // Counted a buffer at a time, as stdin is, every option gives the
+    // same counts as one pass over the whole input
+    size_t size = 100000;
+    char *data = malloc(size);
+    srand(47);
+    for (size_t i = 0; i < size; i++) data[i] = "ab \n\t\xc3\xa9x"[rand() % 8];
+    const wc_options_t all[] = {
+        {.count_lines = 1, .count_words = 1, .count_chars = 1, .count_bytes = 1},
+        {.count_lines = 1, .count_words = 1, .max_line_length = 1, .line_histogram = HIST_TEXT},
+        {.count_lines = 1, .count_words = 1, .profile = PROFILE_FULL},
+        {.count_lines = 1, .count_words = 1, .profile = PROFILE_CLASSES},
+    };
+    size_t steps[] = {1, 7, 4096, 65537};
+    for (size_t o = 0; o < sizeof(all) / sizeof(all[0]); o++) {
+        wc_counts_t whole = count_data(data, size, &all[o]);
+        for (size_t k = 0; k < sizeof(steps) / sizeof(steps[0]); k++) {
+            wc_counts_t parts = {0};
+            int in_word = 0;
+            for (size_t off = 0; off < size; off += steps[k]) {
+                size_t n = size - off < steps[k] ? size - off : steps[k];
+                count_data_chunk(data + off, n, &all[o], &parts, &in_word, 0);
+            }
+            count_data_chunk(data, 0, &all[o], &parts, &in_word, 1);
+            assert(memcmp(&parts, &whole, sizeof(whole)) == 0);
+        }
+    }
+    free(data);
+    
     printf("✓ count_data tests passed\n");
 }
 
-void run_unit_tests() {
+void test_line_stats_simd(void) {
+    printf("Testing line_stats_simd...\n");
+    
+    wc_line_stats_t st;
+    
+    // Empty input has no lines
+    memset(&st, 0, sizeof(st));
+    assert(line_stats_simd("", 0, &st) == 0);
+    line_stats_finish(&st);
+    assert(st.lines == 0 && st.max == 0);
+    
+    // Lengths 0, 1, 3 and an unterminated line of 2
+    memset(&st, 0, sizeof(st));
+    assert(line_stats_simd("\na\nabc\nxy", 9, &st) == 3);
+    line_stats_finish(&st);
+    assert(st.lines == 4 && st.min == 0 && st.max == 3 && st.total_length == 6);
+    assert(st.buckets[0] == 1 && st.buckets[1] == 1 && st.buckets[2] == 2);
+    
+    // Lines spanning the 16-byte SIMD blocks and two separate buffers
+    char big[100];
+    memset(big, 'x', sizeof(big));
+    big[40] = '\n';
+    big[99] = '\n';
+    memset(&st, 0, sizeof(st));
+    assert(line_stats_simd(big, 70, &st) == 1);
+    assert(line_stats_simd(big + 70, 30, &st) == 1);
+    line_stats_finish(&st);
+    assert(st.lines == 2 && st.min == 40 && st.max == 58);
+    assert(st.buckets[6] == 2);
+    
+    // count_data takes the newline count from the same scan
+    wc_options_t opts = {.count_lines = 1, .max_line_length = 1, .line_histogram = HIST_TEXT};
+    wc_counts_t counts = count_data(big, sizeof(big), &opts);
+    assert(counts.lines == 2 && counts.max_line_length == 58);
+    
+    printf("✓ line_stats_simd tests passed\n");
+}
+
+void test_profile(void) {
+    printf("Testing profile_bytes / profile_classes_simd...\n");
+    
+    // Embedded NULs are word characters, as in the test_binary.txt fixture
+    const char bin[] = "hello\0world\ntest\0\0line\n\r\x80\xff";
+    size_t len = sizeof(bin) - 1;
+    wc_profile_t full, classes;
+    memset(&full, 0, sizeof(full));
+    memset(&classes, 0, sizeof(classes));
+    
+    assert(profile_bytes(bin, len, &full) == 3);
+    assert(full.nul == 3 && full.lf == 2 && full.cr == 1 && full.high == 2 && full.tab == 0);
+    assert(full.histogram['l'] == 4 && full.histogram[0xff] == 1);
+    
+    profile_classes_simd(bin, len, &classes);
+    assert(classes.nul == full.nul && classes.cr == full.cr && classes.lf == full.lf);
+    assert(classes.high == full.high && classes.tab == full.tab);
+    
+    // More than 255 SIMD blocks of matches must not wrap the byte lanes
+    size_t big_len = 16 * 1000 + 7;
+    char *big = malloc(big_len);
+    memset(big, '\r', big_len);
+    memset(&classes, 0, sizeof(classes));
+    profile_classes_simd(big, big_len, &classes);
+    assert(classes.cr == big_len);
+    
+    memset(&full, 0, sizeof(full));
+    assert(profile_bytes(big, big_len, &full) == 0);
+    assert(full.cr == big_len);
+    free(big);
+    
+    // count_data takes lines and words from the histogram pass
+    wc_options_t opts = {.count_lines = 1, .count_words = 1, .count_bytes = 1, .profile = PROFILE_FULL};
+    wc_counts_t counts = count_data(bin, len, &opts);
+    assert(counts.lines == 2 && counts.words == 3 && counts.bytes == len);
+    
+    printf("✓ profile tests passed\n");
+}
+
+void test_line_index(void) {
+    printf("Testing line_index_scan / line_index_find...\n");
+    
+    // Random line lengths, long enough for many scan blocks and checkpoints
+    size_t size = 200000;
+    char *data = malloc(size);
+    size_t *starts = malloc((size + 1) * sizeof(*starts));
+    size_t lines = 0;
+    srand(11);
+    starts[lines++] = 0;
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (rand() % 9 == 0 || (i > 60000 && i < 61000)) ? '\n' : 'x';
+        if (data[i] == '\n' && i + 1 < size) starts[lines++] = i + 1;
+    }
+    
+    const char *path = "test_line_index.idx";
+    uint64_t strides[] = {1, 3, 64, 1000};
+    for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        wc_line_index_t idx;
+        line_index_init(&idx, strides[s]);
+        wc_options_t opts = {.count_lines = 1, .index = &idx};
+        // Odd strides are indexed a buffer at a time, as stdin is
+        wc_counts_t counts = {0};
+        int in_word = 0;
+        size_t step = s % 2 ? 7777 : size;
+        for (size_t off = 0; off < size; off += step) {
+            size_t n = size - off < step ? size - off : step;
+            count_data_chunk(data + off, n, &opts, &counts, &in_word, 0);
+        }
+        count_data_chunk(data, 0, &opts, &counts, &in_word, 1);
+        assert(counts.lines == count_lines_simd(data, size));
+        assert(idx.hdr.lines == lines);
+        assert(line_index_write(&idx, path) == 0);
+        line_index_free(&idx);
+        
+        int fd = open(path, O_RDONLY);
+        wc_index_header_t h;
+        assert(fd != -1 && line_index_read_header(fd, &h) == 0);
+        assert(h.stride == strides[s] && h.lines == lines && h.size == size);
+        for (size_t n = 1; n <= lines; n++) {
+            uint64_t offset, skip;
+            assert(line_index_find(fd, &h, n, &offset, &skip) == 0);
+            assert(skip < strides[s]);
+            while (skip--) offset = (const char *)memchr(data + offset, '\n', size - offset) - data + 1;
+            assert(offset == starts[n - 1]);
+        }
+        uint64_t offset, skip;
+        assert(line_index_find(fd, &h, 0, &offset, &skip) != 0);
+        close(fd);
+    }
+    unlink(path);
+    
+    // An empty input still gives a valid index with no lines
+    wc_line_index_t idx;
+    line_index_init(&idx, 4);
+    line_index_scan("", 0, &idx);
+    assert(idx.hdr.lines == 0 && idx.hdr.entries == 1);
+    line_index_free(&idx);
+    
+    free(starts);
+    free(data);
+    printf("✓ line index tests passed\n");
+}
+
+void run_unit_tests(void) {
     printf("Running unit tests...\n");
     test_count_lines_simd();
+    test_line_stats_simd();
+    test_profile();
+    test_line_index();
     test_count_words_optimized();
-    test_count_chars_ascii();
+    test_count_chars_utf8();
+    test_simd_kernels();
     test_count_data();
     printf("All unit tests passed!\n\n");
 }
@@ -405,7 +1480,7 @@ void create_test_file(const char *filename, const char *content) {
     }
 }
 
-void test_integration() {
+void test_integration(void) {
     printf("Running integration tests...\n");
     
     // Test 1: Empty file
@@ -434,6 +1509,22 @@ void test_integration() {
     }
     system("./wc test_large.txt > test_output.txt");
     
+    // Test 5b: Line index round trip on the large file
+    system("./wc -l --index=test_large.idx --index-stride=100 test_large.txt > test_output.txt");
+    system("./wc --line=4321 --index=test_large.idx test_large.txt > test_output.txt");
+    FILE *line_out = fopen("test_output.txt", "r");
+    char line_buf[128] = "";
+    if (line_out) {
+        if (!fgets(line_buf, sizeof(line_buf), line_out)) line_buf[0] = '\0';
+        fclose(line_out);
+    }
+    assert(strcmp(line_buf, "This is line 4320 with some words\n") == 0);
+    system("rm -f test_large.idx");
+    
+    // Test 5c: no index is written for input that could not be read
+    assert(system("./wc --index=test_missing.idx test_missing.txt > /dev/null 2>&1") != 0);
+    assert(access("test_missing.idx", F_OK) != 0);
+    
     // Test 6: Binary-like content
     create_test_file("test_binary.txt", "hello\0world\ntest\0\0line\n");
     system("./wc test_binary.txt > test_output.txt");
@@ -454,7 +1545,7 @@ double get_time_diff(struct timespec start, struct timespec end) {
     return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
 }
 
-void performance_test() {
+void performance_test(void) {
     printf("Running performance tests...\n");
     
     // Generate large test data
@@ -482,7 +1573,7 @@ void performance_test() {
     }
     test_data[test_size - 1] = '\0';
     
-    wc_options_t opts = {1, 1, 1, 1, 0};
+    wc_options_t opts = {.count_lines = 1, .count_words = 1, .count_chars = 1, .count_bytes = 1};
     struct timespec start, end;
     const int iterations = 100;
     
@@ -495,6 +1586,68 @@ void performance_test() {
     clock_gettime(CLOCK_MONOTONIC, &end);
     double simd_time = get_time_diff(start, end);
     
+#if defined(__ARM_FEATURE_SVE) && defined(__ARM_NEON)
+    // The 128-bit NEON kernel, for comparison with the SVE one above
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        volatile size_t lines = count_lines_neon(test_data, test_size);
+        (void)lines;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double neon_time = get_time_diff(start, end);
+#endif
+    
+    // Test UTF-8 character counting (-m)
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        volatile size_t chars = count_chars_utf8(test_data, test_size);
+        (void)chars;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double chars_time = get_time_diff(start, end);
+    
+    // Test line-length scan (-L / --line-histogram) against plain -l
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        wc_line_stats_t st = {0};
+        volatile size_t lines = line_stats_simd(test_data, test_size, &st);
+        (void)lines;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double hist_time = get_time_diff(start, end);
+    
+    // Test line index build (--index) against plain -l
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        wc_line_index_t idx;
+        line_index_init(&idx, LINE_INDEX_DEFAULT_STRIDE);
+        volatile size_t lines = line_index_scan(test_data, test_size, &idx);
+        (void)lines;
+        line_index_free(&idx);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double index_time = get_time_diff(start, end);
+    
+    // Test byte profile: full histogram and the SIMD class counts
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        wc_profile_t prof = {0};
+        volatile size_t words = profile_bytes(test_data, test_size, &prof);
+        (void)words;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double profile_time = get_time_diff(start, end);
+    
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++) {
+        wc_profile_t prof = {0};
+        profile_classes_simd(test_data, test_size, &prof);
+        volatile size_t high = prof.high;
+        (void)high;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double classes_time = get_time_diff(start, end);
+    
     // Test word counting
     clock_gettime(CLOCK_MONOTONIC, &start);
     for (int i = 0; i < iterations; i++) {
@@ -516,6 +1669,20 @@ void performance_test() {
     printf("Performance results (%d iterations on %.1fMB):\n", iterations, test_size / 1024.0 / 1024.0);
     printf("  SIMD line counting: %.3f seconds (%.1f MB/s)\n", 
            simd_time, (test_size * iterations) / (simd_time * 1024 * 1024));
+#if defined(__ARM_FEATURE_SVE) && defined(__ARM_NEON)
+    printf("  NEON line counting: %.3f seconds (%.1f MB/s)\n", 
+           neon_time, (test_size * iterations) / (neon_time * 1024 * 1024));
+#endif
+    printf("  UTF-8 char counting: %.3f seconds (%.1f MB/s)\n", 
+           chars_time, (test_size * iterations) / (chars_time * 1024 * 1024));
+    printf("  Line histogram: %.3f seconds (%.1f MB/s)\n", 
+           hist_time, (test_size * iterations) / (hist_time * 1024 * 1024));
+    printf("  Line index build: %.3f seconds (%.1f MB/s)\n", 
+           index_time, (test_size * iterations) / (index_time * 1024 * 1024));
+    printf("  Byte profile (histogram + words): %.3f seconds (%.1f MB/s)\n", 
+           profile_time, (test_size * iterations) / (profile_time * 1024 * 1024));
+    printf("  Byte classes: %.3f seconds (%.1f MB/s)\n", 
+           classes_time, (test_size * iterations) / (classes_time * 1024 * 1024));
     printf("  Word counting: %.3f seconds (%.1f MB/s)\n", 
            word_time, (test_size * iterations) / (word_time * 1024 * 1024));
     printf("  Full counting: %.3f seconds (%.1f MB/s)\n", 
@@ -530,7 +1697,7 @@ void performance_test() {
 // ============================================================================
 
 #ifdef STRESS_TESTS
-void stress_test() {
+void stress_test(void) {
     printf("Running stress tests...\n");
     
     // Test with very large lines
@@ -541,7 +1708,7 @@ void stress_test() {
         huge_line[huge_line_size] = '\n';
         huge_line[huge_line_size + 1] = '\0';
         
-        wc_options_t opts = {1, 1, 1, 1, 0};
+        wc_options_t opts = {.count_lines = 1, .count_words = 1, .count_chars = 1, .count_bytes = 1};
         wc_counts_t counts = count_data(huge_line, huge_line_size + 1, &opts);
         
         printf("Huge line test: %zu lines, %zu words, %zu chars\n", 
@@ -561,7 +1728,7 @@ void stress_test() {
         }
         many_lines[pos] = '\0';
         
-        wc_options_t opts = {1, 1, 1, 1, 0};
+        wc_options_t opts = {.count_lines = 1, .count_words = 1, .count_chars = 1, .count_bytes = 1};
         wc_counts_t counts = count_data(many_lines, pos, &opts);
         
         printf("Many lines test: %zu lines, %zu words, %zu chars\n", 
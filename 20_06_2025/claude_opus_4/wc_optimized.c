@@ -1,4 +1,5 @@
 // wc_optimized.c - Efficient wc implementation for ASCII strings on Mac M1
+#define _GNU_SOURCE  // readahead(2), sched_setaffinity on Linux
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,56 +7,133 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
-#include <arm_neon.h>
 #include <time.h>
 #include <assert.h>
 #include <errno.h>
+#include <ctype.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// x86 word/line kernels carry their own target attributes and are picked
+// at runtime, so a portable build still gets SIMD (see --print-kernel)
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(WC_SCALAR)
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// -DWC_NUMA -lnuma uses libnuma for the topology and node-local buffers;
+// without it the same information comes from sysfs and raw syscalls
+#if defined(WC_NUMA)
+#include <numa.h>
+#include <numaif.h>
+#elif defined(__linux__)
+#include <linux/mempolicy.h>
+#endif
 
 #define BUFFER_SIZE (1024 * 1024)  // 1MB buffer for non-mmap reads
-#define MIN_MMAP_SIZE (4096)       // Minimum file size for mmap
+#define MIN_MMAP_SIZE (64 * 1024)  // Smaller files: one read beats mmap + faults + munmap
+#define READAHEAD_WINDOW (8 * 1024 * 1024)  // Default --readahead window
+
+// Line-ending tallies for --newline. A \r\n split across two buffers is
+// found through prev_cr.
+typedef struct {
+    size_t lf;      // every \n
+    size_t cr;      // every \r
+    size_t crlf;    // \r\n pairs
+    int prev_cr;    // last byte seen was \r
+} eol_counts_t;
+
+// --count-bytes: up to PATTERN_MAX byte values or short byte sequences,
+// one output column each
+#define PATTERN_MAX 8
+#define PATTERN_MAX_LEN 16
+
+typedef struct {
+    int count;
+    size_t max_len;                          // longest SEQ
+    size_t len[PATTERN_MAX];
+    uint8_t seq[PATTERN_MAX][PATTERN_MAX_LEN];
+} patterns_t;
+
+static patterns_t patterns = { 0 };
+
+// Occurrence counts per SEQ. tail keeps the last max_len - 1 bytes seen so
+// a multi-byte SEQ split across two buffers is counted exactly once.
+typedef struct {
+    size_t n[PATTERN_MAX];
+    uint8_t tail[PATTERN_MAX_LEN - 1];
+    size_t tail_len;
+} pattern_counts_t;
 
 typedef struct {
     size_t lines;
     size_t words;
     size_t bytes;
+    eol_counts_t eol;
+    pattern_counts_t pat;
 } counts_t;
 
-// SIMD-optimized newline counter using NEON
+// --newline modes; NEWLINE_DEFAULT counts \n without the ending report
+enum { NEWLINE_DEFAULT = 0, NEWLINE_LF, NEWLINE_CRLF, NEWLINE_CR, NEWLINE_ANY };
+
+// SIMD-optimized newline counter using NEON.
+// Four independent per-lane byte accumulators absorb each compare with
+// vsubq_u8 (0xFF == -1), so there is no across-vector reduction in the
+// loop. After at most 255 rounds each lane is folded into 16-bit lanes
+// with vpadalq_u8 and reduced once.
 static inline size_t count_newlines_neon(const uint8_t *data, size_t len) {
     size_t count = 0;
-    const uint8_t newline = '\n';
-    uint8x16_t nl_vec = vdupq_n_u8(newline);
+#if defined(__ARM_NEON)
+    const uint8x16_t nl_vec = vdupq_n_u8('\n');
     
     // Process 64 bytes at a time (4 x 16 bytes)
     while (len >= 64) {
-        uint8x16_t v0 = vld1q_u8(data);
-        uint8x16_t v1 = vld1q_u8(data + 16);
-        uint8x16_t v2 = vld1q_u8(data + 32);
-        uint8x16_t v3 = vld1q_u8(data + 48);
-        
-        uint8x16_t eq0 = vceqq_u8(v0, nl_vec);
-        uint8x16_t eq1 = vceqq_u8(v1, nl_vec);
-        uint8x16_t eq2 = vceqq_u8(v2, nl_vec);
-        uint8x16_t eq3 = vceqq_u8(v3, nl_vec);
+        uint8x16_t a0 = vdupq_n_u8(0), a1 = a0, a2 = a0, a3 = a0;
+        size_t rounds = len / 64;
+        if (rounds > 255) rounds = 255;
         
-        // Count set bits (matches)
-        count += vaddvq_u8(eq0) / 255;
-        count += vaddvq_u8(eq1) / 255;
-        count += vaddvq_u8(eq2) / 255;
-        count += vaddvq_u8(eq3) / 255;
+        for (size_t r = 0; r < rounds; r++) {
+            a0 = vsubq_u8(a0, vceqq_u8(vld1q_u8(data), nl_vec));
+            a1 = vsubq_u8(a1, vceqq_u8(vld1q_u8(data + 16), nl_vec));
+            a2 = vsubq_u8(a2, vceqq_u8(vld1q_u8(data + 32), nl_vec));
+            a3 = vsubq_u8(a3, vceqq_u8(vld1q_u8(data + 48), nl_vec));
+            data += 64;
+        }
+        len -= rounds * 64;
         
-        data += 64;
-        len -= 64;
+        uint16x8_t wide = vpaddlq_u8(a0);
+        wide = vpadalq_u8(wide, a1);
+        wide = vpadalq_u8(wide, a2);
+        wide = vpadalq_u8(wide, a3);
+        count += vaddlvq_u16(wide);
     }
     
-    // Process 16 bytes at a time
+    // Process 16 bytes at a time (at most 3 blocks, no overflow)
+    uint8x16_t acc = vdupq_n_u8(0);
     while (len >= 16) {
-        uint8x16_t v = vld1q_u8(data);
-        uint8x16_t eq = vceqq_u8(v, nl_vec);
-        count += vaddvq_u8(eq) / 255;
+        acc = vsubq_u8(acc, vceqq_u8(vld1q_u8(data), nl_vec));
         data += 16;
         len -= 16;
     }
+    count += vaddlvq_u8(acc);
+#endif
     
     // Handle remaining bytes
     while (len--) {
@@ -65,23 +143,269 @@ static inline size_t count_newlines_neon(const uint8_t *data, size_t len) {
     return count;
 }
 
-// Optimized word counting with state machine
-static void count_words_and_lines(const uint8_t *data, size_t len, counts_t *c) {
-    int in_word = 0;
+// Logical line count under a --newline mode
+static size_t eol_lines(const eol_counts_t *e, int mode) {
+    switch (mode) {
+        case NEWLINE_CRLF: return e->crlf;
+        case NEWLINE_CR:   return e->cr;
+        case NEWLINE_ANY:  return e->lf + e->cr - e->crlf;
+        default:           return e->lf;
+    }
+}
+
+// Single-byte SEQs in one sweep: each value has its own per-lane byte
+// accumulator, fed by one compare per block and widened every 255 blocks
+// like count_newlines_neon.
+static void count_pattern_bytes(const uint8_t *data, size_t len, size_t *n) {
+    int idx[PATTERN_MAX], nv = 0;
+    for (int k = 0; k < patterns.count; k++) {
+        if (patterns.len[k] == 1) idx[nv++] = k;
+    }
+    if (nv == 0) return;
     size_t i = 0;
     
+#if defined(__ARM_NEON)
+    uint8x16_t val[PATTERN_MAX];
+    for (int k = 0; k < nv; k++) val[k] = vdupq_n_u8(patterns.seq[idx[k]][0]);
+    
+    while (i + 16 <= len) {
+        uint8x16_t acc[PATTERN_MAX];
+        for (int k = 0; k < nv; k++) acc[k] = vdupq_n_u8(0);
+        size_t blocks = (len - i) / 16;
+        if (blocks > 255) blocks = 255;
+        
+        for (size_t b = 0; b < blocks; b++, i += 16) {
+            uint8x16_t v = vld1q_u8(data + i);
+            for (int k = 0; k < nv; k++) acc[k] = vsubq_u8(acc[k], vceqq_u8(v, val[k]));
+        }
+        for (int k = 0; k < nv; k++) n[idx[k]] += vaddlvq_u8(acc[k]);
+    }
+#endif
+    
+    // One vectorisable loop per value over the (cache-resident) rest
+    for (int k = 0; k < nv; k++) {
+        uint8_t b = patterns.seq[idx[k]][0];
+        size_t count = 0;
+        for (size_t j = i; j < len; j++) count += data[j] == b;
+        n[idx[k]] += count;
+    }
+}
+
+// Occurrences of a multi-byte SEQ that lie wholly inside data, overlapping
+// ones included. NEON filters 16 starts at a time on the first and last
+// byte; only blocks with a candidate are checked byte by byte.
+static size_t count_pattern_seq(const uint8_t *data, size_t len, const uint8_t *seq, size_t m) {
+    if (len < m) return 0;
+    size_t count = 0, i = 0, starts = len - m + 1;
+    
+#if defined(__ARM_NEON)
+    const uint8x16_t first = vdupq_n_u8(seq[0]);
+    const uint8x16_t last = vdupq_n_u8(seq[m - 1]);
+    for (; i + 16 <= starts; i += 16) {
+        uint8x16_t hit = vandq_u8(vceqq_u8(vld1q_u8(data + i), first),
+                                  vceqq_u8(vld1q_u8(data + i + m - 1), last));
+        if (vmaxvq_u8(hit) == 0) continue;
+        for (size_t j = i; j < i + 16; j++) {
+            count += data[j] == seq[0] && memcmp(data + j + 1, seq + 1, m - 1) == 0;
+        }
+    }
+#endif
+    
+    // libc memchr is vectorised; it skips to each first-byte candidate
+    const uint8_t *p = data + i, *end = data + starts;
+    while (p < end && (p = memchr(p, seq[0], end - p)) != NULL) {
+        count += memcmp(p + 1, seq + 1, m - 1) == 0;
+        p++;
+    }
+    return count;
+}
+
+// Multi-byte SEQs that start in tail (the bytes just before data) and end
+// inside data. Also used by the parallel merge at each chunk seam.
+static void count_pattern_seam(const uint8_t *tail, size_t tail_len,
+                               const uint8_t *data, size_t len, size_t *n) {
+    for (int k = 0; k < patterns.count; k++) {
+        size_t m = patterns.len[k];
+        if (m == 1) continue;
+        for (size_t j = tail_len > m - 1 ? tail_len - (m - 1) : 0; j < tail_len; j++) {
+            size_t head = tail_len - j;  // bytes of the SEQ inside tail
+            if (m - head > len) continue;
+            n[k] += memcmp(tail + j, patterns.seq[k], head) == 0 &&
+                    memcmp(data, patterns.seq[k] + head, m - head) == 0;
+        }
+    }
+}
+
+// --count-bytes over one buffer; p carries the seam state to the next
+static void count_patterns(const uint8_t *data, size_t len, pattern_counts_t *p) {
+    if (len == 0) return;
+    if (p->tail_len) count_pattern_seam(p->tail, p->tail_len, data, len, p->n);
+    count_pattern_bytes(data, len, p->n);
+    for (int k = 0; k < patterns.count; k++) {
+        if (patterns.len[k] > 1) p->n[k] += count_pattern_seq(data, len, patterns.seq[k], patterns.len[k]);
+    }
+    
+    size_t keep = patterns.max_len - 1;
+    if (len >= keep) {
+        memcpy(p->tail, data + len - keep, keep);
+        p->tail_len = keep;
+    } else {
+        // Short buffer: slide it onto the end of the old tail
+        size_t old = p->tail_len + len > keep ? keep - len : p->tail_len;
+        memmove(p->tail, p->tail + p->tail_len - old, old);
+        memcpy(p->tail + old, data, len);
+        p->tail_len = old + len;
+    }
+}
+
+// Parse a --count-bytes SEQ with C escapes (\t \n \r \0 \\ \xHH)
+static int parse_pattern(const char *arg, uint8_t *seq, size_t *len) {
+    size_t n = 0;
+    for (const char *p = arg; *p; p++) {
+        int b = (unsigned char)*p;
+        if (b == '\\') {
+            switch (*++p) {
+                case 't': b = '\t'; break;
+                case 'n': b = '\n'; break;
+                case 'r': b = '\r'; break;
+                case '0': b = 0; break;
+                case '\\': b = '\\'; break;
+                case 'x': {
+                    char hex[3] = { 0 };
+                    if (!isxdigit((unsigned char)p[1])) return -1;
+                    hex[0] = *++p;
+                    if (isxdigit((unsigned char)p[1])) hex[1] = *++p;
+                    b = (int)strtol(hex, NULL, 16);
+                    break;
+                }
+                default: return -1;
+            }
+        }
+        if (n == PATTERN_MAX_LEN) return -1;
+        seq[n++] = (uint8_t)b;
+    }
+    *len = n;
+    return n ? 0 : -1;
+}
+
+// POSIX "C" locale whitespace: space and \t \n \v \f \r (9..13)
+static inline int is_space_byte(int ch) {
+    return ch == ' ' || (unsigned)(ch - '\t') <= '\r' - '\t';
+}
+
+#if defined(__ARM_NEON)
+// Word starts in one block: non-space lanes whose predecessor, shifted in
+// from the previous block with vext, is a space. Returns 0xFF lanes.
+static inline uint8x16_t neon_word_starts(uint8x16_t v, uint8x16_t *prev_ns) {
+    uint8x16_t ws = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                             vcleq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8('\r' - '\t')));
+    uint8x16_t ns = vmvnq_u8(ws);
+    uint8x16_t starts = vbicq_u8(ns, vextq_u8(*prev_ns, ns, 15));
+    *prev_ns = ns;
+    return starts;
+}
+#endif
+
+// Optimized word counting with state machine.
+// Words are counted at their first byte, so the state returned for one
+// buffer can be passed into the next and a word split across buffers is
+// counted exactly once. On NEON the lines and word starts go into
+// per-lane accumulators, four blocks per round, widened every 255 rounds
+// like count_newlines_neon.
+//
+// With `endings` set (--newline) the same pass also tallies c->eol: the \n
+// compare already made for the lines is the LF count, and shifting the \r
+// mask up one lane (carrying the last lane of the previous block) marks
+// the \n that completes a \r\n, so pairs are counted once without a scalar
+// look-behind. A \r ending the buffer is carried in c->eol.prev_cr.
+// `endings` is a constant at every call site, so each inlined copy keeps
+// only the work it needs.
+static inline __attribute__((always_inline))
+int count_words_lines_eol(const uint8_t *data, size_t len, counts_t *c, int in_word, int endings) {
+    size_t i = 0, lines0 = c->lines, cr = 0, crlf = 0;
+    int prev_cr = c->eol.prev_cr;
+    
+#if defined(__ARM_NEON)
+    const uint8x16_t nl_vec = vdupq_n_u8('\n');
+    const uint8x16_t cr_vec = vdupq_n_u8('\r');
+    uint8x16_t prev_ns = vdupq_n_u8(in_word ? 0xFF : 0);
+    uint8x16_t prev_crv = vdupq_n_u8(prev_cr ? 0xFF : 0);
+    
+    while (i + 64 <= len) {
+        uint8x16_t l0 = vdupq_n_u8(0), l1 = l0, l2 = l0, l3 = l0;
+        uint8x16_t w0 = l0, w1 = l0, w2 = l0, w3 = l0;
+        uint8x16_t r0 = l0, r1 = l0, r2 = l0, r3 = l0;  // \r, --newline only
+        uint8x16_t p0 = l0, p1 = l0, p2 = l0, p3 = l0;  // \r\n, --newline only
+        size_t rounds = (len - i) / 64;
+        if (rounds > 255) rounds = 255;
+        
+        for (size_t r = 0; r < rounds; r++, i += 64) {
+            uint8x16_t v0 = vld1q_u8(data + i);
+            uint8x16_t v1 = vld1q_u8(data + i + 16);
+            uint8x16_t v2 = vld1q_u8(data + i + 32);
+            uint8x16_t v3 = vld1q_u8(data + i + 48);
+            uint8x16_t n0 = vceqq_u8(v0, nl_vec);
+            uint8x16_t n1 = vceqq_u8(v1, nl_vec);
+            uint8x16_t n2 = vceqq_u8(v2, nl_vec);
+            uint8x16_t n3 = vceqq_u8(v3, nl_vec);
+            
+            l0 = vsubq_u8(l0, n0);
+            l1 = vsubq_u8(l1, n1);
+            l2 = vsubq_u8(l2, n2);
+            l3 = vsubq_u8(l3, n3);
+            
+            // Only the vext carry is serial; the space compares are not
+            w0 = vsubq_u8(w0, neon_word_starts(v0, &prev_ns));
+            w1 = vsubq_u8(w1, neon_word_starts(v1, &prev_ns));
+            w2 = vsubq_u8(w2, neon_word_starts(v2, &prev_ns));
+            w3 = vsubq_u8(w3, neon_word_starts(v3, &prev_ns));
+            
+            if (endings) {
+                uint8x16_t c0 = vceqq_u8(v0, cr_vec);
+                uint8x16_t c1 = vceqq_u8(v1, cr_vec);
+                uint8x16_t c2 = vceqq_u8(v2, cr_vec);
+                uint8x16_t c3 = vceqq_u8(v3, cr_vec);
+                r0 = vsubq_u8(r0, c0);
+                r1 = vsubq_u8(r1, c1);
+                r2 = vsubq_u8(r2, c2);
+                r3 = vsubq_u8(r3, c3);
+                p0 = vsubq_u8(p0, vandq_u8(n0, vextq_u8(prev_crv, c0, 15)));
+                p1 = vsubq_u8(p1, vandq_u8(n1, vextq_u8(c0, c1, 15)));
+                p2 = vsubq_u8(p2, vandq_u8(n2, vextq_u8(c1, c2, 15)));
+                p3 = vsubq_u8(p3, vandq_u8(n3, vextq_u8(c2, c3, 15)));
+                prev_crv = c3;
+            }
+        }
+        
+        uint16x8_t lines = vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(l0), l1), l2), l3);
+        uint16x8_t words = vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(w0), w1), w2), w3);
+        c->lines += vaddlvq_u16(lines);
+        c->words += vaddlvq_u16(words);
+        if (endings) {
+            cr += vaddlvq_u16(vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(r0), r1), r2), r3));
+            crlf += vaddlvq_u16(vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(p0), p1), p2), p3));
+        }
+    }
+    if (i > 0) {
+        in_word = vgetq_lane_u8(prev_ns, 15) != 0;
+        prev_cr = vgetq_lane_u8(prev_crv, 15) != 0;
+    }
+#endif
+    
     // Unroll loop for better performance
     while (i + 8 <= len) {
         for (int j = 0; j < 8; j++) {
             uint8_t ch = data[i + j];
             if (ch == '\n') c->lines++;
             
-            int is_space = (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r');
-            if (in_word && is_space) {
-                c->words++;
-                in_word = 0;
-            } else if (!in_word && !is_space) {
-                in_word = 1;
+            int is_space = is_space_byte(ch);
+            if (!in_word && !is_space) c->words++;
+            in_word = !is_space;
+            
+            if (endings) {
+                crlf += ch == '\n' && prev_cr;
+                prev_cr = ch == '\r';
+                cr += prev_cr;
             }
         }
         i += 8;
@@ -92,94 +416,1781 @@ static void count_words_and_lines(const uint8_t *data, size_t len, counts_t *c)
         uint8_t ch = data[i++];
         if (ch == '\n') c->lines++;
         
-        int is_space = (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r');
-        if (in_word && is_space) {
-            c->words++;
-            in_word = 0;
-        } else if (!in_word && !is_space) {
-            in_word = 1;
+        int is_space = is_space_byte(ch);
+        if (!in_word && !is_space) c->words++;
+        in_word = !is_space;
+        
+        if (endings) {
+            crlf += ch == '\n' && prev_cr;
+            prev_cr = ch == '\r';
+            cr += prev_cr;
         }
     }
     
-    // Count last word if needed
-    if (in_word) c->words++;
+    if (endings) {
+        c->eol.lf += c->lines - lines0;
+        c->eol.cr += cr;
+        c->eol.crlf += crlf;
+        c->eol.prev_cr = prev_cr;
+    }
+    return in_word;
 }
 
-// Process file using mmap for large files
-static int process_file_mmap(const char *filename, counts_t *c) {
-    int fd = open(filename, O_RDONLY);
-    if (fd < 0) return -1;
+static int native_words_lines(const uint8_t *data, size_t len, counts_t *c, int in_word) {
+    return count_words_lines_eol(data, len, c, in_word, 0);
+}
+
+static int native_words_endings(const uint8_t *data, size_t len, counts_t *c, int in_word) {
+    return count_words_lines_eol(data, len, c, in_word, 1);
+}
+
+#if defined(HAVE_X86_KERNELS)
+// The x86 kernels compare one vector into bitmasks, bit i for byte i. A
+// word starts at each non-space bit whose lower neighbour (or the last bit
+// of the previous block) is a space, and a \r\n at each \n bit above a \r
+// bit. The scalar loop of count_words_lines_eol takes the tail.
+typedef struct {
+    size_t lines, words, cr, crlf;
+    uint64_t prev_ns, prev_cr;  // top bit of the previous block
+} mask_tally_t;
+
+static inline __attribute__((always_inline))
+void mask_tally(mask_tally_t *t, uint64_t nl, uint64_t ns, uint64_t crm, int width, int endings) {
+    t->lines += __builtin_popcountll(nl);
+    t->words += __builtin_popcountll(ns & ~((ns << 1) | t->prev_ns));
+    t->prev_ns = (ns >> (width - 1)) & 1;
+    if (endings) {
+        t->cr += __builtin_popcountll(crm);
+        t->crlf += __builtin_popcountll(nl & ((crm << 1) | t->prev_cr));
+        t->prev_cr = (crm >> (width - 1)) & 1;
+    }
+}
+
+static inline __attribute__((always_inline))
+int mask_tally_finish(const mask_tally_t *t, const uint8_t *data, size_t i, size_t len,
+                      counts_t *c, int endings) {
+    c->lines += t->lines;
+    c->words += t->words;
+    if (endings) {
+        c->eol.lf += t->lines;
+        c->eol.cr += t->cr;
+        c->eol.crlf += t->crlf;
+        c->eol.prev_cr = (int)t->prev_cr;
+    }
+    return count_words_lines_eol(data + i, len - i, c, (int)t->prev_ns, endings);
+}
+
+// Space is ' ' or (ch - '\t') <= 4 unsigned; min_epu8 stands in for the
+// missing unsigned compare below AVX-512
+static inline __attribute__((always_inline, target("sse4.2,popcnt")))
+int sse42_words_eol(const uint8_t *data, size_t len, counts_t *c, int in_word, int endings) {
+    const __m128i nl = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r'), sp = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t'), four = _mm_set1_epi8(4);
+    mask_tally_t t = { 0, 0, 0, 0, (uint64_t)in_word, (uint64_t)c->eol.prev_cr };
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i d = _mm_sub_epi8(v, tab);
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(_mm_min_epu8(d, four), d));
+        mask_tally(&t, (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)),
+                   ~(uint32_t)_mm_movemask_epi8(ws) & 0xFFFF,
+                   endings ? (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, cr)) : 0, 16, endings);
+    }
+    return mask_tally_finish(&t, data, i, len, c, endings);
+}
+
+static inline __attribute__((always_inline, target("avx2,popcnt")))
+int avx2_words_eol(const uint8_t *data, size_t len, counts_t *c, int in_word, int endings) {
+    const __m256i nl = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r'), sp = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t'), four = _mm256_set1_epi8(4);
+    mask_tally_t t = { 0, 0, 0, 0, (uint64_t)in_word, (uint64_t)c->eol.prev_cr };
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(data + i));
+        __m256i d = _mm256_sub_epi8(v, tab);
+        __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, sp), _mm256_cmpeq_epi8(_mm256_min_epu8(d, four), d));
+        mask_tally(&t, (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)),
+                   ~(uint32_t)_mm256_movemask_epi8(ws),
+                   endings ? (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, cr)) : 0, 32, endings);
+    }
+    return mask_tally_finish(&t, data, i, len, c, endings);
+}
+
+static inline __attribute__((always_inline, target("avx512f,avx512bw,popcnt")))
+int avx512bw_words_eol(const uint8_t *data, size_t len, counts_t *c, int in_word, int endings) {
+    const __m512i nl = _mm512_set1_epi8('\n'), cr = _mm512_set1_epi8('\r'), sp = _mm512_set1_epi8(' ');
+    const __m512i tab = _mm512_set1_epi8('\t'), four = _mm512_set1_epi8(4);
+    mask_tally_t t = { 0, 0, 0, 0, (uint64_t)in_word, (uint64_t)c->eol.prev_cr };
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(data + i));
+        uint64_t ws = _mm512_cmpeq_epi8_mask(v, sp) | _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, tab), four);
+        mask_tally(&t, _mm512_cmpeq_epi8_mask(v, nl), ~ws,
+                   endings ? _mm512_cmpeq_epi8_mask(v, cr) : 0, 64, endings);
+    }
+    return mask_tally_finish(&t, data, i, len, c, endings);
+}
+
+// One entry point per kernel and mode, so `endings` folds away as above
+#define X86_WORDS_KERNEL(isa, target_isa)                                                   \
+    __attribute__((target(target_isa)))                                                     \
+    static int isa##_words_lines(const uint8_t *data, size_t len, counts_t *c, int in_word) { \
+        return isa##_words_eol(data, len, c, in_word, 0);                                   \
+    }                                                                                       \
+    __attribute__((target(target_isa)))                                                     \
+    static int isa##_words_endings(const uint8_t *data, size_t len, counts_t *c, int in_word) { \
+        return isa##_words_eol(data, len, c, in_word, 1);                                   \
+    }
+X86_WORDS_KERNEL(sse42, "sse4.2,popcnt")
+X86_WORDS_KERNEL(avx2, "avx2,popcnt")
+X86_WORDS_KERNEL(avx512bw, "avx512f,avx512bw,popcnt")
+#undef X86_WORDS_KERNEL
+
+static int cpu_has_sse42(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+}
+static int cpu_has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+static int cpu_has_avx512bw(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+#endif
+
+static int cpu_has_baseline(void) { return 1; }
+
+// Word and line kernels, best first. The first one the CPU supports is
+// taken once per process, unless WC_KERNEL names another.
+typedef struct {
+    const char *name;
+    const char *level;
+    int (*lines)(const uint8_t *data, size_t len, counts_t *c, int in_word);
+    int (*endings)(const uint8_t *data, size_t len, counts_t *c, int in_word);
+    int (*supported)(void);
+} words_kernel_t;
+
+static const words_kernel_t words_kernels[] = {
+#if defined(HAVE_X86_KERNELS)
+    { "avx512bw", "x86-64-v4", avx512bw_words_lines, avx512bw_words_endings, cpu_has_avx512bw },
+    { "avx2",     "x86-64-v3", avx2_words_lines,     avx2_words_endings,     cpu_has_avx2 },
+    { "sse4.2",   "x86-64-v2", sse42_words_lines,    sse42_words_endings,    cpu_has_sse42 },
+#endif
+#if defined(__ARM_NEON)
+    { "neon",     "armv8-a",   native_words_lines,   native_words_endings,   cpu_has_baseline },
+#else
+    { "scalar",   "generic",   native_words_lines,   native_words_endings,   cpu_has_baseline },
+#endif
+};
+#define WORDS_KERNELS (sizeof(words_kernels) / sizeof(words_kernels[0]))
+
+static const words_kernel_t *words_kernel_active;
+static pthread_once_t words_kernel_once = PTHREAD_ONCE_INIT;
+
+// Pin a kernel by name; -1 if it is not built in or the CPU lacks it
+static int words_kernel_select(const char *name) {
+    for (size_t k = 0; k < WORDS_KERNELS; k++) {
+        if (strcmp(words_kernels[k].name, name) == 0 && words_kernels[k].supported()) {
+            words_kernel_active = &words_kernels[k];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void words_kernel_resolve(void) {
+    const char *forced = getenv("WC_KERNEL");
+    if (forced && *forced && words_kernel_select(forced) == 0) return;
+    size_t k = 0;
+    while (k + 1 < WORDS_KERNELS && !words_kernels[k].supported()) k++;
+    words_kernel_active = &words_kernels[k];
+}
+
+static inline const words_kernel_t *words_kernel(void) {
+    pthread_once(&words_kernel_once, words_kernel_resolve);
+    return words_kernel_active;
+}
+
+static int count_words_and_lines(const uint8_t *data, size_t len, counts_t *c, int in_word) {
+    return words_kernel()->lines(data, len, c, in_word);
+}
+
+// count_words_and_lines plus the --newline tallies in c->eol, in one pass
+static int count_words_and_endings(const uint8_t *data, size_t len, counts_t *c, int in_word) {
+    return words_kernel()->endings(data, len, c, in_word);
+}
+
+// ============= PROGRESS =============
+
+// --progress: counting threads publish their running byte and line totals
+// to their own cache-line-sized slot with relaxed stores, so the hot loop
+// never takes a lock or shares a line with another writer. A reporter
+// thread wakes every interval, sums the slots and prints rate, ETA and the
+// lines so far to stderr. Counts are published once per PROGRESS_STEP.
+#define PROGRESS_STEP (1024 * 1024)
+#define PROGRESS_SLOTS 1024  // one per counting thread
+
+typedef struct {
+    atomic_size_t bytes;
+    atomic_size_t lines;
+} __attribute__((aligned(64))) progress_slot_t;
+
+typedef struct {
+    double interval;  // seconds between reports, 0 = off
+    FILE *out;
+    const char *name;
+    size_t total;     // bytes expected, 0 if unknown (stdin)
+    double start;
+    int running;
+    int stop;
+    int tty;
+    pthread_t tid;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} progress_t;
+
+static progress_t progress = {
+    .interval = 0,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+static progress_slot_t progress_slots[PROGRESS_SLOTS];
+
+static inline progress_slot_t *progress_slot(int i) {
+    return progress.running ? &progress_slots[i] : NULL;
+}
+
+// Only the owning thread writes a slot, so load + store is enough
+static inline void progress_add(progress_slot_t *slot, size_t bytes, size_t lines) {
+    atomic_store_explicit(&slot->bytes,
+                          atomic_load_explicit(&slot->bytes, memory_order_relaxed) + bytes,
+                          memory_order_relaxed);
+    atomic_store_explicit(&slot->lines,
+                          atomic_load_explicit(&slot->lines, memory_order_relaxed) + lines,
+                          memory_order_relaxed);
+}
+
+// Words and lines, plus the --newline tallies when asked for
+static int count_words_maybe_endings(const uint8_t *data, size_t len, counts_t *c, int in_word,
+                                     int newline_mode) {
+    return newline_mode ? count_words_and_endings(data, len, c, in_word)
+                        : count_words_and_lines(data, len, c, in_word);
+}
+
+// count_words_maybe_endings in PROGRESS_STEP slices, publishing after each
+static int count_with_progress(const uint8_t *data, size_t len, counts_t *c, int in_word,
+                               progress_slot_t *slot, int newline_mode) {
+    if (!slot) return count_words_maybe_endings(data, len, c, in_word, newline_mode);
+    for (size_t off = 0; off < len; off += PROGRESS_STEP) {
+        size_t n = len - off < PROGRESS_STEP ? len - off : PROGRESS_STEP;
+        size_t lines = c->lines;
+        in_word = count_words_maybe_endings(data + off, n, c, in_word, newline_mode);
+        progress_add(slot, n, c->lines - lines);
+    }
+    return in_word;
+}
+
+// Words, lines and the --newline tallies in one pass; the --count-bytes
+// extras follow one PROGRESS_STEP slice at a time so they re-read the
+// slice from cache instead of making their own pass over the whole buffer
+static int count_span(const uint8_t *data, size_t len, counts_t *c, int in_word,
+                      progress_slot_t *slot, int newline_mode) {
+    if (!patterns.count) return count_with_progress(data, len, c, in_word, slot, newline_mode);
+    for (size_t off = 0; off < len; off += PROGRESS_STEP) {
+        size_t n = len - off < PROGRESS_STEP ? len - off : PROGRESS_STEP;
+        in_word = count_with_progress(data + off, n, c, in_word, slot, newline_mode);
+        count_patterns(data + off, n, &c->pat);
+    }
+    return in_word;
+}
+
+static double progress_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const char *progress_size(double bytes, char *buf, size_t cap) {
+    const char *units = "BKMGTP";
+    int u = 0;
+    while (bytes >= 1024 && units[u + 1]) {
+        bytes /= 1024;
+        u++;
+    }
+    snprintf(buf, cap, u ? "%.1f %ciB" : "%.0f %c", bytes, units[u]);
+    return buf;
+}
+
+static void progress_print(int final) {
+    size_t bytes = 0, lines = 0;
+    for (int i = 0; i < PROGRESS_SLOTS; i++) {
+        bytes += atomic_load_explicit(&progress_slots[i].bytes, memory_order_relaxed);
+        lines += atomic_load_explicit(&progress_slots[i].lines, memory_order_relaxed);
+    }
+    double elapsed = progress_clock() - progress.start;
+    double rate = elapsed > 0 ? bytes / elapsed : 0;
+    char done[32], total[32], speed[32];
     
-    struct stat st;
-    if (fstat(fd, &st) < 0) {
-        close(fd);
-        return -1;
+    fprintf(progress.out, "%swc: %s: %s", progress.tty ? "\r\033[K" : "", progress.name,
+            progress_size(bytes, done, sizeof(done)));
+    if (progress.total) {
+        fprintf(progress.out, " of %s (%.1f%%)", progress_size(progress.total, total, sizeof(total)),
+                100.0 * bytes / progress.total);
+    }
+    fprintf(progress.out, ", %s/s", progress_size(rate, speed, sizeof(speed)));
+    if (!final && progress.total && rate > 0 && bytes < progress.total) {
+        long eta = (long)((progress.total - bytes) / rate);
+        fprintf(progress.out, ", ETA %ld:%02ld:%02ld", eta / 3600, eta / 60 % 60, eta % 60);
+    }
+    fprintf(progress.out, ", %zu lines%s", lines, final ? ", done" : "");
+    fputs(progress.tty && !final ? "" : "\n", progress.out);
+    fflush(progress.out);
+}
+
+static void *progress_reporter(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&progress.lock);
+    while (!progress.stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        double secs = deadline.tv_nsec * 1e-9 + progress.interval;
+        deadline.tv_sec += (time_t)secs;
+        deadline.tv_nsec = (long)((secs - (time_t)secs) * 1e9);
+        pthread_cond_timedwait(&progress.wake, &progress.lock, &deadline);
+        if (!progress.stop) progress_print(0);
     }
+    pthread_mutex_unlock(&progress.lock);
+    return NULL;
+}
+
+// Start reporting on one input; the slots must be zero before any worker runs
+static void progress_begin(const char *name, size_t total) {
+    if (progress.interval <= 0) return;
+    memset(progress_slots, 0, sizeof(progress_slots));
+    if (!progress.out) progress.out = stderr;
+    progress.name = name;
+    progress.total = total;
+    progress.start = progress_clock();
+    progress.stop = 0;
+    progress.tty = isatty(fileno(progress.out));
+    progress.running = pthread_create(&progress.tid, NULL, progress_reporter, NULL) == 0;
+}
+
+static void progress_end(void) {
+    if (!progress.running) return;
+    pthread_mutex_lock(&progress.lock);
+    progress.stop = 1;
+    pthread_cond_signal(&progress.wake);
+    pthread_mutex_unlock(&progress.lock);
+    pthread_join(progress.tid, NULL);
+    progress.running = 0;
+    progress_print(1);
+}
+
+// ============= I/O HINTS =============
+
+// Read-ahead control for cold files. The mapping is counted one window at a
+// time while the next window is already being read in, and the pages behind
+// the cursor that were not cached before we started are handed back, so a
+// pass over a huge file does not evict everybody else's working set.
+typedef struct {
+    size_t window;     // bytes hinted ahead of the cursor, 0 = no hints
+    int drop_behind;   // release pages behind the cursor we faulted in
+} io_hints_t;
+
+static io_hints_t io_hints = { READAHEAD_WINDOW, 1 };
+
+#if defined(__APPLE__)
+typedef char mincore_vec_t;
+#else
+typedef unsigned char mincore_vec_t;
+#endif
+
+// Start reading [off, off + len) in the background
+static void hint_ahead(int fd, off_t off, size_t len) {
+#if defined(__linux__)
+    if (readahead(fd, off, len) < 0) posix_fadvise(fd, off, len, POSIX_FADV_WILLNEED);
+#elif defined(__APPLE__)
+    struct radvisory ra = { .ra_offset = off, .ra_count = (int)len };
+    fcntl(fd, F_RDADVISE, &ra);
+#else
+    (void)fd; (void)off; (void)len;
+#endif
+}
+
+// Drop the pages of one window that `resident` says were not cached
+// beforehand. The mapping has to let go of them before the page cache will.
+static void drop_behind(int fd, const uint8_t *map, size_t off, size_t len,
+                        const mincore_vec_t *resident, size_t page) {
+#if defined(__linux__)
+    size_t npages = (len + page - 1) / page;
+    size_t run = 0;
     
-    if (st.st_size == 0) {
-        close(fd);
-        return 0;
+    for (size_t p = 0; p <= npages; p++) {
+        if (p < npages && !(resident[p] & 1)) continue;
+        if (p > run) {
+            size_t start = off + run * page;
+            size_t bytes = (p - run) * page;
+            madvise((void *)(map + start), bytes, MADV_DONTNEED);
+            posix_fadvise(fd, start, bytes, POSIX_FADV_DONTNEED);
+        }
+        run = p + 1;
+    }
+#else
+    (void)fd; (void)map; (void)off; (void)len; (void)resident; (void)page;
+#endif
+}
+
+// Count a mapped file window by window. Window k + 1 is snapshotted with
+// mincore and hinted before window k is counted, so the snapshot still
+// shows what was cached before this pass.
+static void count_mapped_windows(int fd, const uint8_t *map, size_t size,
+                                 counts_t *c, int newline_mode) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t window = (io_hints.window + page - 1) / page * page;
+    mincore_vec_t *resident[2] = { NULL, NULL };
+    int in_word = 0;
+    
+    if (io_hints.drop_behind) {
+        resident[0] = malloc(window / page);
+        resident[1] = malloc(window / page);
+        if (!resident[0] || !resident[1]) {
+            free(resident[0]);
+            free(resident[1]);
+            resident[0] = resident[1] = NULL;
+        }
     }
     
-    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-    close(fd);
+    size_t first = size < window ? size : window;
+    if (resident[0] && mincore((void *)map, first, resident[0]) < 0) memset(resident[0], 1, window / page);
+    hint_ahead(fd, 0, first);
+    
+    for (size_t off = 0, k = 0; off < size; off += window, k ^= 1) {
+        size_t len = size - off < window ? size - off : window;
+        size_t next = off + len;
+        
+        if (next < size) {
+            size_t next_len = size - next < window ? size - next : window;
+            if (resident[k ^ 1] && mincore((void *)(map + next), next_len, resident[k ^ 1]) < 0) {
+                memset(resident[k ^ 1], 1, window / page);
+            }
+            hint_ahead(fd, next, next_len);
+        }
+        
+        in_word = count_span(map + off, len, c, in_word, progress_slot(0), newline_mode);
+        if (resident[k]) drop_behind(fd, map, off, len, resident[k], page);
+    }
+    
+    free(resident[0]);
+    free(resident[1]);
+}
+
+// Count an open regular file through mmap
+static int process_fd_mmap(int fd, counts_t *c, int newline_mode) {
+    struct stat st;
+    if (fstat(fd, &st) < 0) return -1;
+    if (st.st_size == 0) return 0;
+    
+    size_t size = st.st_size;
+    int windowed = io_hints.window > 0 && size > io_hints.window;
+    int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+    // A file that fits in one window is cheaper to fault in with one call
+    if (io_hints.window > 0 && !windowed) flags |= MAP_POPULATE;
+#endif
+#if defined(__linux__)
+    if (io_hints.window > 0) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
     
+    void *map = mmap(NULL, size, PROT_READ, flags, fd, 0);
     if (map == MAP_FAILED) return -1;
     
     // Advise kernel about access pattern
-    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    madvise(map, size, MADV_SEQUENTIAL);
     
-    c->bytes = st.st_size;
-    count_words_and_lines((const uint8_t *)map, st.st_size, c);
+    c->bytes = size;
+    if (windowed) {
+        count_mapped_windows(fd, (const uint8_t *)map, size, c, newline_mode);
+    } else {
+        count_span((const uint8_t *)map, size, c, 0, progress_slot(0), newline_mode);
+    }
+    if (newline_mode) c->lines = eol_lines(&c->eol, newline_mode);
     
-    munmap(map, st.st_size);
+    munmap(map, size);
     return 0;
 }
 
-// Process file using buffered reads for small files or stdin
-static int process_file_buffered(FILE *fp, counts_t *c) {
-    uint8_t *buffer = aligned_alloc(64, BUFFER_SIZE);
-    if (!buffer) return -1;
+// Process file using mmap for large files
+static int process_file_mmap(const char *filename, counts_t *c, int newline_mode) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return -1;
+    int ret = process_fd_mmap(fd, c, newline_mode);
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return ret;
+}
+
+// ============= PARALLEL ENGINE =============
+
+// --threads splits one mapped file into PARALLEL_CHUNK pieces counted by
+// worker threads, each pinned to one CPU. On multi-socket hosts each chunk
+// is queued on the NUMA node that holds its page-cache pages (found with
+// move_pages), so a thread on that socket counts it. Chunks that are not
+// cached yet are spread over the nodes. They are read with pread into a
+// node-local buffer, which also brings their page-cache pages onto that
+// node. A worker whose own queue runs dry steals from the other nodes.
+#define PARALLEL_CHUNK (8 * 1024 * 1024)
+#define PARALLEL_SAMPLES 4  // pages per chunk checked for placement
+#define MAX_NODES 64
+#define MAX_CPUS 1024
+
+typedef struct {
+    int threads;  // 0 = serial, -1 = one per CPU we may run on
+    int stats;    // per-node bandwidth report on stderr
+} parallel_opts_t;
+
+static parallel_opts_t parallel_opts = { 0, 0 };
+
+typedef struct {
+    int ncpus;
+    int cpu[MAX_CPUS];   // CPUs we may run on, interleaved across nodes; -1 = don't pin
+    int node[MAX_CPUS];  // node of each
+    int nnodes;          // highest node id + 1
+} numa_topo_t;
+
+// One chunk, counted as if it followed whitespace. The edge bytes let the
+// merge take off words and add \r\n pairs that straddle a seam.
+typedef struct {
+    counts_t c;
+    uint8_t first, last;
+    int node;    // queue it was placed on
+    int cached;  // sampled pages were in the page cache
+} chunk_t;
+
+struct parallel_job;
+
+typedef struct {
+    pthread_t tid;
+    int cpu, node;
+    struct parallel_job *job;
+    progress_slot_t *progress;  // NULL without --progress
+    size_t chunks, cached, stolen, bytes;
+    double busy;  // seconds spent reading and counting
+} __attribute__((aligned(64))) worker_t;
+
+typedef struct parallel_job {
+    int fd;
+    const uint8_t *map;
+    size_t size, nchunks;
+    int newline_mode;
+    int nnodes;
+    chunk_t *chunks;
+    size_t *queue[MAX_NODES];  // chunk indices placed on each node
+    size_t qlen[MAX_NODES];
+    atomic_size_t qnext[MAX_NODES];
+    atomic_int failed;         // errno of the first failed read
+} parallel_job_t;
+
+static double parallel_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#if defined(__linux__) && !defined(WC_NUMA)
+// "0-3,8-11" from sysfs
+static void parse_cpulist(const char *list, int node, int *cpu_node) {
+    const char *p = list;
+    while (*p && *p != '\n') {
+        char *end;
+        long a = strtol(p, &end, 10), b = a;
+        if (end == p) break;
+        if (*end == '-') b = strtol(end + 1, &end, 10);
+        for (long c = a; c <= b; c++) {
+            if (c >= 0 && c < MAX_CPUS) cpu_node[c] = node;
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+}
+#endif
+
+// Node of every CPU; 0 without NUMA information
+static void cpu_nodes(int *cpu_node) {
+    for (int c = 0; c < MAX_CPUS; c++) cpu_node[c] = 0;
+#if defined(WC_NUMA)
+    if (numa_available() < 0) return;
+    for (int c = 0; c < MAX_CPUS; c++) {
+        int n = numa_node_of_cpu(c);
+        if (n >= 0 && n < MAX_NODES) cpu_node[c] = n;
+    }
+#elif defined(__linux__)
+    for (int n = 0; n < MAX_NODES; n++) {
+        char path[64], list[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", n);
+        FILE *fp = fopen(path, "r");
+        if (!fp) continue;
+        if (fgets(list, sizeof(list), fp)) parse_cpulist(list, n, cpu_node);
+        fclose(fp);
+    }
+#endif
+}
+
+// CPUs in our affinity mask and their nodes. WC_FAKE_NUMA=N splits them
+// into N pretend nodes, to exercise placement and stealing on one socket.
+static void numa_topology(numa_topo_t *t) {
+    static int cpu_node[MAX_CPUS];
+    int allowed[MAX_CPUS], node[MAX_CPUS], n = 0;
+    
+#if defined(__linux__)
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE && c < MAX_CPUS; c++) {
+            if (CPU_ISSET(c, &set)) allowed[n++] = c;
+        }
+    }
+#endif
+    if (n == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long c = 0; c < online && c < MAX_CPUS; c++) allowed[n++] = -1;
+    }
+    if (n == 0) allowed[n++] = -1;
+    
+    cpu_nodes(cpu_node);
+    const char *fake = getenv("WC_FAKE_NUMA");
+    int nfake = fake ? atoi(fake) : 0;
+    if (nfake > MAX_NODES) nfake = MAX_NODES;
+    t->nnodes = 1;
+    for (int i = 0; i < n; i++) {
+        node[i] = nfake > 1 ? i * nfake / n : allowed[i] >= 0 ? cpu_node[allowed[i]] : 0;
+        if (node[i] + 1 > t->nnodes) t->nnodes = node[i] + 1;
+    }
+    
+    // Interleave so that the first k workers are spread over every node
+    t->ncpus = 0;
+    for (int round = 0; t->ncpus < n; round++) {
+        for (int nd = 0; nd < t->nnodes; nd++) {
+            int seen = 0;
+            for (int i = 0; i < n; i++) {
+                if (node[i] != nd || seen++ != round) continue;
+                t->cpu[t->ncpus] = allowed[i];
+                t->node[t->ncpus] = nd;
+                t->ncpus++;
+                break;
+            }
+        }
+    }
+}
+
+static void pin_to_cpu(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);  // 0 = the calling thread
+#else
+    (void)cpu;
+#endif
+}
+
+// NUMA node of each resident page in pages[]; status[i] < 0 if unknown
+static void page_nodes(void **pages, int *status, size_t n) {
+    if (n == 0) return;
+#if defined(__linux__)
+    // With a NULL node list move_pages only reports where the pages are
+#if defined(WC_NUMA)
+    if (move_pages(0, n, pages, NULL, status, 0) == 0) return;
+#else
+    if (syscall(SYS_move_pages, 0, n, pages, NULL, status, 0) == 0) return;
+#endif
+    // move_pages may be filtered (seccomp, containers); ask per page instead
+    for (size_t i = 0; i < n; i++) {
+        int node = -1;
+#if defined(WC_NUMA)
+        if (get_mempolicy(&node, NULL, 0, pages[i], MPOL_F_NODE | MPOL_F_ADDR) < 0) node = -1;
+#else
+        if (syscall(SYS_get_mempolicy, &node, NULL, 0, pages[i], MPOL_F_NODE | MPOL_F_ADDR) < 0) node = -1;
+#endif
+        status[i] = node;
+    }
+#else
+    for (size_t i = 0; i < n; i++) status[i] = 0;
+#endif
+}
+
+// Queue every chunk on the node that holds most of its sampled pages, or
+// round-robin over the nodes that have workers if it is not cached
+static int parallel_place(parallel_job_t *job, const numa_topo_t *topo) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t nsamples = job->nchunks * PARALLEL_SAMPLES;
+    void **pages = malloc(nsamples * sizeof(void *));
+    int *status = malloc(nsamples * sizeof(int));
+    size_t *owner = malloc(nsamples * sizeof(size_t));
+    size_t *slots = malloc((size_t)job->nnodes * job->nchunks * sizeof(size_t));
+    if (!pages || !status || !owner || !slots) {
+        free(pages); free(status); free(owner); free(slots);
+        return -1;
+    }
+    
+    // Only pages already in the page cache are queried; touching them maps
+    // them into our page tables, which is where move_pages looks
+    size_t nq = 0;
+    for (size_t k = 0; k < job->nchunks; k++) {
+        size_t off = k * PARALLEL_CHUNK;
+        size_t len = job->size - off < PARALLEL_CHUNK ? job->size - off : PARALLEL_CHUNK;
+        for (int s = 0; s < PARALLEL_SAMPLES; s++) {
+            const uint8_t *p = job->map + off + (len * s / PARALLEL_SAMPLES) / page * page;
+            mincore_vec_t resident = 0;
+            if (mincore((void *)p, 1, &resident) < 0 || !(resident & 1)) continue;
+            (void)*(volatile const uint8_t *)p;
+            pages[nq] = (void *)p;
+            owner[nq++] = k;
+        }
+    }
+    page_nodes(pages, status, nq);
+    
+    int nodes_with_cpus[MAX_NODES], nwith = 0;
+    for (int nd = 0; nd < job->nnodes; nd++) {
+        for (int i = 0; i < topo->ncpus; i++) {
+            if (topo->node[i] == nd) {
+                nodes_with_cpus[nwith++] = nd;
+                break;
+            }
+        }
+    }
+    
+    size_t q = 0, cold = 0;
+    for (int nd = 0; nd < job->nnodes; nd++) {
+        job->queue[nd] = slots + (size_t)nd * job->nchunks;
+        job->qlen[nd] = 0;
+        atomic_init(&job->qnext[nd], 0);
+    }
+    for (size_t k = 0; k < job->nchunks; k++) {
+        int votes[MAX_NODES] = {0}, any = 0, best = 0;
+        for (; q < nq && owner[q] == k; q++) {
+            any = 1;
+            if (status[q] >= 0 && status[q] < job->nnodes) votes[status[q]]++;
+        }
+        for (int nd = 1; nd < job->nnodes; nd++) {
+            if (votes[nd] > votes[best]) best = nd;
+        }
+        if (!any) best = nodes_with_cpus[cold++ % nwith];
+        job->chunks[k].node = best;
+        job->chunks[k].cached = any;
+        job->queue[best][job->qlen[best]++] = k;
+    }
+    
+    free(pages); free(status); free(owner);
+    return 0;
+}
+
+static int parallel_claim(parallel_job_t *job, int node, size_t *k, int *stolen) {
+    for (int i = 0; i < job->nnodes; i++) {
+        int nd = (node + i) % job->nnodes;
+        size_t q = atomic_fetch_add_explicit(&job->qnext[nd], 1, memory_order_relaxed);
+        if (q < job->qlen[nd]) {
+            *k = job->queue[nd][q];
+            *stolen = i > 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Read buffer on the calling thread's node. Workers are pinned before they
+// allocate, so without libnuma first touch puts the pages in the right place.
+static uint8_t *node_local_alloc(size_t len, int node) {
+#if defined(WC_NUMA)
+    if (numa_available() >= 0) return numa_alloc_onnode(len, node);
+#else
+    (void)node;
+#endif
+    uint8_t *buf = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf == MAP_FAILED) return NULL;
+    for (size_t off = 0; off < len; off += 4096) buf[off] = 0;
+    return buf;
+}
+
+static void *parallel_worker(void *arg) {
+    worker_t *w = arg;
+    parallel_job_t *job = w->job;
+    uint8_t *buf = NULL;
+    size_t k;
+    int stolen;
+    
+    pin_to_cpu(w->cpu);
+    while (!atomic_load_explicit(&job->failed, memory_order_relaxed) &&
+           parallel_claim(job, w->node, &k, &stolen)) {
+        chunk_t *ch = &job->chunks[k];
+        size_t off = k * PARALLEL_CHUNK;
+        size_t len = job->size - off < PARALLEL_CHUNK ? job->size - off : PARALLEL_CHUNK;
+        const uint8_t *data = job->map + off;
+        double t0 = parallel_now();
+        
+        if (!ch->cached) {
+            if (!buf) buf = node_local_alloc(PARALLEL_CHUNK, w->node);
+            if (buf) {
+                size_t got = 0;
+                while (got < len) {
+                    ssize_t r = pread(job->fd, buf + got, len - got, off + got);
+                    if (r < 0 && errno == EINTR) continue;
+                    if (r <= 0) {
+                        atomic_store(&job->failed, r < 0 ? errno : EIO);
+                        break;
+                    }
+                    got += r;
+                }
+                if (got < len) break;
+                data = buf;
+            }
+        }
+        
+        counts_t *c = &ch->c;
+        memset(c, 0, sizeof(*c));
+        c->bytes = len;
+        count_span(data, len, c, 0, w->progress, job->newline_mode);
+        ch->first = data[0];
+        ch->last = data[len - 1];
+#if defined(__linux__)
+        // Same rule as drop_behind: give back what we pulled in ourselves
+        if (!ch->cached && io_hints.drop_behind) posix_fadvise(job->fd, off, len, POSIX_FADV_DONTNEED);
+#endif
+        
+        w->busy += parallel_now() - t0;
+        w->chunks++;
+        w->cached += ch->cached;
+        w->stolen += stolen;
+        w->bytes += len;
+    }
+    
+    if (buf) {
+#if defined(WC_NUMA)
+        if (numa_available() >= 0) numa_free(buf, PARALLEL_CHUNK);
+        else munmap(buf, PARALLEL_CHUNK);
+#else
+        munmap(buf, PARALLEL_CHUNK);
+#endif
+    }
+    return NULL;
+}
+
+static void print_parallel_stats(const char *filename, const parallel_job_t *job,
+                                 const worker_t *workers, int nthreads, double elapsed) {
+    fprintf(stderr, "wc: %s: %d threads on %d node%s, %zu chunks, %.3f s, %.1f MB/s\n",
+            filename, nthreads, job->nnodes, job->nnodes > 1 ? "s" : "", job->nchunks,
+            elapsed, elapsed > 0 ? job->size / 1048576.0 / elapsed : 0);
+    for (int nd = 0; nd < job->nnodes; nd++) {
+        size_t threads = 0, chunks = 0, cached = 0, stolen = 0, bytes = 0;
+        double busy = 0;
+        for (int i = 0; i < nthreads; i++) {
+            const worker_t *w = &workers[i];
+            if (w->node != nd) continue;
+            threads++;
+            chunks += w->chunks;
+            cached += w->cached;
+            stolen += w->stolen;
+            bytes += w->bytes;
+            if (w->busy > busy) busy = w->busy;
+        }
+        if (!threads && !job->qlen[nd]) continue;
+        fprintf(stderr, "wc: %s: node %d: %zu threads, %zu chunks (%zu cached, %zu stolen), "
+                "%zu placed here, %.1f MB/s\n",
+                filename, nd, threads, chunks, cached, stolen, job->qlen[nd],
+                busy > 0 ? bytes / 1048576.0 / busy : 0);
+    }
+}
+
+// Count one mapped file with the worker pool and stitch the chunks together
+static int process_file_parallel(const char *filename, counts_t *c, int newline_mode) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    
+    size_t size = st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    numa_topo_t *topo = malloc(sizeof(numa_topo_t));
+    if (map == MAP_FAILED || !topo) {
+        if (map != MAP_FAILED) munmap(map, size);
+        free(topo);
+        close(fd);
+        return -1;
+    }
+    numa_topology(topo);
+    
+    parallel_job_t job = {
+        .fd = fd,
+        .map = map,
+        .size = size,
+        .nchunks = (size + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK,
+        .newline_mode = newline_mode,
+        .nnodes = topo->nnodes,
+    };
+    atomic_init(&job.failed, 0);
+    int nthreads = parallel_opts.threads < 0 ? topo->ncpus : parallel_opts.threads;
+    if ((size_t)nthreads > job.nchunks) nthreads = (int)job.nchunks;
+    if (nthreads > PROGRESS_SLOTS) nthreads = PROGRESS_SLOTS;
+    if (nthreads < 1) nthreads = 1;
+    job.chunks = calloc(job.nchunks, sizeof(chunk_t));
+    worker_t *workers = aligned_alloc(64, nthreads * sizeof(worker_t));
+    if (!job.chunks || !workers || parallel_place(&job, topo) < 0) {
+        free(job.chunks);
+        free(workers);
+        free(topo);
+        munmap(map, size);
+        close(fd);
+        return -1;
+    }
+    
+    double t0 = parallel_now();
+    int started = 0;
+    memset(workers, 0, nthreads * sizeof(worker_t));
+    for (int i = 0; i < nthreads; i++) {
+        workers[i].cpu = topo->cpu[i % topo->ncpus];
+        workers[i].node = topo->node[i % topo->ncpus];
+        workers[i].job = &job;
+        workers[i].progress = progress_slot(i);
+    }
+    for (; started < nthreads; started++) {
+        if (pthread_create(&workers[started].tid, NULL, parallel_worker, &workers[started]) != 0) break;
+    }
+    if (started == 0) {
+        // No threads to be had: count everything here, unpinned
+        workers[0].cpu = -1;
+        parallel_worker(&workers[0]);
+    }
+    for (int i = 0; i < started; i++) pthread_join(workers[i].tid, NULL);
+    double elapsed = parallel_now() - t0;
+    
+    int ret = 0;
+    if (atomic_load(&job.failed)) {
+        errno = atomic_load(&job.failed);
+        ret = -1;
+    } else {
+        int prev = -1;  // last byte of the previous chunk, -1 before the first
+        memset(c, 0, sizeof(*c));
+        for (size_t k = 0; k < job.nchunks; k++) {
+            const chunk_t *ch = &job.chunks[k];
+            int first_space = is_space_byte(ch->first);
+            int prev_space = prev < 0 || is_space_byte(prev);
+            c->lines += ch->c.lines;
+            c->words += ch->c.words - (!prev_space && !first_space);
+            c->bytes += ch->c.bytes;
+            c->eol.lf += ch->c.eol.lf;
+            c->eol.cr += ch->c.eol.cr;
+            c->eol.crlf += ch->c.eol.crlf + (newline_mode && prev == '\r' && ch->first == '\n');
+            for (int p = 0; p < patterns.count; p++) c->pat.n[p] += ch->c.pat.n[p];
+            if (k > 0 && patterns.max_len > 1) {
+                // Chunks start with no tail; SEQs across the seam are found here
+                size_t off = k * PARALLEL_CHUNK, keep = patterns.max_len - 1;
+                count_pattern_seam(job.map + off - keep, keep, job.map + off,
+                                   size - off < keep ? size - off : keep, c->pat.n);
+            }
+            prev = ch->last;
+        }
+        c->eol.prev_cr = prev == '\r';
+        if (newline_mode) c->lines = eol_lines(&c->eol, newline_mode);
+        if (parallel_opts.stats) print_parallel_stats(filename, &job, workers, nthreads, elapsed);
+    }
+    
+    free(job.queue[0]);
+    free(job.chunks);
+    free(workers);
+    free(topo);
+    munmap(map, size);
+    close(fd);
+    return ret;
+}
+
+// Process file using buffered reads for small files or stdin
+static int process_file_buffered(FILE *fp, counts_t *c, int newline_mode) {
+    uint8_t *buffer = aligned_alloc(64, BUFFER_SIZE);
+    if (!buffer) return -1;
+    
+    size_t bytes_read;
+    int in_word = 0;
+#if defined(__linux__)
+    if (io_hints.window > 0) posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    while ((bytes_read = fread(buffer, 1, BUFFER_SIZE, fp)) > 0) {
+        c->bytes += bytes_read;
+        in_word = count_span(buffer, bytes_read, c, in_word, progress_slot(0), newline_mode);
+    }
+    if (newline_mode) c->lines = eol_lines(&c->eol, newline_mode);
+    
+    free(buffer);
+    return ferror(fp) ? -1 : 0;
+}
+
+// Main wc function
+static int wc_counts(const char *filename, counts_t *c, int newline_mode) {
+    memset(c, 0, sizeof(counts_t));
+    
+    if (!filename || strcmp(filename, "-") == 0) {
+        // Read from stdin
+        return process_file_buffered(stdin, c, newline_mode);
+    }
+    
+    struct stat st;
+    if (stat(filename, &st) < 0) return -1;
+    
+    // Files with at least two chunks go to the worker pool under --threads
+    if (S_ISREG(st.st_mode) && parallel_opts.threads && st.st_size > PARALLEL_CHUNK) {
+        return process_file_parallel(filename, c, newline_mode);
+    }
+    
+    // Use mmap for regular files larger than MIN_MMAP_SIZE
+    if (S_ISREG(st.st_mode) && st.st_size >= MIN_MMAP_SIZE) {
+        return process_file_mmap(filename, c, newline_mode);
+    }
+    
+    // Use buffered I/O for small files or non-regular files
+    FILE *fp = fopen(filename, "r");
+    if (!fp) return -1;
+    
+    int ret = process_file_buffered(fp, c, newline_mode);
+    fclose(fp);
+    return ret;
+}
+
+static int wc(const char *filename, counts_t *c, int newline_mode) {
+    struct stat st;
+    int known = filename && strcmp(filename, "-") != 0 && stat(filename, &st) == 0 && S_ISREG(st.st_mode);
+    progress_begin(filename ? filename : "-", known ? (size_t)st.st_size : 0);
+    int ret = wc_counts(filename, c, newline_mode);
+    int saved = errno;
+    progress_end();
+    errno = saved;
+    return ret;
+}
+
+#ifndef RUN_TESTS
+// The classic three columns, then one per --count-bytes SEQ
+static void print_counts(const counts_t *c, const char *name) {
+    printf("%8zu %8zu %8zu", c->lines, c->words, c->bytes);
+    for (int k = 0; k < patterns.count; k++) printf(" %8zu", c->pat.n[k]);
+    if (name) printf(" %s", name);
+    putchar('\n');
+}
+
+// Report which line endings a file uses, flagging files that mix them
+static void print_line_endings(const eol_counts_t *e, const char *name) {
+    size_t bare_lf = e->lf - e->crlf;
+    size_t bare_cr = e->cr - e->crlf;
+    int kinds = (e->crlf > 0) + (bare_lf > 0) + (bare_cr > 0);
+    
+    printf("%s: %zu CRLF, %zu LF, %zu CR line endings%s\n",
+           name, e->crlf, bare_lf, bare_cr, kinds > 1 ? " (mixed)" : "");
+}
+#endif // RUN_TESTS
+
+// ============= FOLLOW MODE =============
+
+enum {
+    FOLLOW_APPEND   = 1 << 0,
+    FOLLOW_TRUNCATE = 1 << 1,
+    FOLLOW_ROTATE   = 1 << 2,
+};
+
+#define FOLLOW_POLL_MIN_MS 100  // shortest sleep when polling without inotify
+
+typedef struct {
+    double interval;   // seconds between reports, 0 = report every event
+    int ndjson;        // emit one JSON delta object per change
+    int newline_mode;  // --newline mode for the lines column
+} follow_opts_t;
+
+// One followed file. Only bytes past `offset` are ever read again, and
+// `in_word` carries the word state across the gap between appends (the
+// --count-bytes seam state rides along in counts.pat).
+typedef struct {
+    const char *path;
+    int fd;
+    int wd;
+    dev_t dev;
+    ino_t ino;
+    off_t offset;
+    int in_word;
+    int events;
+    int newline_mode;
+    counts_t counts;
+    counts_t reported;
+} follow_file_t;
+
+static void follow_reset(follow_file_t *f) {
+    f->offset = 0;
+    f->in_word = 0;
+    memset(&f->counts, 0, sizeof(counts_t));
+    memset(&f->reported, 0, sizeof(counts_t));
+}
+
+static int follow_open(follow_file_t *f) {
+    struct stat st;
+    int fd = open(f->path, O_RDONLY);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    f->fd = fd;
+    f->dev = st.st_dev;
+    f->ino = st.st_ino;
+    follow_reset(f);
+    return 0;
+}
+
+// Count everything appended since the last call
+static int follow_consume(follow_file_t *f, uint8_t *buffer) {
+    struct stat st;
+    if (fstat(f->fd, &st) < 0) return -1;
+
+    if (st.st_size < f->offset) {
+        follow_reset(f);
+        f->events |= FOLLOW_TRUNCATE;
+    }
+
+    ssize_t n;
+    while ((n = pread(f->fd, buffer, BUFFER_SIZE, f->offset)) > 0) {
+        f->offset += n;
+        f->counts.bytes += n;
+        f->in_word = count_span(buffer, n, &f->counts, f->in_word, NULL, f->newline_mode);
+        if (f->newline_mode) f->counts.lines = eol_lines(&f->counts.eol, f->newline_mode);
+        f->events |= FOLLOW_APPEND;
+    }
+    return n < 0 ? -1 : 0;
+}
+
+// Detect rename/recreate rotation: drain the old file, then switch to the new one
+static int follow_check_rotation(follow_file_t *f, uint8_t *buffer) {
+    struct stat st;
+    if (stat(f->path, &st) < 0) return 0;  // not recreated yet
+    if (st.st_dev == f->dev && st.st_ino == f->ino) return 0;
+
+    follow_consume(f, buffer);
+    close(f->fd);
+    if (follow_open(f) < 0) return -1;
+    f->events |= FOLLOW_ROTATE;
+    return 1;
+}
+
+// The follow loop itself only runs from main; the -DRUN_TESTS build
+// tests the pieces above
+#ifndef RUN_TESTS
+static volatile sig_atomic_t follow_stop = 0;
+
+static void follow_on_signal(int sig) {
+    (void)sig;
+    follow_stop = 1;
+}
+
+static void print_json_string(const char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        unsigned char ch = (unsigned char)*s;
+        if (ch == '"' || ch == '\\') printf("\\%c", ch);
+        else if (ch < 0x20) printf("\\u%04x", ch);
+        else putchar(ch);
+    }
+    putchar('"');
+}
+
+static void follow_report(follow_file_t *f, const follow_opts_t *opts) {
+    if (!f->events) return;
+
+    if (opts->ndjson) {
+        const char *event = (f->events & FOLLOW_ROTATE) ? "rotate" :
+                            (f->events & FOLLOW_TRUNCATE) ? "truncate" : "append";
+        printf("{\"file\":");
+        print_json_string(f->path);
+        printf(",\"event\":\"%s\",\"lines\":%zu,\"words\":%zu,\"bytes\":%zu,"
+               "\"delta_lines\":%zu,\"delta_words\":%zu,\"delta_bytes\":%zu",
+               event, f->counts.lines, f->counts.words, f->counts.bytes,
+               f->counts.lines - f->reported.lines,
+               f->counts.words - f->reported.words,
+               f->counts.bytes - f->reported.bytes);
+        if (patterns.count) {
+            // One total per --count-bytes SEQ, in command-line order
+            printf(",\"count_bytes\":[");
+            for (int k = 0; k < patterns.count; k++) printf("%s%zu", k ? "," : "", f->counts.pat.n[k]);
+            printf("]");
+        }
+        printf("}\n");
+    } else {
+        print_counts(&f->counts, f->path);
+    }
+    fflush(stdout);
+
+    f->reported = f->counts;
+    f->events = 0;
+}
+
+static double follow_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Keep counting appended data until SIGINT/SIGTERM. With inotify the
+// process sleeps until a watched file changes; elsewhere it polls fstat
+// once per interval, but no more often than every FOLLOW_POLL_MIN_MS.
+static int follow_files(char **paths, int nfiles, const follow_opts_t *opts) {
+    follow_file_t *files = calloc(nfiles, sizeof(follow_file_t));
+    uint8_t *buffer = aligned_alloc(64, BUFFER_SIZE);
+    if (!files || !buffer) {
+        free(files);
+        free(buffer);
+        return -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = follow_on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int ifd = -1;
+#if defined(__linux__)
+    ifd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+    int exit_code = 0;
+    for (int i = 0; i < nfiles; i++) {
+        follow_file_t *f = &files[i];
+        f->path = paths[i];
+        f->wd = -1;
+        f->newline_mode = opts->newline_mode;
+        if (follow_open(f) < 0) {
+            fprintf(stderr, "wc: %s: %s\n", f->path, strerror(errno));
+            f->fd = -1;
+            exit_code = 1;
+            continue;
+        }
+#if defined(__linux__)
+        if (ifd >= 0) {
+            f->wd = inotify_add_watch(ifd, f->path,
+                                      IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+        }
+#endif
+        follow_consume(f, buffer);
+        f->events |= FOLLOW_APPEND;
+        follow_report(f, opts);
+    }
+
+    double next_report = follow_now() + opts->interval;
+    while (!follow_stop) {
+        double wait = next_report - follow_now();
+        int timeout_ms = wait > 0 ? (int)(wait * 1000) : 0;
+        if (opts->interval == 0 && ifd >= 0) timeout_ms = 1000;
+        if (ifd < 0 && timeout_ms < FOLLOW_POLL_MIN_MS) timeout_ms = FOLLOW_POLL_MIN_MS;
+
+        int changed = 0;
+        if (ifd >= 0) {
+            struct pollfd pfd = { .fd = ifd, .events = POLLIN };
+            changed = poll(&pfd, 1, timeout_ms) > 0;
+        } else {
+            struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+            changed = 1;
+        }
+
+#if defined(__linux__)
+        if (changed && ifd >= 0) {
+            char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            ssize_t len;
+            while ((len = read(ifd, events, sizeof(events))) > 0) {
+                for (char *p = events; p < events + len;) {
+                    struct inotify_event *ev = (struct inotify_event *)p;
+                    for (int i = 0; i < nfiles; i++) {
+                        if (files[i].wd == ev->wd && (ev->mask & IN_IGNORED)) files[i].wd = -1;
+                    }
+                    p += sizeof(struct inotify_event) + ev->len;
+                }
+            }
+        }
+#endif
+
+        for (int i = 0; i < nfiles; i++) {
+            follow_file_t *f = &files[i];
+            if (f->fd < 0) continue;
+            if (changed) follow_consume(f, buffer);
+
+            int rotated = follow_check_rotation(f, buffer);
+            if (rotated > 0) {
+#if defined(__linux__)
+                if (ifd >= 0) {
+                    if (f->wd >= 0) inotify_rm_watch(ifd, f->wd);
+                    f->wd = inotify_add_watch(ifd, f->path,
+                                              IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+                }
+#endif
+                follow_consume(f, buffer);
+            } else if (rotated < 0) {
+                fprintf(stderr, "wc: %s: %s\n", f->path, strerror(errno));
+                f->fd = -1;
+                exit_code = 1;
+            }
+        }
+
+        if (follow_now() >= next_report) {
+            for (int i = 0; i < nfiles; i++) follow_report(&files[i], opts);
+            next_report = follow_now() + opts->interval;
+        }
+    }
+
+    for (int i = 0; i < nfiles; i++) {
+        follow_report(&files[i], opts);
+        if (files[i].fd >= 0) close(files[i].fd);
+    }
+    if (ifd >= 0) close(ifd);
+    free(buffer);
+    free(files);
+    return exit_code;
+}
+#endif // RUN_TESTS
+
+// ============= SERVER MODE =============
+
+// --serve=SOCKET keeps a pool of threads, each with its own preallocated
+// read buffer, blocked in accept() on a Unix socket, so a request pays
+// neither process startup nor buffer allocation. The protocol is one line
+// per request, answered before the next one is read:
+//
+//   "F\n"           count the one descriptor passed alongside with SCM_RIGHTS
+//   "P <path>\n"    count the file at <path>, resolved by the server
+//
+// Only regular files are counted; anything else is answered with an error.
+//   reply           "<lines> <words> <bytes>\n" or "E <message>\n"
+//
+// --client=SOCKET is the thin client: it opens each file itself and passes
+// the descriptor, so the server never sees the client's paths or cwd.
+#define SERVE_MAX_REQUEST 4200  // "P " + PATH_MAX + newline
+#define SERVE_MAX_REPLY 256     // three counts and one per --count-bytes SEQ
+#define SERVE_MAX_FDS 8           // descriptors taken per message; more is an error
+
+typedef struct {
+    int listen_fd;
+    int nthreads;
+    int newline_mode;
+    pthread_t *threads;
+    pthread_mutex_t lock;     // guards conns and stopping
+    int *conns;               // connection each worker is serving, or -1
+    int stopping;
+    struct serve_worker *workers;
+} server_t;
+
+typedef struct serve_worker {
+    server_t *server;
+    int slot;
+} serve_worker_t;
+
+// Count whatever an open descriptor refers to, reading into `buffer`
+static int process_fd(int fd, uint8_t *buffer, counts_t *c, int newline_mode) {
+    struct stat st;
+    memset(c, 0, sizeof(counts_t));
+    if (fstat(fd, &st) < 0) return -1;
+    if (S_ISREG(st.st_mode) && st.st_size >= MIN_MMAP_SIZE) return process_fd_mmap(fd, c, newline_mode);
+    
+    ssize_t n;
+    int in_word = 0;
+    while ((n = read(fd, buffer, BUFFER_SIZE)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        c->bytes += n;
+        in_word = count_span(buffer, n, c, in_word, NULL, newline_mode);
+    }
+    if (newline_mode) c->lines = eol_lines(&c->eol, newline_mode);
+    return 0;
+}
+
+// Workers are shared by every client, so they only count regular files:
+// a pipe, FIFO or terminal could hold a worker until its writer goes away.
+// Returns -2 for those, -1 with errno on a read error.
+static int serve_count(int fd, uint8_t *buffer, counts_t *c, int newline_mode) {
+    struct stat st;
+    if (fstat(fd, &st) < 0) return -1;
+    if (!S_ISREG(st.st_mode)) return -2;
+    return process_fd(fd, buffer, c, newline_mode);
+}
+
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Receive one request line and the descriptors sent with it. The first
+// descriptor is kept in *fd and any others are closed; *nfds counts them
+// all, plus one if the kernel had to drop some that did not fit.
+static ssize_t recv_request(int sock, char *req, size_t cap, int *fd, int *nfds) {
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(SERVE_MAX_FDS * sizeof(int))];
+    } control;
+    size_t len = 0;
+    *fd = -1;
+    *nfds = 0;
+    
+    while (len == 0 || req[len - 1] != '\n') {
+        struct iovec iov = { req + len, cap - 1 - len };
+        struct msghdr msg = {
+            .msg_iov = &iov, .msg_iovlen = 1,
+            .msg_control = control.buf, .msg_controllen = sizeof(control.buf),
+        };
+        ssize_t n = recvmsg(sock, &msg, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        if (msg.msg_flags & MSG_CTRUNC) (*nfds)++;
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+            size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; i++) {
+                int d;
+                memcpy(&d, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+                if (*fd < 0) *fd = d;
+                else close(d);
+                (*nfds)++;
+            }
+        }
+        len += n;
+        if (len == cap - 1) break;
+    }
+    req[len] = '\0';
+    return len;
+}
+
+static void serve_connection(int sock, uint8_t *buffer, int newline_mode) {
+    char req[SERVE_MAX_REQUEST], reply[SERVE_MAX_REPLY];
+    int fd, nfds;
+    
+    while (recv_request(sock, req, sizeof(req), &fd, &nfds) > 0) {
+        counts_t c;
+        int ret = -1;
+        char *nl = strchr(req, '\n');
+        if (nl) *nl = '\0';
+        
+        if (nfds > 1) {
+            errno = EINVAL;  // which one to count is ambiguous
+        } else if (strcmp(req, "F") == 0 && fd >= 0) {
+            ret = serve_count(fd, buffer, &c, newline_mode);
+        } else if (strncmp(req, "P ", 2) == 0) {
+            // O_NONBLOCK so a FIFO path cannot park the worker in open()
+            int pfd = open(req + 2, O_RDONLY | O_NONBLOCK);
+            if (pfd >= 0) {
+                ret = serve_count(pfd, buffer, &c, newline_mode);
+                close(pfd);
+            }
+        } else {
+            errno = EINVAL;
+        }
+        
+        if (ret == 0) {
+            // The server's own --count-bytes set, one column per SEQ
+            int len = snprintf(reply, sizeof(reply), "%zu %zu %zu", c.lines, c.words, c.bytes);
+            for (int k = 0; k < patterns.count; k++) {
+                len += snprintf(reply + len, sizeof(reply) - len, " %zu", c.pat.n[k]);
+            }
+            snprintf(reply + len, sizeof(reply) - len, "\n");
+        } else if (ret == -2) snprintf(reply, sizeof(reply), "E not a regular file\n");
+        else snprintf(reply, sizeof(reply), "E %s\n", strerror(errno));
+        if (fd >= 0) close(fd);
+        if (write_all(sock, reply, strlen(reply)) < 0) break;
+    }
+}
+
+// Each worker publishes the connection it is serving, so shutdown can
+// wake it out of recvmsg() on a client that keeps the connection idle
+static void *serve_worker(void *arg) {
+    serve_worker_t *w = arg;
+    server_t *s = w->server;
+    uint8_t *buffer = aligned_alloc(64, BUFFER_SIZE);
+    if (!buffer) return NULL;
+    
+    for (;;) {
+        int conn = accept(s->listen_fd, NULL, NULL);
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;  // listening socket shut down
+        }
+        pthread_mutex_lock(&s->lock);
+        int stopping = s->stopping;
+        if (!stopping) s->conns[w->slot] = conn;
+        pthread_mutex_unlock(&s->lock);
+        
+        if (!stopping) serve_connection(conn, buffer, s->newline_mode);
+        pthread_mutex_lock(&s->lock);
+        s->conns[w->slot] = -1;
+        pthread_mutex_unlock(&s->lock);
+        close(conn);
+        if (stopping) break;
+    }
+    free(buffer);
+    return NULL;
+}
+
+static int serve_start(server_t *s, const char *path, int nthreads, int newline_mode) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    
+    s->newline_mode = newline_mode;
+    s->stopping = 0;
+    
+    // Replace a stale socket from an earlier run, but nothing else
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(path);
+    }
+    s->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) return -1;
+    if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(s->listen_fd, 128) < 0) {
+        close(s->listen_fd);
+        return -1;
+    }
+    
+    signal(SIGPIPE, SIG_IGN);  // clients may hang up before the reply
+    s->threads = calloc(nthreads, sizeof(pthread_t));
+    s->conns = malloc(nthreads * sizeof(int));
+    serve_worker_t *workers = malloc(nthreads * sizeof(serve_worker_t));
+    if (!s->threads || !s->conns || !workers) {
+        free(s->threads);
+        free(s->conns);
+        free(workers);
+        close(s->listen_fd);
+        return -1;
+    }
+    pthread_mutex_init(&s->lock, NULL);
+    for (int i = 0; i < nthreads; i++) {
+        s->conns[i] = -1;
+        workers[i] = (serve_worker_t){ s, i };
+    }
+    s->workers = workers;
+    for (s->nthreads = 0; s->nthreads < nthreads; s->nthreads++) {
+        if (pthread_create(&s->threads[s->nthreads], NULL, serve_worker, &workers[s->nthreads]) != 0) break;
+    }
+    if (s->nthreads == 0) {
+        pthread_mutex_destroy(&s->lock);
+        free(s->threads);
+        free(s->conns);
+        free(workers);
+        close(s->listen_fd);
+        return -1;
+    }
+    return 0;
+}
+
+// Wake every worker out of accept(), and out of recvmsg() on connections
+// whose clients are idle, then wait for them to finish
+static void serve_shutdown(server_t *s, const char *path) {
+    pthread_mutex_lock(&s->lock);
+    s->stopping = 1;
+    for (int i = 0; i < s->nthreads; i++) {
+        if (s->conns[i] >= 0) shutdown(s->conns[i], SHUT_RDWR);
+    }
+    pthread_mutex_unlock(&s->lock);
+    shutdown(s->listen_fd, SHUT_RDWR);
+    close(s->listen_fd);
+    for (int i = 0; i < s->nthreads; i++) pthread_join(s->threads[i], NULL);
+    pthread_mutex_destroy(&s->lock);
+    free(s->threads);
+    free(s->conns);
+    free(s->workers);
+    unlink(path);
+}
+
+#ifndef RUN_TESTS
+static int serve_main(const char *path, int nthreads, int newline_mode) {
+    // Blocked before the workers start so they inherit the mask and the
+    // signals are only ever taken by sigwait() below
+    sigset_t stop;
+    sigemptyset(&stop);
+    sigaddset(&stop, SIGINT);
+    sigaddset(&stop, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop, NULL);
     
-    size_t bytes_read;
-    while ((bytes_read = fread(buffer, 1, BUFFER_SIZE, fp)) > 0) {
-        c->bytes += bytes_read;
-        count_words_and_lines(buffer, bytes_read, c);
+    server_t s;
+    if (serve_start(&s, path, nthreads, newline_mode) < 0) {
+        fprintf(stderr, "wc: %s: %s\n", path, strerror(errno));
+        return 1;
     }
+    fprintf(stderr, "wc: serving on %s with %d threads\n", path, s.nthreads);
     
-    free(buffer);
-    return ferror(fp) ? -1 : 0;
+    int sig;
+    while (sigwait(&stop, &sig) != 0) {}
+    serve_shutdown(&s, path);
+    return 0;
 }
+#endif // RUN_TESTS
 
-// Main wc function
-static int wc(const char *filename, counts_t *c) {
-    memset(c, 0, sizeof(counts_t));
-    
-    if (!filename || strcmp(filename, "-") == 0) {
-        // Read from stdin
-        return process_file_buffered(stdin, c);
+static int client_connect(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) return -1;
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        int saved = errno;
+        close(sock);
+        errno = saved;
+        return -1;
     }
+    return sock;
+}
+
+// Pass `fd` to the server and read back its counts, with the number of
+// --count-bytes columns the server added in *npat. Returns 1 with the
+// server's message in err if it could not count the file.
+static int client_request(int sock, int fd, counts_t *c, int *npat, char *err, size_t errlen) {
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    char req[] = "F\n";
+    struct iovec iov = { req, 2 };
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control.buf, .msg_controllen = sizeof(control.buf),
+    };
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cm), &fd, sizeof(int));
     
-    struct stat st;
-    if (stat(filename, &st) < 0) return -1;
+    ssize_t n;
+    while ((n = sendmsg(sock, &msg, 0)) < 0 && errno == EINTR) {}
+    if (n != 2) return -1;
     
-    // Use mmap for regular files larger than MIN_MMAP_SIZE
-    if (S_ISREG(st.st_mode) && st.st_size >= MIN_MMAP_SIZE) {
-        return process_file_mmap(filename, c);
+    char reply[SERVE_MAX_REPLY];
+    size_t len = 0;
+    while (len == 0 || reply[len - 1] != '\n') {
+        n = read(sock, reply + len, sizeof(reply) - 1 - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0 || (len += n) == sizeof(reply) - 1) return -1;
     }
+    reply[len - 1] = '\0';
     
-    // Use buffered I/O for small files or non-regular files
-    FILE *fp = fopen(filename, "r");
-    if (!fp) return -1;
+    memset(c, 0, sizeof(counts_t));
+    if (reply[0] == 'E') {
+        snprintf(err, errlen, "%s", reply + 2);
+        return 1;
+    }
+    int used, k = 0;
+    const char *p = reply;
+    if (sscanf(p, "%zu %zu %zu%n", &c->lines, &c->words, &c->bytes, &used) != 3) return -1;
+    for (p += used; k < PATTERN_MAX && sscanf(p, "%zu%n", &c->pat.n[k], &used) == 1; k++) p += used;
+    *npat = k;
+    return 0;
+}
+
+#ifndef RUN_TESTS
+// Same output as a local run, with the counting done by the server
+static int client_main(const char *path, char **files, int nfiles) {
+    int sock = client_connect(path);
+    if (sock < 0) {
+        fprintf(stderr, "wc: %s: %s\n", path, strerror(errno));
+        return 1;
+    }
     
-    int ret = process_file_buffered(fp, c);
-    fclose(fp);
-    return ret;
+    counts_t total = {0};
+    int exit_code = 0, counted = 0, npat = 0;
+    char err[SERVE_MAX_REPLY];
+    for (int i = 0; i < (nfiles ? nfiles : 1); i++) {
+        const char *name = nfiles ? files[i] : NULL;
+        int fd = !name || strcmp(name, "-") == 0 ? STDIN_FILENO : open(name, O_RDONLY);
+        if (fd < 0) {
+            fprintf(stderr, "wc: %s: %s\n", name, strerror(errno));
+            exit_code = 1;
+            continue;
+        }
+        
+        counts_t c;
+        int ret = client_request(sock, fd, &c, &npat, err, sizeof(err));
+        if (fd != STDIN_FILENO) close(fd);
+        if (ret < 0) {
+            fprintf(stderr, "wc: %s: lost connection to server\n", path);
+            close(sock);
+            return 1;
+        }
+        if (ret > 0) {
+            fprintf(stderr, "wc: %s: %s\n", name ? name : "-", err);
+            exit_code = 1;
+            continue;
+        }
+        
+        printf("%8zu %8zu %8zu", c.lines, c.words, c.bytes);
+        for (int k = 0; k < npat; k++) printf(" %8zu", c.pat.n[k]);
+        if (name) printf(" %s", name);
+        putchar('\n');
+        total.lines += c.lines;
+        total.words += c.words;
+        total.bytes += c.bytes;
+        for (int k = 0; k < npat; k++) total.pat.n[k] += c.pat.n[k];
+        counted++;
+    }
+    if (counted > 1) {
+        printf("%8zu %8zu %8zu", total.lines, total.words, total.bytes);
+        for (int k = 0; k < npat; k++) printf(" %8zu", total.pat.n[k]);
+        printf(" total\n");
+    }
+    close(sock);
+    return exit_code;
 }
+#endif // RUN_TESTS
 
 // ============= UNIT TESTS =============
 #ifdef RUN_TESTS
 
+// Byte-at-a-time word and line count, the reference for the vector path
+static int count_words_scalar_ref(const uint8_t *data, size_t len, counts_t *c) {
+    int in_word = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t ch = data[i];
+        if (ch == '\n') c->lines++;
+        int is_space = (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r');
+        if (!in_word && !is_space) c->words++;
+        in_word = !is_space;
+    }
+    return in_word;
+}
+
+#if defined(__ARM_NEON)
+// The previous newline kernel: one across-vector reduction per block
+static size_t count_newlines_reduce_each(const uint8_t *data, size_t len) {
+    const uint8x16_t nl_vec = vdupq_n_u8('\n');
+    size_t count = 0;
+    for (; len >= 16; data += 16, len -= 16) {
+        count += vaddvq_u8(vshrq_n_u8(vceqq_u8(vld1q_u8(data), nl_vec), 7));
+    }
+    while (len--) count += *data++ == '\n';
+    return count;
+}
+#endif
+
 static void test_newline_counter() {
     printf("Testing NEON newline counter...\n");
     
@@ -200,49 +2211,171 @@ static void test_newline_counter() {
     char large[200];
     memset(large, 'a', sizeof(large));
     for (int i = 10; i < 200; i += 20) large[i] = '\n';
-    assert(count_newlines_neon((uint8_t*)large, sizeof(large)) == 9);
+    assert(count_newlines_neon((uint8_t*)large, sizeof(large)) == 10);
+    
+    // All newlines, past the 255-round widening point, at odd lengths
+    static uint8_t nl[64 * 600 + 37];
+    memset(nl, '\n', sizeof(nl));
+    for (size_t len = sizeof(nl) - 80; len <= sizeof(nl); len++) {
+        assert(count_newlines_neon(nl, len) == len);
+    }
     
     printf("✓ Newline counter tests passed\n");
 }
 
-static void test_word_counting() {
-    printf("Testing word counting...\n");
-    
+// Run a kernel test once per word/line kernel this CPU supports
+static void for_each_words_kernel(void (*check)(void)) {
+    const words_kernel_t *best = words_kernel();
+    for (size_t k = 0; k < WORDS_KERNELS; k++) {
+        if (!words_kernels[k].supported()) continue;
+        printf("  kernel %s\n", words_kernels[k].name);
+        words_kernel_active = &words_kernels[k];
+        check();
+    }
+    words_kernel_active = best;
+}
+
+static void check_word_counting(void) {
     counts_t c;
     
     // Test empty
     memset(&c, 0, sizeof(c));
-    count_words_and_lines((uint8_t*)"", 0, &c);
+    count_words_and_lines((uint8_t*)"", 0, &c, 0);
     assert(c.words == 0 && c.lines == 0);
     
     // Test single word
     memset(&c, 0, sizeof(c));
-    count_words_and_lines((uint8_t*)"hello", 5, &c);
+    count_words_and_lines((uint8_t*)"hello", 5, &c, 0);
     assert(c.words == 1 && c.lines == 0);
     
     // Test multiple words
     memset(&c, 0, sizeof(c));
-    count_words_and_lines((uint8_t*)"hello world test", 16, &c);
+    count_words_and_lines((uint8_t*)"hello world test", 16, &c, 0);
     assert(c.words == 3 && c.lines == 0);
     
     // Test with newlines
     memset(&c, 0, sizeof(c));
-    count_words_and_lines((uint8_t*)"hello\nworld\n", 12, &c);
+    count_words_and_lines((uint8_t*)"hello\nworld\n", 12, &c, 0);
     assert(c.words == 2 && c.lines == 2);
     
     // Test multiple spaces
     memset(&c, 0, sizeof(c));
-    count_words_and_lines((uint8_t*)"hello   world", 13, &c);
+    count_words_and_lines((uint8_t*)"hello   world", 13, &c, 0);
     assert(c.words == 2);
     
     // Test tabs
     memset(&c, 0, sizeof(c));
-    count_words_and_lines((uint8_t*)"hello\tworld\ttesting", 19, &c);
+    count_words_and_lines((uint8_t*)"hello\tworld\ttesting", 19, &c, 0);
+    assert(c.words == 3);
+
+    // Vertical tab and form feed separate words too, as in wc(1)
+    memset(&c, 0, sizeof(c));
+    count_words_and_lines((uint8_t*)"page\fbreak\vtab", 15, &c, 0);
     assert(c.words == 3);
+
+    // Test word split across two buffers
+    memset(&c, 0, sizeof(c));
+    int in_word = count_words_and_lines((uint8_t*)"hel", 3, &c, 0);
+    count_words_and_lines((uint8_t*)"lo world", 8, &c, in_word);
+    assert(c.words == 2);
+
+    // Long random input against a byte-at-a-time reference, split anywhere
+    static uint8_t text[64 * 600 + 51];
+    const char alphabet[] = "ab \t\n\rxy\v\f";
+    srand(1);
+    for (size_t i = 0; i < sizeof(text); i++) text[i] = alphabet[rand() % 10];
+    counts_t ref;
+    memset(&ref, 0, sizeof(ref));
+    count_words_scalar_ref(text, sizeof(text), &ref);
+    for (size_t split = 0; split < sizeof(text); split += 997) {
+        memset(&c, 0, sizeof(c));
+        in_word = count_words_and_lines(text, split, &c, 0);
+        count_words_and_lines(text + split, sizeof(text) - split, &c, in_word);
+        assert(c.lines == ref.lines && c.words == ref.words);
+    }
     
+    // Every start offset and length around the vector widths
+    for (size_t off = 0; off < 70; off++) {
+        for (size_t len = 0; len < 200; len++) {
+            memset(&c, 0, sizeof(c));
+            memset(&ref, 0, sizeof(ref));
+            count_words_and_lines(text + off, len, &c, 0);
+            count_words_scalar_ref(text + off, len, &ref);
+            assert(c.lines == ref.lines && c.words == ref.words);
+        }
+    }
+}
+
+static void test_word_counting() {
+    printf("Testing word counting...\n");
+    for_each_words_kernel(check_word_counting);
     printf("✓ Word counting tests passed\n");
 }
 
+static void check_line_endings(void) {
+    // Bare \n, \r\n, bare \r, and a trailing \r
+    const char *mixed = "a\nb\r\nc\rd\r";
+    counts_t c;
+    memset(&c, 0, sizeof(c));
+    count_words_and_endings((const uint8_t*)mixed, strlen(mixed), &c, 0);
+    eol_counts_t e = c.eol;
+    assert(e.lf == 2 && e.cr == 3 && e.crlf == 1);
+    assert(c.lines == 2 && c.words == 4);
+    assert(eol_lines(&e, NEWLINE_LF) == 2);
+    assert(eol_lines(&e, NEWLINE_CRLF) == 1);
+    assert(eol_lines(&e, NEWLINE_CR) == 3);
+    assert(eol_lines(&e, NEWLINE_ANY) == 4);
+    
+    // A \r\n split across buffers is still one pair, whatever the split
+    char buf[5000];
+    for (size_t i = 0; i < sizeof(buf); i += 2) {
+        buf[i] = '\r';
+        buf[i + 1] = '\n';
+    }
+    for (size_t split = 0; split < 140; split++) {
+        memset(&c, 0, sizeof(c));
+        count_words_and_endings((const uint8_t*)buf, split, &c, 0);
+        count_words_and_endings((const uint8_t*)buf + split, sizeof(buf) - split, &c, 0);
+        e = c.eol;
+        assert(e.crlf == sizeof(buf) / 2 && e.lf == e.crlf && e.cr == e.crlf);
+        assert(eol_lines(&e, NEWLINE_ANY) == sizeof(buf) / 2);
+    }
+    
+    // Random endings against a byte-at-a-time count, words and lines included
+    static char noisy[64 * 70 + 13];
+    srand(30);
+    for (size_t i = 0; i < sizeof(noisy); i++) noisy[i] = "ab \r\n\r\n"[rand() % 7];
+    size_t lf = 0, cr = 0, crlf = 0;
+    for (size_t i = 0; i < sizeof(noisy); i++) {
+        lf += noisy[i] == '\n';
+        cr += noisy[i] == '\r';
+        crlf += i > 0 && noisy[i] == '\n' && noisy[i - 1] == '\r';
+    }
+    for (size_t split = 0; split < sizeof(noisy); split += 61) {
+        counts_t plain;
+        memset(&c, 0, sizeof(c));
+        memset(&plain, 0, sizeof(plain));
+        int in_word = count_words_and_endings((const uint8_t*)noisy, split, &c, 0);
+        count_words_and_endings((const uint8_t*)noisy + split, sizeof(noisy) - split, &c, in_word);
+        count_words_and_lines((const uint8_t*)noisy, sizeof(noisy), &plain, 0);
+        assert(c.eol.lf == lf && c.eol.cr == cr && c.eol.crlf == crlf);
+        assert(c.lines == plain.lines && c.words == plain.words);
+    }
+    
+    // More than 255 SIMD rounds of matches
+    static char bare[64 * 600];
+    memset(bare, '\r', sizeof(bare));
+    memset(&c, 0, sizeof(c));
+    count_words_and_endings((const uint8_t*)bare, sizeof(bare), &c, 0);
+    assert(c.eol.cr == sizeof(bare) && c.eol.crlf == 0 && c.eol.prev_cr);
+}
+
+static void test_line_endings() {
+    printf("Testing line-ending counter...\n");
+    for_each_words_kernel(check_line_endings);
+    printf("✓ Line-ending tests passed\n");
+}
+
 static void create_test_file(const char *filename, const char *content) {
     FILE *fp = fopen(filename, "w");
     assert(fp != NULL);
@@ -250,6 +2383,22 @@ static void create_test_file(const char *filename, const char *content) {
     fclose(fp);
 }
 
+// Occurrences of SEQ at every start position, the reference for --count-bytes
+static size_t count_pattern_ref(const uint8_t *data, size_t len, const uint8_t *seq, size_t m) {
+    size_t count = 0;
+    for (size_t i = 0; i + m <= len; i++) count += memcmp(data + i, seq, m) == 0;
+    return count;
+}
+
+static void set_patterns(const char **seqs, int n) {
+    memset(&patterns, 0, sizeof(patterns));
+    for (int k = 0; k < n; k++) {
+        assert(parse_pattern(seqs[k], patterns.seq[k], &patterns.len[k]) == 0);
+        if (patterns.len[k] > patterns.max_len) patterns.max_len = patterns.len[k];
+    }
+    patterns.count = n;
+}
+
 static void test_integration() {
     printf("Testing integration...\n");
     
@@ -257,34 +2406,689 @@ static void test_integration() {
     
     // Test empty file
     create_test_file("test_empty.txt", "");
-    assert(wc("test_empty.txt", &c) == 0);
+    assert(wc("test_empty.txt", &c, NEWLINE_DEFAULT) == 0);
     assert(c.lines == 0 && c.words == 0 && c.bytes == 0);
     unlink("test_empty.txt");
     
     // Test simple file
     create_test_file("test_simple.txt", "Hello world\n");
-    assert(wc("test_simple.txt", &c) == 0);
+    assert(wc("test_simple.txt", &c, NEWLINE_DEFAULT) == 0);
     assert(c.lines == 1 && c.words == 2 && c.bytes == 12);
     unlink("test_simple.txt");
     
     // Test file without final newline
     create_test_file("test_no_nl.txt", "Hello world");
-    assert(wc("test_no_nl.txt", &c) == 0);
+    assert(wc("test_no_nl.txt", &c, NEWLINE_DEFAULT) == 0);
     assert(c.lines == 0 && c.words == 2 && c.bytes == 11);
     unlink("test_no_nl.txt");
     
     // Test multi-line file
     create_test_file("test_multi.txt", "Line 1\nLine 2\nLine 3\n");
-    assert(wc("test_multi.txt", &c) == 0);
+    assert(wc("test_multi.txt", &c, NEWLINE_DEFAULT) == 0);
     assert(c.lines == 3 && c.words == 6 && c.bytes == 21);
     unlink("test_multi.txt");
     
+    // Test Windows line endings
+    create_test_file("test_crlf.txt", "Line 1\r\nLine 2\r\nLine 3\r");
+    assert(wc("test_crlf.txt", &c, NEWLINE_CRLF) == 0);
+    assert(c.lines == 2 && c.words == 6 && c.bytes == 23);
+    assert(wc("test_crlf.txt", &c, NEWLINE_ANY) == 0);
+    assert(c.lines == 3);
+    unlink("test_crlf.txt");
+    
     // Test non-existent file
-    assert(wc("non_existent_file.txt", &c) == -1);
+    assert(wc("non_existent_file.txt", &c, NEWLINE_DEFAULT) == -1);
     
     printf("✓ Integration tests passed\n");
 }
 
+static void test_follow_incremental() {
+    printf("Testing follow mode incremental counting...\n");
+    
+    uint8_t *buffer = aligned_alloc(64, BUFFER_SIZE);
+    assert(buffer != NULL);
+    follow_file_t f;
+    memset(&f, 0, sizeof(f));
+    f.path = "test_follow.txt";
+    
+    create_test_file(f.path, "Hello wor");
+    assert(follow_open(&f) == 0);
+    assert(follow_consume(&f, buffer) == 0);
+    assert(f.counts.lines == 0 && f.counts.words == 2 && f.counts.bytes == 9);
+    
+    // Appending the rest of a word must not count it twice
+    FILE *fp = fopen(f.path, "a");
+    fputs("ld\nagain\n", fp);
+    fclose(fp);
+    assert(follow_consume(&f, buffer) == 0);
+    assert(f.counts.lines == 2 && f.counts.words == 3 && f.counts.bytes == 18);
+    
+    // Truncation restarts the count from the new contents
+    create_test_file(f.path, "x\n");
+    assert(follow_consume(&f, buffer) == 0);
+    assert(f.events & FOLLOW_TRUNCATE);
+    assert(f.counts.lines == 1 && f.counts.words == 1 && f.counts.bytes == 2);
+    
+    // Rotation: the path now names a different file
+    rename(f.path, "test_follow.txt.1");
+    create_test_file(f.path, "new file\n");
+    assert(follow_check_rotation(&f, buffer) == 1);
+    assert(follow_consume(&f, buffer) == 0);
+    assert(f.counts.lines == 1 && f.counts.words == 2 && f.counts.bytes == 9);
+    close(f.fd);
+    
+    // --count-bytes columns follow appends, with a \r\n split between two
+    const char *seqs[] = { "\\r\\n", "," };
+    set_patterns(seqs, 2);
+    create_test_file(f.path, "a,b\r");
+    assert(follow_open(&f) == 0);
+    assert(follow_consume(&f, buffer) == 0);
+    assert(f.counts.pat.n[0] == 0 && f.counts.pat.n[1] == 1);
+    fp = fopen(f.path, "a");
+    fputs("\nc,d\r\n", fp);
+    fclose(fp);
+    assert(follow_consume(&f, buffer) == 0);
+    assert(f.counts.pat.n[0] == 2 && f.counts.pat.n[1] == 2);
+    memset(&patterns, 0, sizeof(patterns));
+    
+    close(f.fd);
+    unlink(f.path);
+    unlink("test_follow.txt.1");
+    free(buffer);
+    printf("✓ Follow mode tests passed\n");
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// This thread's user-mode CPU cycles from perf_event_open, or -1 where
+// there is no cycle counter (macOS, VMs without a PMU, perf_event_paranoid)
+static int cycle_counter_open() {
+#if defined(__linux__)
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static double cycle_counter_read(int fd) {
+    uint64_t cycles;
+    return fd >= 0 && read(fd, &cycles, sizeof(cycles)) == sizeof(cycles) ? (double)cycles : -1;
+}
+
+// In-cache kernel throughput before and after the deferred reduction.
+// Bytes/cycle is only printed when the cycles can be measured; without
+// NEON each word/line kernel the CPU runs gets its own rows, and the
+// newline kernel falls back to a scalar loop and is labelled as such.
+static void run_kernel_benchmark() {
+    const size_t size = 256 * 1024;
+    const int iterations = 2000;
+    int cycles_fd = cycle_counter_open();
+    
+    uint8_t *data = aligned_alloc(64, size);
+    assert(data != NULL);
+    const char *line = "The quick brown fox jumps over the lazy dog. Testing performance here.\n";
+    for (size_t i = 0; i < size; i++) data[i] = line[i % strlen(line)];
+    
+    printf("\nKernel microbenchmark (%zuKB in cache, %s):\n", size / 1024,
+           cycles_fd >= 0 ? "cycles from perf_event_open" : "no cycle counter, GB/s only");
+    
+#define BENCH(label, expr) do {                                             \
+        volatile size_t sink = 0;                                           \
+        double c0 = cycle_counter_read(cycles_fd);                          \
+        double t0 = now_ns();                                               \
+        for (int it = 0; it < iterations; it++) sink += (expr);             \
+        double ns = (now_ns() - t0) / iterations;                           \
+        double cycles = (cycle_counter_read(cycles_fd) - c0) / iterations;  \
+        printf("  %-40s %6.2f GB/s", label, size / ns);                     \
+        if (cycles_fd >= 0 && cycles > 0)                                   \
+            printf(" %6.2f bytes/cycle", size / cycles);                    \
+        printf("\n");                                                       \
+        (void)sink;                                                         \
+    } while (0)
+    
+    counts_t c;
+#if defined(__ARM_NEON)
+    BENCH("newlines, reduce per block (before)", count_newlines_reduce_each(data, size));
+    BENCH("newlines, deferred reduction", count_newlines_neon(data, size));
+    BENCH("words+lines, scalar (before)",
+          (memset(&c, 0, sizeof(c)), count_words_scalar_ref(data, size, &c), c.words));
+    BENCH("words+lines, deferred reduction",
+          (memset(&c, 0, sizeof(c)), count_words_and_lines(data, size, &c, 0), c.words));
+    BENCH("words+lines+endings, deferred reduction",
+          (memset(&c, 0, sizeof(c)), count_words_and_endings(data, size, &c, 0), c.words));
+#else
+    BENCH("newlines, scalar fallback (no NEON)", count_newlines_neon(data, size));
+    BENCH("words+lines, scalar reference",
+          (memset(&c, 0, sizeof(c)), count_words_scalar_ref(data, size, &c), c.words));
+    // Every word/line kernel this CPU runs; "scalar" is the no-SIMD fallback
+    for (size_t k = 0; k < WORDS_KERNELS; k++) {
+        const words_kernel_t *kern = &words_kernels[k];
+        char label[64];
+        if (!kern->supported()) continue;
+        snprintf(label, sizeof(label), "words+lines, %s", kern->name);
+        BENCH(label, (memset(&c, 0, sizeof(c)), kern->lines(data, size, &c, 0), c.words));
+        snprintf(label, sizeof(label), "words+lines+endings, %s", kern->name);
+        BENCH(label, (memset(&c, 0, sizeof(c)), kern->endings(data, size, &c, 0), c.words));
+    }
+#endif
+#undef BENCH
+    
+    if (cycles_fd >= 0) close(cycles_fd);
+    free(data);
+}
+
+// Fraction of a file's pages currently in the page cache
+static double resident_fraction(const char *path) {
+    int fd = open(path, O_RDONLY);
+    assert(fd >= 0);
+    struct stat st;
+    fstat(fd, &st);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t npages = (st.st_size + page - 1) / page;
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    mincore_vec_t *vec = malloc(npages);
+    assert(map != MAP_FAILED && vec != NULL);
+    assert(mincore(map, st.st_size, vec) == 0);
+    
+    size_t resident = 0;
+    for (size_t i = 0; i < npages; i++) resident += vec[i] & 1;
+    free(vec);
+    munmap(map, st.st_size);
+    close(fd);
+    return (double)resident / npages;
+}
+
+// Push a file out of the page cache without root (no drop_caches)
+static int evict_file(const char *path) {
+#if defined(__linux__)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    fdatasync(fd);
+    int ret = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    return ret;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+static void test_readahead_hints() {
+    printf("Testing read-ahead hints and drop-behind...\n");
+    
+    const char *path = "test_readahead.txt";
+    const size_t size = 64 * 1024 * 1024;
+    FILE *fp = fopen(path, "w");
+    assert(fp != NULL);
+    for (size_t j = 0; j < size; j += 80) {
+        fprintf(fp, "The quick brown fox jumps over the lazy dog. Testing performance here.\n");
+    }
+    fclose(fp);
+    
+    io_hints_t saved = io_hints;
+    counts_t plain, hinted;
+    io_hints.window = 0;
+    assert(wc(path, &plain, NEWLINE_DEFAULT) == 0);
+    
+    // Windowed counting gives the same answer as one pass, even with a
+    // window that does not divide the file
+    io_hints.window = 1000 * 1000;
+    io_hints.drop_behind = 1;
+    assert(wc(path, &hinted, NEWLINE_ANY) == 0);
+    assert(hinted.lines == plain.lines && hinted.words == plain.words);
+    assert(hinted.bytes == plain.bytes);
+    
+    // A file that was already cached must stay cached
+    double before = resident_fraction(path);
+    assert(wc(path, &hinted, NEWLINE_DEFAULT) == 0);
+    double after = resident_fraction(path);
+    assert(after >= before - 0.01);
+    
+    // Cold-cache benchmark: same file evicted before each run
+    if (evict_file(path) == 0 && resident_fraction(path) < 0.05) {
+        const struct { const char *name; size_t window; int drop; } modes[] = {
+            { "no hints (madvise only)", 0, 0 },
+            { "8MB readahead window", READAHEAD_WINDOW, 0 },
+            { "8MB window + drop-behind", READAHEAD_WINDOW, 1 },
+        };
+        printf("  Cold-cache read of %zuMB:\n", size >> 20);
+        for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+            io_hints.window = modes[m].window;
+            io_hints.drop_behind = modes[m].drop;
+            evict_file(path);
+            double t0 = now_ns();
+            assert(wc(path, &hinted, NEWLINE_DEFAULT) == 0);
+            double ms = (now_ns() - t0) / 1e6;
+            printf("    %-26s %8.1f ms %7.1f MB/s, %3.0f%% left in page cache\n",
+                   modes[m].name, ms, (size >> 20) / (ms / 1000), resident_fraction(path) * 100);
+        }
+    } else {
+        printf("  Cold-cache benchmark skipped (cannot evict pages here)\n");
+    }
+    
+    io_hints = saved;
+    unlink(path);
+    printf("✓ Read-ahead tests passed\n");
+}
+
+// --threads against the serial path, warm and cold, with and without
+// pretend NUMA nodes. Words and a \r\n straddle chunk seams.
+static void test_parallel_engine() {
+    printf("Testing parallel engine...\n");
+    
+    const char *path = "test_parallel.txt";
+    const size_t size = 5 * PARALLEL_CHUNK + 12345;
+    uint8_t *data = malloc(size);
+    assert(data != NULL);
+    const char alphabet[] = "ab \t\n\rxyz";
+    srand(3);
+    for (size_t i = 0; i < size; i++) data[i] = alphabet[rand() % 10];
+    memcpy(data + PARALLEL_CHUNK - 1, "\r\n", 2);
+    memcpy(data + 2 * PARALLEL_CHUNK - 3, "wordy", 5);
+    FILE *fp = fopen(path, "w");
+    assert(fp != NULL);
+    fwrite(data, 1, size, fp);
+    fclose(fp);
+    free(data);
+    
+    parallel_opts_t saved = parallel_opts;
+    counts_t ref, c;
+    parallel_opts.threads = 0;
+    assert(wc(path, &ref, NEWLINE_ANY) == 0);
+    
+    const char *fakes[] = { NULL, "2", "3" };
+    const int threads[] = { 1, 2, 3, 8, -1 };
+    for (size_t f = 0; f < 3; f++) {
+        if (fakes[f]) setenv("WC_FAKE_NUMA", fakes[f], 1);
+        else unsetenv("WC_FAKE_NUMA");
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            parallel_opts.threads = threads[t];
+            // Every other run starts cold, so chunks go through pread too
+            if (t % 2) evict_file(path);
+            assert(wc(path, &c, NEWLINE_ANY) == 0);
+            assert(c.lines == ref.lines && c.words == ref.words && c.bytes == ref.bytes);
+            assert(c.eol.lf == ref.eol.lf && c.eol.cr == ref.eol.cr && c.eol.crlf == ref.eol.crlf);
+        }
+    }
+    unsetenv("WC_FAKE_NUMA");
+    
+    // Placement on what this host reports; two nodes are pretend ones
+    numa_topo_t *topo = malloc(sizeof(numa_topo_t));
+    assert(topo != NULL);
+    numa_topology(topo);
+    assert(topo->ncpus >= 1 && topo->nnodes >= 1);
+    setenv("WC_FAKE_NUMA", "2", 1);
+    numa_topology(topo);
+    if (topo->ncpus >= 2) assert(topo->nnodes == 2 && topo->node[0] == 0 && topo->node[1] == 1);
+    unsetenv("WC_FAKE_NUMA");
+    free(topo);
+    
+    // Warm-cache throughput, serial against one thread per CPU
+    parallel_opts.threads = 0;
+    wc(path, &c, NEWLINE_DEFAULT);
+    double t0 = now_ns();
+    assert(wc(path, &c, NEWLINE_DEFAULT) == 0);
+    double serial = (now_ns() - t0) / 1e6;
+    parallel_opts.threads = -1;
+    t0 = now_ns();
+    assert(wc(path, &c, NEWLINE_DEFAULT) == 0);
+    double threaded = (now_ns() - t0) / 1e6;
+    printf("  %zuMB cached: serial %.1f ms, --threads %.1f ms\n", size >> 20, serial, threaded);
+    
+    parallel_opts = saved;
+    unlink(path);
+    printf("✓ Parallel engine tests passed\n");
+}
+
+static void test_count_patterns() {
+    printf("Testing --count-bytes kernels...\n");
+    
+    uint8_t seq[PATTERN_MAX_LEN];
+    size_t len;
+    assert(parse_pattern("\\t", seq, &len) == 0 && len == 1 && seq[0] == '\t');
+    assert(parse_pattern("a\\0\\x7f\\\\", seq, &len) == 0 && len == 4);
+    assert(seq[1] == 0 && seq[2] == 0x7f && seq[3] == '\\');
+    assert(parse_pattern("", seq, &len) < 0 && parse_pattern("\\q", seq, &len) < 0);
+    assert(parse_pattern("\\", seq, &len) < 0 && parse_pattern("0123456789abcdefg", seq, &len) < 0);
+    
+    // Eight columns at once: bytes, a self-overlapping SEQ and a long one,
+    // over random text split at every offset near the vector widths
+    static uint8_t text[64 * 600 + 77];
+    const char alphabet[] = "ab,|\t\r\n";
+    srand(9);
+    for (size_t i = 0; i < sizeof(text); i++) text[i] = alphabet[rand() % 7];
+    memcpy(text + 1000, "abab,|abab,|", 12);
+    const char *seqs[] = { ",", "|", "\\t", "\\0", "\\r\\n", ",,", "aaa", "abab,|abab,|" };
+    set_patterns(seqs, 8);
+    size_t ref[PATTERN_MAX];
+    for (int k = 0; k < 8; k++) ref[k] = count_pattern_ref(text, sizeof(text), patterns.seq[k], patterns.len[k]);
+    assert(ref[7] == 1);
+    
+    for (size_t split = 0; split < sizeof(text); split += (split < 80 ? 1 : 1231)) {
+        pattern_counts_t p;
+        memset(&p, 0, sizeof(p));
+        count_patterns(text, split, &p);
+        // Feed the rest in ragged pieces, some shorter than the tail
+        for (size_t off = split, piece = 1; off < sizeof(text); off += piece, piece = piece * 3 + 1) {
+            if (piece > sizeof(text) - off) piece = sizeof(text) - off;
+            count_patterns(text + off, piece, &p);
+        }
+        for (int k = 0; k < 8; k++) assert(p.n[k] == ref[k]);
+    }
+    
+    // Through wc(): mmap, buffered and the parallel engine with SEQs
+    // planted across chunk seams
+    const char *path = "test_patterns.txt";
+    const size_t size = 3 * PARALLEL_CHUNK + 999;
+    uint8_t *data = malloc(size);
+    assert(data != NULL);
+    for (size_t i = 0; i < size; i++) data[i] = alphabet[rand() % 7];
+    memcpy(data + PARALLEL_CHUNK - 1, "\r\n", 2);
+    memcpy(data + 2 * PARALLEL_CHUNK - 6, "abab,|abab,|", 12);
+    FILE *fp = fopen(path, "w");
+    assert(fp != NULL);
+    fwrite(data, 1, size, fp);
+    fclose(fp);
+    for (int k = 0; k < 8; k++) ref[k] = count_pattern_ref(data, size, patterns.seq[k], patterns.len[k]);
+    free(data);
+    
+    parallel_opts_t saved = parallel_opts;
+    counts_t c, plain;
+    const int threads[] = { 0, 1, 3 };
+    for (size_t t = 0; t < 3; t++) {
+        parallel_opts.threads = threads[t];
+        assert(wc(path, &c, NEWLINE_ANY) == 0);
+        for (int k = 0; k < 8; k++) assert(c.pat.n[k] == ref[k]);
+    }
+    parallel_opts = saved;
+    
+    // One pass with eight extra columns against the plain count
+    assert(wc(path, &plain, NEWLINE_DEFAULT) == 0);
+    double t0 = now_ns();
+    assert(wc(path, &c, NEWLINE_DEFAULT) == 0);
+    double with = (now_ns() - t0) / 1e6;
+    memset(&patterns, 0, sizeof(patterns));
+    t0 = now_ns();
+    assert(wc(path, &plain, NEWLINE_DEFAULT) == 0);
+    double without = (now_ns() - t0) / 1e6;
+    assert(c.lines == plain.lines && c.words == plain.words);
+    printf("  %zuMB: plain %.1f ms, with 8 --count-bytes columns %.1f ms\n",
+           size >> 20, without, with);
+    
+    unlink(path);
+    printf("✓ --count-bytes tests passed\n");
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *v, int n) {
+    qsort(v, n, sizeof(double), compare_doubles);
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+// --progress must not change the counts and must cost under 1%. The cost
+// is measured on an in-cache buffer, counted with and without publishing
+// to a slot while the reporter thread runs at a short interval. Runs with
+// progress off, on, and off again are interleaved in rotating order; the
+// gap between the two off medians is the noise, and the on median may not
+// exceed the off median by more than 1% beyond it. Time is this thread's
+// cycles where perf_event_open has a counter, wall time otherwise.
+// Relative cost of counting with a progress slot against without, from
+// interleaved runs over an in-cache buffer. *noise is the gap between the
+// two "off" medians, the resolution the comparison can claim.
+static double progress_overhead(const uint8_t *buf, size_t span, int cycles_fd, double *noise) {
+    enum { RUNS = 41, PASSES = 8 };
+    double cost[3][RUNS];  // off, on, off again
+    volatile size_t sink = 0;
+    counts_t c;
+    
+    progress.interval = 0.01;
+    progress_begin("overhead", (size_t)RUNS * 3 * PASSES * span);
+    assert(progress.running);
+    for (int r = 0; r < RUNS; r++) {
+        for (int j = 0; j < 3; j++) {
+            int m = (r + j) % 3;
+            progress_slot_t *slot = m == 1 ? progress_slot(0) : NULL;
+            double t0 = cycles_fd >= 0 ? cycle_counter_read(cycles_fd) : now_ns();
+            for (int p = 0; p < PASSES; p++) {
+                memset(&c, 0, sizeof(c));
+                count_with_progress(buf, span, &c, 0, slot, NEWLINE_DEFAULT);
+                sink += c.words;
+            }
+            cost[m][r] = (cycles_fd >= 0 ? cycle_counter_read(cycles_fd) : now_ns()) - t0;
+        }
+    }
+    progress_end();
+    (void)sink;
+    
+    double off0 = median(cost[0], RUNS), on = median(cost[1], RUNS), off1 = median(cost[2], RUNS);
+    double off = (off0 + off1) / 2;
+    double overhead = (on - off) / off;
+    *noise = (off0 > off1 ? off0 - off1 : off1 - off0) / off;
+    printf("  %zuMB in cache x %d, median of %d (%s): off %.3g, on %.3g, "
+           "overhead %+.2f%%, noise %.2f%%\n", span >> 20, PASSES, RUNS,
+           cycles_fd >= 0 ? "cycles" : "ns", off, on, overhead * 100, *noise * 100);
+    return overhead;
+}
+
+static void test_progress() {
+    printf("Testing progress reporting...\n");
+    
+    const char *path = "test_progress.txt";
+    const size_t size = 8 * PARALLEL_CHUNK + 777;
+    FILE *fp = fopen(path, "w");
+    assert(fp != NULL);
+    for (size_t j = 0; j < size; j++) fputc("The quick brown fox\n"[j % 20], fp);
+    fclose(fp);
+    
+    progress_t saved = progress;
+    parallel_opts_t saved_parallel = parallel_opts;
+    counts_t ref, c;
+    progress.interval = 0;
+    assert(wc(path, &ref, NEWLINE_DEFAULT) == 0);
+    
+    progress.out = fopen("/dev/null", "w");
+    assert(progress.out != NULL);
+    progress.interval = 0.01;
+    const int threads[] = { 0, 3 };
+    for (int t = 0; t < 2; t++) {
+        parallel_opts.threads = threads[t];
+        assert(wc(path, &c, NEWLINE_DEFAULT) == 0);
+        assert(c.lines == ref.lines && c.words == ref.words && c.bytes == ref.bytes);
+        
+        // The slots add up to the whole file once counting is done
+        size_t bytes = 0, lines = 0;
+        for (int i = 0; i < PROGRESS_SLOTS; i++) {
+            bytes += atomic_load(&progress_slots[i].bytes);
+            lines += atomic_load(&progress_slots[i].lines);
+        }
+        assert(bytes == size && lines == ref.lines);
+    }
+    parallel_opts.threads = 0;
+    
+    const size_t span = 4 * PROGRESS_STEP;
+    uint8_t *buf = aligned_alloc(64, span);
+    assert(buf != NULL);
+    for (size_t j = 0; j < span; j++) buf[j] = "The quick brown fox\n"[j % 20];
+    int cycles_fd = cycle_counter_open();
+    
+    // A real slowdown shows up in every attempt; a scheduler hiccup that
+    // lands on the "on" runs of one attempt does not
+    int ok = 0;
+    for (int attempt = 0; attempt < 3 && !ok; attempt++) {
+        double noise, overhead = progress_overhead(buf, span, cycles_fd, &noise);
+        ok = overhead <= 0.01 + noise;
+    }
+    assert(ok);
+    if (cycles_fd >= 0) close(cycles_fd);
+    free(buf);
+    
+    fclose(progress.out);
+    progress = saved;
+    parallel_opts = saved_parallel;
+    unlink(path);
+    printf("✓ Progress tests passed\n");
+}
+
+// Server mode: answers match local counts, errors come back as "E", and
+// requests/sec against fork+exec of a wc per file (WC_BENCH_BIN, default
+// the wc in PATH)
+static void test_serve() {
+    printf("Testing server mode...\n");
+    
+    const char *sock_path = "test_wc.sock";
+    const char *path = "test_serve.txt";
+    create_test_file(path, "one two\nthree\r\nfour  five\n");
+    server_t s;
+    
+    // A regular file at the socket path is left alone
+    assert(serve_start(&s, path, 1, NEWLINE_DEFAULT) < 0 && errno == EEXIST);
+    assert(access(path, F_OK) == 0);
+    assert(serve_start(&s, sock_path, 2, NEWLINE_DEFAULT) == 0);
+    
+    int sock = client_connect(sock_path);
+    assert(sock >= 0);
+    counts_t local, remote;
+    char err[SERVE_MAX_REPLY];
+    int npat;
+    assert(wc(path, &local, NEWLINE_DEFAULT) == 0);
+    int fd = open(path, O_RDONLY);
+    assert(client_request(sock, fd, &remote, &npat, err, sizeof(err)) == 0);
+    close(fd);
+    assert(remote.lines == local.lines && remote.words == local.words && remote.bytes == local.bytes);
+    assert(npat == 0);
+    
+    // The server's --count-bytes set comes back as extra columns
+    const char *seqs[] = { "\\r\\n", "e" };
+    set_patterns(seqs, 2);
+    fd = open(path, O_RDONLY);
+    assert(client_request(sock, fd, &remote, &npat, err, sizeof(err)) == 0);
+    close(fd);
+    assert(npat == 2 && remote.pat.n[0] == 1 && remote.pat.n[1] == 4);
+    assert(remote.bytes == local.bytes);
+    memset(&patterns, 0, sizeof(patterns));
+    
+    // Descriptors that cannot be counted, and path requests
+    fd = open(".", O_RDONLY);
+    assert(client_request(sock, fd, &remote, &npat, err, sizeof(err)) == 1);
+    close(fd);
+    char reply[128];
+    const char *bad = "P /nonexistent/file\n";
+    assert(write(sock, bad, strlen(bad)) == (ssize_t)strlen(bad));
+    ssize_t n = read(sock, reply, sizeof(reply) - 1);
+    assert(n > 2 && reply[0] == 'E');
+    
+    // A FIFO path and a pipe descriptor are refused without blocking
+    const char *fifo = "test_serve.fifo";
+    unlink(fifo);
+    assert(mkfifo(fifo, 0600) == 0);
+    const char *fifo_req = "P test_serve.fifo\n";
+    assert(write(sock, fifo_req, strlen(fifo_req)) == (ssize_t)strlen(fifo_req));
+    n = read(sock, reply, sizeof(reply) - 1);
+    assert(n > 2 && reply[0] == 'E');
+    unlink(fifo);
+    int pfds[2];
+    assert(pipe(pfds) == 0);
+    assert(client_request(sock, pfds[0], &remote, &npat, err, sizeof(err)) == 1);
+    close(pfds[0]);
+    close(pfds[1]);
+    
+    // Two descriptors in one request are refused, and neither is kept
+    int open_before = 0, open_after = 0;
+    for (int d = 0; d < 1024; d++) open_before += fcntl(d, F_GETFD) >= 0;
+    int pair[2] = { open(path, O_RDONLY), open(path, O_RDONLY) };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(pair))];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct iovec iov = { (char *)"F\n", 2 };
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control.buf, .msg_controllen = sizeof(control.buf),
+    };
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(pair));
+    memcpy(CMSG_DATA(cm), pair, sizeof(pair));
+    assert(sendmsg(sock, &msg, 0) == 2);
+    n = read(sock, reply, sizeof(reply) - 1);
+    assert(n > 2 && reply[0] == 'E');
+    close(pair[0]);
+    close(pair[1]);
+    for (int d = 0; d < 1024; d++) open_after += fcntl(d, F_GETFD) >= 0;
+    assert(open_after == open_before);
+    
+    const int requests = 2000;
+    double t0 = now_ns();
+    for (int i = 0; i < requests; i++) {
+        fd = open(path, O_RDONLY);
+        assert(client_request(sock, fd, &remote, &npat, err, sizeof(err)) == 0);
+        close(fd);
+    }
+    double kept = requests / ((now_ns() - t0) / 1e9);
+    close(sock);
+    
+    t0 = now_ns();
+    for (int i = 0; i < requests; i++) {
+        sock = client_connect(sock_path);
+        fd = open(path, O_RDONLY);
+        assert(sock >= 0 && client_request(sock, fd, &remote, &npat, err, sizeof(err)) == 0);
+        close(fd);
+        close(sock);
+    }
+    double fresh = requests / ((now_ns() - t0) / 1e9);
+    
+    // A client idling on its connection does not hold up shutdown
+    sock = client_connect(sock_path);
+    fd = open(path, O_RDONLY);
+    assert(sock >= 0 && client_request(sock, fd, &remote, &npat, err, sizeof(err)) == 0);
+    close(fd);
+    serve_shutdown(&s, sock_path);
+    assert(read(sock, reply, sizeof(reply)) == 0);
+    close(sock);
+    
+    const char *bin = getenv("WC_BENCH_BIN") ? getenv("WC_BENCH_BIN") : "wc";
+    const int spawns = 200;
+    int ok = 1;
+    t0 = now_ns();
+    for (int i = 0; i < spawns && ok; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int devnull = open("/dev/null", O_WRONLY);
+            dup2(devnull, STDOUT_FILENO);
+            execlp(bin, bin, path, (char *)NULL);
+            _exit(127);
+        }
+        int status;
+        ok = pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    double spawned = spawns / ((now_ns() - t0) / 1e9);
+    
+    printf("  server, one connection:     %8.0f requests/s\n", kept);
+    printf("  server, connect per file:   %8.0f requests/s\n", fresh);
+    if (ok) printf("  fork+exec %-18s %8.0f requests/s\n", bin, spawned);
+    else printf("  fork+exec %s failed, set WC_BENCH_BIN\n", bin);
+    
+    unlink(path);
+    printf("✓ Server mode tests passed\n");
+}
+
 static void run_performance_test() {
     printf("\nPerformance Tests:\n");
     
@@ -308,7 +3112,7 @@ static void run_performance_test() {
         // Time the operation
         counts_t c;
         clock_t start = clock();
-        assert(wc(filename, &c) == 0);
+        assert(wc(filename, &c, NEWLINE_DEFAULT) == 0);
         clock_t end = clock();
         
         double cpu_time = ((double)(end - start)) / CLOCKS_PER_SEC;
@@ -326,46 +3130,199 @@ static void run_performance_test() {
 // ============= MAIN PROGRAM =============
 int main(int argc, char *argv[]) {
 #ifdef RUN_TESTS
+    (void)argc;
+    (void)argv;
     printf("Running tests...\n\n");
     test_newline_counter();
     test_word_counting();
+    test_line_endings();
     test_integration();
+    test_follow_incremental();
+    test_readahead_hints();
+    test_parallel_engine();
+    test_count_patterns();
+    test_progress();
+    test_serve();
     run_performance_test();
+    run_kernel_benchmark();
     printf("\nAll tests passed!\n");
     return 0;
 #else
-    counts_t total = {0, 0, 0};
+    counts_t total = {0};
     int file_count = 0;
     int exit_code = 0;
+    int follow = 0;
+    int newline_mode = NEWLINE_DEFAULT;
+    follow_opts_t follow_opts = { 1.0, 0, NEWLINE_DEFAULT };
+    const char *serve_path = NULL, *client_path = NULL;
+    long pool = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    static struct option long_options[] = {
+        {"follow",   no_argument,       0, 'f'},
+        {"interval", required_argument, 0, 'i'},
+        {"ndjson",   no_argument,       0, 'j'},
+        {"newline",  required_argument, 0, 'n'},
+        {"readahead", required_argument, 0, 'r'},
+        {"keep-cache", no_argument,     0, 'k'},
+        {"threads",  optional_argument, 0, 't'},
+        {"stats",    no_argument,       0, 's'},
+        {"progress", optional_argument, 0, 'p'},
+        {"serve",    required_argument, 0, 'S'},
+        {"client",   required_argument, 0, 'C'},
+        {"pool",     required_argument, 0, 'P'},
+        {"count-bytes", required_argument, 0, 'B'},
+        {"print-kernel", no_argument,   0, 'K'},
+        {0, 0, 0, 0}
+    };
+    
+    // WC_KERNEL=NAME pins a word/line kernel, e.g. to benchmark one against another
+    const char *forced = getenv("WC_KERNEL");
+    if (forced && *forced && words_kernel_select(forced) < 0) {
+        fprintf(stderr, "wc: kernel '%s' is not available on this CPU\n", forced);
+        return 1;
+    }
+    
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'f': follow = 1; break;
+            case 'i': follow_opts.interval = atof(optarg); break;
+            case 'j': follow_opts.ndjson = 1; break;
+            case 'n':
+                if (strcmp(optarg, "lf") == 0) newline_mode = NEWLINE_LF;
+                else if (strcmp(optarg, "crlf") == 0) newline_mode = NEWLINE_CRLF;
+                else if (strcmp(optarg, "cr") == 0) newline_mode = NEWLINE_CR;
+                else if (strcmp(optarg, "any") == 0) newline_mode = NEWLINE_ANY;
+                else {
+                    fprintf(stderr, "wc: --newline must be one of lf, crlf, cr, any\n");
+                    return 1;
+                }
+                break;
+            case 'r': {
+                char *end;
+                double v = strtod(optarg, &end);
+                if (*end == 'K' || *end == 'k') v *= 1024, end++;
+                else if (*end == 'M' || *end == 'm') v *= 1024 * 1024, end++;
+                else if (*end == 'G' || *end == 'g') v *= 1024.0 * 1024 * 1024, end++;
+                if (end == optarg || *end || v < 0) {
+                    fprintf(stderr, "wc: invalid --readahead size '%s'\n", optarg);
+                    return 1;
+                }
+                io_hints.window = (size_t)v;
+                break;
+            }
+            case 'k': io_hints.drop_behind = 0; break;
+            case 't':
+                parallel_opts.threads = optarg ? atoi(optarg) : -1;
+                if (optarg && parallel_opts.threads < 1) {
+                    fprintf(stderr, "wc: --threads needs a positive thread count\n");
+                    return 1;
+                }
+                break;
+            case 's': parallel_opts.stats = 1; break;
+            case 'p':
+                progress.interval = optarg ? atof(optarg) : 1.0;
+                if (progress.interval <= 0) {
+                    fprintf(stderr, "wc: --progress interval must be positive\n");
+                    return 1;
+                }
+                break;
+            case 'S': serve_path = optarg; break;
+            case 'C': client_path = optarg; break;
+            case 'P': pool = atol(optarg); break;
+            case 'K':
+                printf("%s (%s)\n", words_kernel()->name, words_kernel()->level);
+                for (size_t k = 0; k < WORDS_KERNELS; k++) {
+                    printf("  %-9s %-10s %s\n", words_kernels[k].name, words_kernels[k].level,
+                           words_kernels[k].supported() ? "supported" : "unsupported");
+                }
+                return 0;
+            case 'B': {
+                int k = patterns.count;
+                if (k == PATTERN_MAX) {
+                    fprintf(stderr, "wc: at most %d --count-bytes sequences\n", PATTERN_MAX);
+                    return 1;
+                }
+                if (parse_pattern(optarg, patterns.seq[k], &patterns.len[k]) < 0) {
+                    fprintf(stderr, "wc: invalid --count-bytes sequence '%s' "
+                            "(1-%d bytes, escapes \\t \\n \\r \\0 \\\\ \\xHH)\n",
+                            optarg, PATTERN_MAX_LEN);
+                    return 1;
+                }
+                if (patterns.len[k] > patterns.max_len) patterns.max_len = patterns.len[k];
+                patterns.count++;
+                break;
+            }
+            default:
+                fprintf(stderr, "Usage: %s [-f] [--interval=SECS] [--ndjson] "
+                        "[--newline=lf|crlf|cr|any] [--readahead=SIZE] [--keep-cache] "
+                        "[--threads[=N]] [--stats] [--progress[=SECS]] "
+                        "[--serve=SOCKET [--pool=N] | --client=SOCKET] "
+                        "[--count-bytes=SEQ]... [--print-kernel] [file ...]\n", argv[0]);
+                return 1;
+        }
+    }
+    follow_opts.newline_mode = newline_mode;
+    argv += optind - 1;
+    argc -= optind - 1;
+    
+    if (serve_path) return serve_main(serve_path, pool > 0 ? (int)pool : 1, newline_mode);
+    if (client_path && patterns.count) {
+        // Like --newline, the SEQs are the server's: it counts and replies with them
+        fprintf(stderr, "wc: --count-bytes goes with --serve, not --client\n");
+        return 1;
+    }
+    if (client_path) return client_main(client_path, argv + 1, argc - 1);
+    
+    if (follow) {
+        if (argc == 1) {
+            fprintf(stderr, "wc: --follow requires at least one file\n");
+            return 1;
+        }
+        if (follow_opts.interval < 0) follow_opts.interval = 0;
+        int ret = follow_files(argv + 1, argc - 1, &follow_opts);
+        if (ret < 0) {
+            perror("wc");
+            return 1;
+        }
+        return ret;
+    }
     
     if (argc == 1) {
         // Read from stdin
-        if (wc(NULL, &total) < 0) {
+        if (wc(NULL, &total, newline_mode) < 0) {
             perror("wc");
             return 1;
         }
-        printf("%8zu %8zu %8zu\n", total.lines, total.words, total.bytes);
+        print_counts(&total, NULL);
+        if (newline_mode) print_line_endings(&total.eol, "-");
     } else {
         // Process files
         for (int i = 1; i < argc; i++) {
             counts_t c;
-            if (wc(argv[i], &c) < 0) {
+            if (wc(argv[i], &c, newline_mode) < 0) {
                 fprintf(stderr, "wc: %s: %s\n", argv[i], strerror(errno));
                 exit_code = 1;
                 continue;
             }
             
-            printf("%8zu %8zu %8zu %s\n", c.lines, c.words, c.bytes, argv[i]);
+            print_counts(&c, argv[i]);
+            if (newline_mode) print_line_endings(&c.eol, argv[i]);
             
             total.lines += c.lines;
             total.words += c.words;
             total.bytes += c.bytes;
+            total.eol.lf += c.eol.lf;
+            total.eol.cr += c.eol.cr;
+            total.eol.crlf += c.eol.crlf;
+            for (int k = 0; k < patterns.count; k++) total.pat.n[k] += c.pat.n[k];
             file_count++;
         }
         
         // Print total if multiple files
         if (file_count > 1) {
-            printf("%8zu %8zu %8zu total\n", total.lines, total.words, total.bytes);
+            print_counts(&total, "total");
+            if (newline_mode) print_line_endings(&total.eol, "total");
         }
     }
     
@@ -374,5 +3331,5 @@ int main(int argc, char *argv[]) {
 }
 
 // Compilation instructions:
-// For normal use: clang -O3 -march=native wc_optimized.c -o wc_optimized
+// For normal use: clang -O3 -march=native wc_optimized.c -o wc_optimized -pthread
 // For testing: clang -O3 -march=native -DRUN_TESTS wc_optimized.c -o wc_test
\ No newline at end of file
@@ -0,0 +1,229 @@
+// fuzz/fuzz.h
+// Differential fuzz driver shared by the per-entry harnesses. A harness
+// includes its entry's source, then this file, then defines fuzz_kernels[]:
+// every way the entry can count a buffer (each SIMD kernel, chunked with
+// random split points, streamed with random read sizes). Every kernel must
+// agree with a byte-at-a-time reference on lines, words and bytes. A kernel
+// that was not compiled in or that the CPU lacks returns -1 and is skipped.
+//
+// Built three ways from the same harness (see Makefile):
+//   libFuzzer   clang -fsanitize=fuzzer            LLVMFuzzerTestOneInput only
+//   AFL++       afl-clang-fast -fsanitize=fuzzer   same entry point
+//   standalone  -DFUZZ_STANDALONE                  replays files, or --bench
+#ifndef FUZZ_H
+#define FUZZ_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t lines, words, bytes;
+} fuzz_counts_t;
+
+typedef int (*fuzz_count_fn)(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c);
+
+typedef struct {
+    const char *name;
+    fuzz_count_fn count;
+    const void *arg;  // passed through, e.g. the name of a dispatched kernel
+} fuzz_kernel_t;
+
+extern const fuzz_kernel_t fuzz_kernels[];
+extern const size_t fuzz_nkernels;
+
+// Split points come from a generator seeded by the input, so a crash
+// replays exactly from the saved input
+static uint64_t fuzz_rng_state;
+
+static uint64_t fuzz_rand(void) {
+    uint64_t z = (fuzz_rng_state += 0x9e3779b97f4a7c15ULL);  // splitmix64
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void fuzz_seed(const uint8_t *data, size_t len, size_t salt) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ salt;  // FNV-1a
+    for (size_t i = 0; i < len && i < 64; i++) h = (h ^ data[i]) * 0x100000001b3ULL;
+    fuzz_rng_state = h ^ len;
+}
+
+// Set by the standalone --bench driver. It raises the largest piece
+// fuzz_piece() hands out, so streamed kernels are timed on realistic reads
+// rather than on call overhead, and tells sampled kernels to always run.
+static int fuzz_bench_mode;
+static size_t fuzz_max_piece = 257;
+
+// Length of the next piece of a split buffer: mostly small, often right at
+// a SIMD block edge, never zero unless nothing is left
+static inline size_t fuzz_piece(size_t left) {
+    static const size_t edges[] = {1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129};
+    size_t n;
+    if (fuzz_max_piece <= 4096 && fuzz_rand() % 4 == 0)
+        n = edges[fuzz_rand() % (sizeof(edges) / sizeof(edges[0]))];
+    else if (fuzz_rand() % 3 == 0)
+        n = left;
+    else
+        n = 1 + fuzz_rand() % fuzz_max_piece;
+    return n < left ? n : left;
+}
+
+// POSIX "C" locale wc: a word is a maximal run of bytes that are not
+// space, \t, \n, \v, \f or \r
+static void fuzz_reference(const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    int in_word = 0;
+    memset(c, 0, sizeof(*c));
+    for (size_t i = 0; i < len; i++) {
+        uint8_t ch = data[i];
+        int space = ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r';
+        c->lines += ch == '\n';
+        c->words += !space && !in_word;
+        in_word = !space;
+    }
+    c->bytes = len;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    fuzz_counts_t want, got;
+    fuzz_reference(data, size, &want);
+    for (size_t k = 0; k < fuzz_nkernels; k++) {
+        fuzz_seed(data, size, k);
+        memset(&got, 0, sizeof(got));
+        if (fuzz_kernels[k].count(fuzz_kernels[k].arg, data, size, &got)) continue;
+        if (got.lines != want.lines || got.words != want.words || got.bytes != want.bytes) {
+            fprintf(stderr, "kernel %s on %zu bytes: %llu %llu %llu, reference %llu %llu %llu\n",
+                    fuzz_kernels[k].name, size,
+                    (unsigned long long)got.lines, (unsigned long long)got.words,
+                    (unsigned long long)got.bytes, (unsigned long long)want.lines,
+                    (unsigned long long)want.words, (unsigned long long)want.bytes);
+            abort();
+        }
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define FUZZ_BENCH_BYTES (16u << 20)  // each input is tiled to this size
+
+static double fuzz_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+typedef struct {
+    double worst_mbs;
+    char worst_input[256];
+} fuzz_bench_worst_t;
+
+static fuzz_bench_worst_t *fuzz_worst;
+static size_t fuzz_inputs;
+
+// Throughput of every kernel on one input, repeated to FUZZ_BENCH_BYTES so
+// timer resolution and cold caches do not dominate. Best of three runs.
+static void fuzz_bench(const char *name, const uint8_t *data, size_t size) {
+    if (size == 0) return;
+    uint8_t *buf = malloc(FUZZ_BENCH_BYTES);
+    if (!buf) { perror("malloc"); exit(2); }
+    for (size_t off = 0; off < FUZZ_BENCH_BYTES; off += size) {
+        size_t n = FUZZ_BENCH_BYTES - off < size ? FUZZ_BENCH_BYTES - off : size;
+        memcpy(buf + off, data, n);
+    }
+    printf("%s (%zu bytes)\n", name, size);
+    for (size_t k = 0; k < fuzz_nkernels; k++) {
+        const fuzz_kernel_t *fk = &fuzz_kernels[k];
+        double best = 1e30;
+        for (int rep = 0; rep < 3 && best > 0; rep++) {
+            fuzz_counts_t c = {0, 0, 0};
+            fuzz_seed(data, size, k);
+            double t0 = fuzz_now();
+            if (fk->count(fk->arg, buf, FUZZ_BENCH_BYTES, &c)) best = 0;
+            double t = fuzz_now() - t0;
+            if (best > 0 && t < best) best = t;
+        }
+        if (best == 0) continue;  // not available here
+        double mbs = FUZZ_BENCH_BYTES / (1024.0 * 1024.0) / best;
+        printf("  %-24s %9.1f MiB/s\n", fuzz_kernels[k].name, mbs);
+        if (fuzz_worst[k].worst_mbs == 0 || mbs < fuzz_worst[k].worst_mbs) {
+            fuzz_worst[k].worst_mbs = mbs;
+            snprintf(fuzz_worst[k].worst_input, sizeof(fuzz_worst[k].worst_input), "%s", name);
+        }
+    }
+    free(buf);
+}
+
+static int fuzz_run_file(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) { perror(path); return -1; }
+    size_t cap = 4096, size = 0, n;
+    uint8_t *data = malloc(cap);
+    while (data && (n = fread(data + size, 1, cap - size, fp)) > 0) {
+        size += n;
+        if (size == cap) data = realloc(data, cap *= 2);
+    }
+    fclose(fp);
+    if (!data) { perror("malloc"); exit(2); }
+    LLVMFuzzerTestOneInput(data, size);
+    if (fuzz_bench_mode) fuzz_bench(path, data, size);
+    fuzz_inputs++;
+    free(data);
+    return 0;
+}
+
+static int fuzz_run_path(const char *path) {
+    struct stat st;
+    if (stat(path, &st)) { perror(path); return -1; }
+    if (!S_ISDIR(st.st_mode)) return fuzz_run_file(path);
+    DIR *dir = opendir(path);
+    if (!dir) { perror(path); return -1; }
+    int rc = 0;
+    struct dirent *de;
+    char full[4096];
+    while ((de = readdir(dir))) {
+        if (de->d_name[0] == '.') continue;
+        snprintf(full, sizeof(full), "%s/%s", path, de->d_name);
+        if (fuzz_run_file(full)) rc = -1;
+    }
+    closedir(dir);
+    return rc;
+}
+
+// Replays corpus files and directories through every kernel (a mismatch
+// aborts), or with --bench also reports throughput per kernel and input
+int main(int argc, char **argv) {
+    int rc = 0, first = 1;
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        fuzz_bench_mode = 1;
+        fuzz_max_piece = 1 << 16;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage: %s [--bench] FILE|DIR ...\n", argv[0]);
+        return 2;
+    }
+    fuzz_worst = calloc(fuzz_nkernels, sizeof(*fuzz_worst));
+    if (!fuzz_worst) { perror("calloc"); return 2; }
+    for (int i = first; i < argc; i++)
+        if (fuzz_run_path(argv[i])) rc = 1;
+    if (fuzz_bench_mode) {
+        printf("slowest input per kernel:\n");
+        for (size_t k = 0; k < fuzz_nkernels; k++) {
+            if (fuzz_worst[k].worst_mbs == 0) continue;
+            printf("  %-24s %9.1f MiB/s  %s\n", fuzz_kernels[k].name,
+                   fuzz_worst[k].worst_mbs, fuzz_worst[k].worst_input);
+        }
+    }
+    printf("%zu inputs: every available kernel agrees with the reference\n", fuzz_inputs);
+    free(fuzz_worst);
+    return rc;
+}
+#endif // FUZZ_STANDALONE
+#endif // FUZZ_H
@@ -0,0 +1,70 @@
+// fuzz/fuzz_chatgpt_o3.c
+// chatgpt_o3: the span kernel (NEON when built for it), the same kernel
+// streamed with the word state carried between reads as wc_stream does, and
+// range partials merged back in shuffled order
+#define WC_NO_MAIN
+#include "../chatgpt_o3/src/wc.c"
+#include "fuzz.h"
+
+#if defined(__ARM_NEON)
+#define O3_KERNEL "neon"
+#else
+#define O3_KERNEL "scalar"
+#endif
+
+#define O3_MAX_PARTS 64
+
+static void o3_result(const wc_counts_t *w, fuzz_counts_t *c) {
+    c->lines = w->lines;
+    c->words = w->words;
+    c->bytes = w->bytes;
+}
+
+static int o3_whole(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    wc_counts_t w = {0, 0, 0};
+    (void)arg;
+    wc_count_buffer(data, len, &w);
+    o3_result(&w, c);
+    return 0;
+}
+
+static int o3_stream(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    wc_counts_t w = {0, 0, 0};
+    uint8_t in_word = 0;
+    (void)arg;
+    for (size_t off = 0; off < len;) {
+        size_t n = fuzz_piece(len - off);
+        wc_count_span(data + off, n, &w, &in_word);
+        off += n;
+    }
+    o3_result(&w, c);
+    return 0;
+}
+
+static int o3_partials(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    wc_partial_t parts[O3_MAX_PARTS];
+    wc_counts_t w;
+    size_t n = 0, off = 0;
+    (void)arg;
+    do {
+        size_t take = n == O3_MAX_PARTS - 1 ? len - off : fuzz_piece(len - off);
+        wc_partial_count(data + off, take, off, len, &parts[n++]);
+        off += take;
+    } while (off < len);
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = fuzz_rand() % (i + 1);
+        wc_partial_t t = parts[i];
+        parts[i] = parts[j];
+        parts[j] = t;
+    }
+    if (wc_partial_merge(parts, n, &w)) abort();
+    o3_result(&w, c);
+    return 0;
+}
+
+const fuzz_kernel_t fuzz_kernels[] = {
+    {O3_KERNEL " whole", o3_whole, NULL},
+    {O3_KERNEL " stream", o3_stream, NULL},
+    {O3_KERNEL " partials", o3_partials, NULL},
+};
+const size_t fuzz_nkernels = sizeof(fuzz_kernels) / sizeof(fuzz_kernels[0]);
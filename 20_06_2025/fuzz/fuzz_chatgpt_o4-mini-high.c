@@ -0,0 +1,38 @@
+// fuzz/fuzz_chatgpt_o4-mini-high.c
+// chatgpt_o4-mini-high: count_buffer on the whole input and on random
+// reads, with struct stats carrying the word state as process_fd does
+#define WC_NO_MAIN
+#include "../chatgpt_o4-mini-high/wc.c"
+#include "fuzz.h"
+
+static void o4_result(const struct stats *s, fuzz_counts_t *c) {
+    c->lines = s->lines;
+    c->words = s->words;
+    c->bytes = s->bytes;
+}
+
+static int o4_whole(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    struct stats s = {0, 0, 0, 0};
+    (void)arg;
+    count_buffer((const char *)data, len, &s);
+    o4_result(&s, c);
+    return 0;
+}
+
+static int o4_stream(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    struct stats s = {0, 0, 0, 0};
+    (void)arg;
+    for (size_t off = 0; off < len;) {
+        size_t n = fuzz_piece(len - off);
+        count_buffer((const char *)data + off, n, &s);
+        off += n;
+    }
+    o4_result(&s, c);
+    return 0;
+}
+
+const fuzz_kernel_t fuzz_kernels[] = {
+    {"scalar whole", o4_whole, NULL},
+    {"scalar stream", o4_stream, NULL},
+};
+const size_t fuzz_nkernels = sizeof(fuzz_kernels) / sizeof(fuzz_kernels[0]);
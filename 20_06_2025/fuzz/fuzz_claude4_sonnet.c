@@ -0,0 +1,42 @@
+// fuzz/fuzz_claude4_sonnet.c
+// claude4_sonnet: count_data under the option sets that route lines and
+// words through different kernels (count_lines_simd + count_words_optimized,
+// the -L line-length scan, the --profile histogram pass, the --index scan).
+// NEON or SVE kernels are used when built for them.
+#define main claude4_sonnet_main
+#include "../claude4_sonnet/wc.c"
+#undef main
+#include "fuzz.h"
+
+enum { SONNET_PLAIN, SONNET_MAX_LINE, SONNET_PROFILE, SONNET_INDEX };
+
+static const int sonnet_modes[] = {SONNET_PLAIN, SONNET_MAX_LINE, SONNET_PROFILE, SONNET_INDEX};
+
+static int sonnet_count(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    wc_options_t opts = {.count_lines = 1, .count_words = 1, .count_bytes = 1, .profile = PROFILE_NONE};
+    wc_line_index_t idx;
+    int mode = *(const int *)arg;
+    if (mode == SONNET_MAX_LINE) opts.max_line_length = 1;
+    if (mode == SONNET_PROFILE) opts.profile = PROFILE_FULL;
+    if (mode == SONNET_INDEX) {
+        line_index_init(&idx, 1 + fuzz_rand() % 4096);
+        opts.index = &idx;
+    }
+    wc_counts_t *n = malloc(sizeof(*n));  // the histograms make it large
+    if (!n) abort();
+    *n = count_data((const char *)data, len, &opts);
+    c->lines = n->lines;
+    c->words = n->words;
+    c->bytes = n->bytes;
+    free(n);
+    if (mode == SONNET_INDEX) line_index_free(&idx);
+    return 0;
+}
+
+const fuzz_kernel_t fuzz_kernels[] = {
+    {"simd lines+words", sonnet_count, &sonnet_modes[SONNET_PLAIN]},
+    {"max-line-length", sonnet_count, &sonnet_modes[SONNET_MAX_LINE]},
+    {"profile", sonnet_count, &sonnet_modes[SONNET_PROFILE]},
+    {"index", sonnet_count, &sonnet_modes[SONNET_INDEX]},
+};
+const size_t fuzz_nkernels = sizeof(fuzz_kernels) / sizeof(fuzz_kernels[0]);
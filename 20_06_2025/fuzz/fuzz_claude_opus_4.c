@@ -0,0 +1,64 @@
+// fuzz/fuzz_claude_opus_4.c
+// claude_opus_4: count_words_and_lines (NEON when built for it) whole and
+// streamed with the word state carried, and count_span with --newline=lf,
+// which takes the line count from count_line_endings instead
+#define main claude_opus_4_main
+#include "../claude_opus_4/wc_optimized.c"
+#undef main
+#include "fuzz.h"
+
+#if defined(__ARM_NEON)
+#define OPUS_KERNEL "neon"
+#else
+#define OPUS_KERNEL "scalar"
+#endif
+
+static int opus_whole(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    counts_t n;
+    (void)arg;
+    memset(&n, 0, sizeof(n));
+    count_words_and_lines(data, len, &n, 0);
+    c->lines = n.lines;
+    c->words = n.words;
+    c->bytes = len;
+    return 0;
+}
+
+static int opus_stream(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    counts_t n;
+    int in_word = 0;
+    (void)arg;
+    memset(&n, 0, sizeof(n));
+    for (size_t off = 0; off < len;) {
+        size_t piece = fuzz_piece(len - off);
+        in_word = count_words_and_lines(data + off, piece, &n, in_word);
+        off += piece;
+    }
+    c->lines = n.lines;
+    c->words = n.words;
+    c->bytes = len;
+    return 0;
+}
+
+static int opus_line_endings(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    counts_t n;
+    int in_word = 0;
+    (void)arg;
+    memset(&n, 0, sizeof(n));
+    for (size_t off = 0; off < len;) {
+        size_t piece = fuzz_piece(len - off);
+        in_word = count_span(data + off, piece, &n, in_word, NULL, NEWLINE_LF);
+        off += piece;
+    }
+    c->lines = eol_lines(&n.eol, NEWLINE_LF);
+    c->words = n.words;
+    c->bytes = len;
+    return 0;
+}
+
+const fuzz_kernel_t fuzz_kernels[] = {
+    {OPUS_KERNEL " whole", opus_whole, NULL},
+    {OPUS_KERNEL " stream", opus_stream, NULL},
+    {OPUS_KERNEL " newline=lf", opus_line_endings, NULL},
+};
+const size_t fuzz_nkernels = sizeof(fuzz_kernels) / sizeof(fuzz_kernels[0]);
@@ -0,0 +1,54 @@
+// fuzz/fuzz_gemeni2.5pro.c
+// gemeni2.5pro: every kernel in its dispatch table that this CPU runs
+// (AVX-512BW, AVX2, SSE4.2, SVE, NEON, scalar), whole and streamed with the
+// in-word state passed from one read to the next
+#define FAST_WC_NO_MAIN
+#include "../gemeni2.5pro/fast_wc.c"
+#include "fuzz.h"
+
+static const Kernel *gemeni_kernel(const char *name) {
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if (strcmp(kernels[i].name, name) == 0) return kernels[i].supported() ? &kernels[i] : NULL;
+    }
+    return NULL;
+}
+
+static int gemeni_whole(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    const Kernel *k = gemeni_kernel(arg);
+    Counts n = {0, 0, 0};
+    if (!k) return -1;
+    k->fn(data, len, &n, false);
+    c->lines = (uint64_t)n.lines;
+    c->words = (uint64_t)n.words;
+    c->bytes = len;
+    return 0;
+}
+
+static int gemeni_stream(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    const Kernel *k = gemeni_kernel(arg);
+    Counts n = {0, 0, 0};
+    bool in_word = false;
+    if (!k) return -1;
+    for (size_t off = 0; off < len;) {
+        size_t piece = fuzz_piece(len - off);
+        in_word = k->fn(data + off, piece, &n, in_word);
+        off += piece;
+    }
+    c->lines = (uint64_t)n.lines;
+    c->words = (uint64_t)n.words;
+    c->bytes = len;
+    return 0;
+}
+
+#define GEMENI_KERNEL(name) \
+    {name " whole", gemeni_whole, name}, {name " stream", gemeni_stream, name}
+
+const fuzz_kernel_t fuzz_kernels[] = {
+    GEMENI_KERNEL("avx512bw"),
+    GEMENI_KERNEL("avx2"),
+    GEMENI_KERNEL("sse4.2"),
+    GEMENI_KERNEL("sve"),
+    GEMENI_KERNEL("neon"),
+    GEMENI_KERNEL("scalar"),
+};
+const size_t fuzz_nkernels = sizeof(fuzz_kernels) / sizeof(fuzz_kernels[0]);
@@ -0,0 +1,53 @@
+// fuzz/fuzz_grok3.c
+// grok3: process_span whole and streamed like process_stdin, and the forked
+// chunk-parallel count with a random number of slices
+#define main grok3_main
+#include "../grok3/wc.c"
+#undef main
+#include "fuzz.h"
+
+static void grok3_result(const Counts *n, fuzz_counts_t *c) {
+    c->lines = (uint64_t)n->lines;
+    c->words = (uint64_t)n->words;
+    c->bytes = (uint64_t)n->chars;
+}
+
+static int grok3_whole(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    Counts n = process_buffer((const char *)data, len);
+    (void)arg;
+    grok3_result(&n, c);
+    return 0;
+}
+
+static int grok3_stream(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    Counts n = {0, 0, 0};
+    int in_word = 0;
+    (void)arg;
+    for (size_t off = 0; off < len;) {
+        size_t piece = fuzz_piece(len - off);
+        Counts p = process_span((const char *)data + off, piece, &in_word);
+        n.lines += p.lines;
+        n.words += p.words;
+        n.chars += p.chars;
+        off += piece;
+    }
+    grok3_result(&n, c);
+    return 0;
+}
+
+// A fork per slice is slow next to the other kernels, so only every
+// eighth input (chosen by the input-seeded generator) takes this path
+static int grok3_forked(const void *arg, const uint8_t *data, size_t len, fuzz_counts_t *c) {
+    (void)arg;
+    if (!fuzz_bench_mode && fuzz_rand() % 8) return -1;
+    Counts n = process_buffer_forked((const char *)data, len, 2 + (int)(fuzz_rand() % 7));
+    grok3_result(&n, c);
+    return 0;
+}
+
+const fuzz_kernel_t fuzz_kernels[] = {
+    {"scalar whole", grok3_whole, NULL},
+    {"scalar stream", grok3_stream, NULL},
+    {"forked slices", grok3_forked, NULL},
+};
+const size_t fuzz_nkernels = sizeof(fuzz_kernels) / sizeof(fuzz_kernels[0]);
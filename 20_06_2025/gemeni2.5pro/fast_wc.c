@@ -2,15 +2,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
 
-// Include ARM NEON intrinsics header
-#if defined(__ARM_NEON)
+// Every kernel is compiled into the same binary with its own target attribute;
+// the best one the running CPU supports is picked once at startup.
+#if !defined(FAST_WC_SCALAR) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+// Include ARM NEON intrinsics header (NEON is baseline on AArch64)
+#if !defined(FAST_WC_SCALAR) && defined(__ARM_NEON)
+#define HAVE_NEON_KERNEL 1
 #include <arm_neon.h>
 #endif
 
-// A large buffer is key to performance. 128KB is a good starting point.
-#define BUFFER_SIZE (128 * 1024)
+// SVE intrinsics inside a target-attributed function need clang 16+ or gcc 14+;
+// Apple cores have no SVE, so this is a Linux-only candidate.
+#if !defined(FAST_WC_SCALAR) && defined(__aarch64__) && defined(__linux__) && \
+    ((defined(__clang__) && __clang_major__ >= 16) || (!defined(__clang__) && __GNUC__ >= 14))
+#define HAVE_SVE_KERNEL 1
+#include <arm_sve.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1 << 22)
+#endif
+#endif
+
+// A large buffer is key to performance. 1MB reads cost 1024 syscalls per
+// GB where 128KB cost 8192, and still fit in L2 on most cores.
+#define BUFFER_SIZE (1024 * 1024)
 
 // Struct to hold our counts
 typedef struct {
@@ -19,79 +41,273 @@ typedef struct {
     long bytes;
 } Counts;
 
-// The core logic for processing a buffer of data.
-// It takes the previous character's state to correctly handle words across buffer boundaries.
-static inline bool process_buffer(const unsigned char* buffer, size_t size, Counts* counts, bool in_word_prev) {
-    bool in_word = in_word_prev;
+// A kernel counts lines and words in a buffer and returns the final in-word state.
+typedef bool (*count_kernel_fn)(const unsigned char* buffer, size_t size, Counts* counts, bool in_word);
 
-    // Byte count is trivial
-    counts->bytes += size;
+// Same set as isspace() in the C locale: ' ' and '\t'..'\r'
+static inline bool is_space_byte(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+// Portable fallback, also used for the tails the vector kernels leave over.
+static bool kernel_scalar(const unsigned char* buffer, size_t size, Counts* counts, bool in_word) {
+    long lines = 0, words = 0;
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = buffer[i];
+        lines += (c == '\n');
+        // Word counting state machine
+        bool space = is_space_byte(c);
+        words += (!space && !in_word);
+        in_word = !space;
+    }
+    counts->lines += lines;
+    counts->words += words;
+    return in_word;
+}
+
+#if defined(HAVE_X86_KERNELS)
+// x86-64-v2: 16 bytes per step. Whitespace is ' ' or (c - 9) <= 4 unsigned, and a word
+// starts at every non-space byte whose predecessor is a space.
+__attribute__((target("sse4.2,popcnt")))
+static bool kernel_sse42(const unsigned char* buffer, size_t size, Counts* counts, bool in_word) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i four = _mm_set1_epi8(4);
+    uint32_t prev = in_word;
+    long lines = 0, words = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(buffer + i));
+        __m128i t = _mm_sub_epi8(v, tab);
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(_mm_min_epu8(t, four), t));
+        uint32_t ns = ~(uint32_t)_mm_movemask_epi8(ws) & 0xFFFF;
+        lines += _mm_popcnt_u32((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+        words += _mm_popcnt_u32(ns & ~((ns << 1) | prev));
+        prev = ns >> 15;
+    }
+    counts->lines += lines;
+    counts->words += words;
+    return kernel_scalar(buffer + i, size - i, counts, prev);
+}
 
-    // Pointers for loops
-    const unsigned char* p = buffer;
-    const unsigned char* end = buffer + size;
-    
-#if defined(__ARM_NEON)
-    // SIMD implementation for newline counting (super fast)
-    // We create a vector of all newline characters.
-    uint8x16_t nl_vector = vdupq_n_u8('\n');
-    uint64_t line_count_in_buffer = 0;
-
-    // Process the buffer in 16-byte chunks
-    const unsigned char* aligned_end = buffer + (size / 16) * 16;
-    while (p < aligned_end) {
-        // Load 16 bytes from memory
-        uint8x16_t chunk = vld1q_u8(p);
-        // Compare each byte with the newline character. Result is 0xFF for true, 0x00 for false.
-        uint8x16_t result = vceqq_u8(chunk, nl_vector);
-        // Right-shift by 7 bits to turn 0xFF into 0x01. This makes summing easier.
-        result = vshrq_n_u8(result, 7);
-        // Add up the 1s in the vector and add to our total.
-        line_count_in_buffer += vaddvq_u8(result);
-        p += 16;
+// x86-64-v3: the same with 32-byte AVX2 vectors.
+__attribute__((target("avx2,popcnt")))
+static bool kernel_avx2(const unsigned char* buffer, size_t size, Counts* counts, bool in_word) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i sp = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i four = _mm256_set1_epi8(4);
+    uint64_t prev = in_word;
+    long lines = 0, words = 0;
+    size_t i = 0;
+
+    for (; i + 32 <= size; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(buffer + i));
+        __m256i t = _mm256_sub_epi8(v, tab);
+        __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, sp),
+                                     _mm256_cmpeq_epi8(_mm256_min_epu8(t, four), t));
+        uint64_t ns = ~(uint32_t)_mm256_movemask_epi8(ws) & 0xFFFFFFFFu;
+        lines += _mm_popcnt_u32((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+        words += _mm_popcnt_u64(ns & ~((ns << 1) | prev));
+        prev = ns >> 31;
+    }
+    counts->lines += lines;
+    counts->words += words;
+    return kernel_scalar(buffer + i, size - i, counts, prev);
+}
+
+// x86-64-v4: AVX-512BW compares straight into 64-bit masks.
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static bool kernel_avx512bw(const unsigned char* buffer, size_t size, Counts* counts, bool in_word) {
+    const __m512i nl = _mm512_set1_epi8('\n');
+    const __m512i sp = _mm512_set1_epi8(' ');
+    const __m512i tab = _mm512_set1_epi8('\t');
+    const __m512i four = _mm512_set1_epi8(4);
+    uint64_t prev = in_word;
+    long lines = 0, words = 0;
+    size_t i = 0;
+
+    for (; i + 64 <= size; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void*)(buffer + i));
+        uint64_t ws = _mm512_cmpeq_epi8_mask(v, sp) |
+                      _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, tab), four);
+        uint64_t ns = ~ws;
+        lines += _mm_popcnt_u64(_mm512_cmpeq_epi8_mask(v, nl));
+        words += _mm_popcnt_u64(ns & ~((ns << 1) | prev));
+        prev = ns >> 63;
     }
-    counts->lines += line_count_in_buffer;
+    counts->lines += lines;
+    counts->words += words;
+    return kernel_scalar(buffer + i, size - i, counts, prev);
+}
 #endif
 
-    // Scalar processing for the remainder (for newlines) and for all word counting.
-    // We restart the pointer 'p' from the beginning for the word count logic.
-    p = buffer;
-    while (p < end) {
-#if !defined(__ARM_NEON)
-        // If not using NEON, do scalar newline counting here.
-        if (*p == '\n') {
-            counts->lines++;
+#if defined(HAVE_NEON_KERNEL)
+// Word starts in one block: non-space lanes whose predecessor, shifted in
+// from the previous block with vext, is a space. Lanes are 0xFF or 0.
+static inline uint8x16_t neon_word_starts(uint8x16_t v, uint8x16_t* prev_ns) {
+    uint8x16_t ws = vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                             vcleq_u8(vsubq_u8(v, vdupq_n_u8('\t')), vdupq_n_u8(4)));
+    uint8x16_t ns = vmvnq_u8(ws);
+    uint8x16_t starts = vbicq_u8(ns, vextq_u8(*prev_ns, ns, 15));
+    *prev_ns = ns;
+    return starts;
+}
+
+// AArch64: 64 bytes per round into four independent per-lane accumulators
+// for lines and for words (vsubq_u8 of 0xFF adds one). The across-vector
+// reduction happens once per 255 rounds, after a vpadalq_u8 widening.
+static bool kernel_neon(const unsigned char* buffer, size_t size, Counts* counts, bool in_word) {
+    const uint8x16_t nl = vdupq_n_u8('\n');
+    uint8x16_t prev_ns = vdupq_n_u8(in_word ? 0xFF : 0);
+    uint64_t lines = 0, words = 0;
+    size_t i = 0;
+
+    while (i + 64 <= size) {
+        uint8x16_t l0 = vdupq_n_u8(0), l1 = l0, l2 = l0, l3 = l0;
+        uint8x16_t w0 = l0, w1 = l0, w2 = l0, w3 = l0;
+        size_t rounds = (size - i) / 64;
+        if (rounds > 255) rounds = 255;
+
+        for (size_t r = 0; r < rounds; r++, i += 64) {
+            uint8x16_t v0 = vld1q_u8(buffer + i);
+            uint8x16_t v1 = vld1q_u8(buffer + i + 16);
+            uint8x16_t v2 = vld1q_u8(buffer + i + 32);
+            uint8x16_t v3 = vld1q_u8(buffer + i + 48);
+            l0 = vsubq_u8(l0, vceqq_u8(v0, nl));
+            l1 = vsubq_u8(l1, vceqq_u8(v1, nl));
+            l2 = vsubq_u8(l2, vceqq_u8(v2, nl));
+            l3 = vsubq_u8(l3, vceqq_u8(v3, nl));
+            w0 = vsubq_u8(w0, neon_word_starts(v0, &prev_ns));
+            w1 = vsubq_u8(w1, neon_word_starts(v1, &prev_ns));
+            w2 = vsubq_u8(w2, neon_word_starts(v2, &prev_ns));
+            w3 = vsubq_u8(w3, neon_word_starts(v3, &prev_ns));
         }
+
+        lines += vaddlvq_u16(vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(l0), l1), l2), l3));
+        words += vaddlvq_u16(vpadalq_u8(vpadalq_u8(vpadalq_u8(vpaddlq_u8(w0), w1), w2), w3));
+    }
+    counts->lines += lines;
+    counts->words += words;
+    if (i > 0) in_word = vgetq_lane_u8(prev_ns, 15) != 0;
+    return kernel_scalar(buffer + i, size - i, counts, in_word);
+}
 #endif
-        // Word counting state machine
-        if (isspace(*p)) {
-            in_word = false;
-        } else {
-            if (!in_word) {
-                counts->words++;
-            }
-            in_word = true;
-        }
-        p++;
+
+#if defined(HAVE_SVE_KERNEL)
+// Vector-length agnostic: a governing predicate covers the tail, and the byte
+// before each lane is loaded directly from buffer + i - 1.
+__attribute__((target("arch=armv8.2-a+sve")))
+static bool kernel_sve(const unsigned char* buffer, size_t size, Counts* counts, bool in_word) {
+    if (size == 0) return in_word;
+
+    // The first byte's predecessor lives in the caller's state, not the buffer.
+    kernel_scalar(buffer, 1, counts, in_word);
+    uint64_t lines = 0, words = 0;
+
+    for (uint64_t i = 1; i < size; i += svcntb()) {
+        svbool_t pg = svwhilelt_b8_u64(i, size);
+        svuint8_t cur = svld1_u8(pg, buffer + i);
+        svuint8_t prv = svld1_u8(pg, buffer + i - 1);
+        svbool_t ws_cur = svorr_b_z(pg, svcmpeq_n_u8(pg, cur, ' '),
+                                    svcmple_n_u8(pg, svsub_n_u8_x(pg, cur, '\t'), 4));
+        svbool_t ws_prv = svorr_b_z(pg, svcmpeq_n_u8(pg, prv, ' '),
+                                    svcmple_n_u8(pg, svsub_n_u8_x(pg, prv, '\t'), 4));
+        lines += svcntp_b8(pg, svcmpeq_n_u8(pg, cur, '\n'));
+        words += svcntp_b8(pg, svbic_b_z(pg, ws_prv, ws_cur));
     }
+    counts->lines += lines;
+    counts->words += words;
+    return !is_space_byte(buffer[size - 1]);
+}
+#endif
+
+typedef struct {
+    const char* name;
+    const char* level;
+    count_kernel_fn fn;
+    bool (*supported)(void);
+} Kernel;
+
+static bool always_supported(void) { return true; }
+
+#if defined(HAVE_X86_KERNELS)
+static bool cpu_has_sse42(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+}
+static bool cpu_has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+}
+static bool cpu_has_avx512bw(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+#endif
 
-#if defined(__ARM_NEON)
-    // Handle the few leftover bytes for newline counting that didn't fit in a 16-byte vector
-    p = aligned_end;
-    while (p < end) {
-        if (*p == '\n') {
-            counts->lines++;
+#if defined(HAVE_SVE_KERNEL)
+static bool cpu_has_sve(void) {
+    return (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+}
+#endif
+
+// Ordered best first; the first supported entry wins.
+static const Kernel kernels[] = {
+#if defined(HAVE_X86_KERNELS)
+    { "avx512bw", "x86-64-v4", kernel_avx512bw, cpu_has_avx512bw },
+    { "avx2",     "x86-64-v3", kernel_avx2,     cpu_has_avx2 },
+    { "sse4.2",   "x86-64-v2", kernel_sse42,    cpu_has_sse42 },
+#endif
+#if defined(HAVE_SVE_KERNEL)
+    { "sve",      "armv8-a+sve", kernel_sve,    cpu_has_sve },
+#endif
+#if defined(HAVE_NEON_KERNEL)
+    { "neon",     "armv8-a",   kernel_neon,     always_supported },
+#endif
+    { "scalar",   "generic",   kernel_scalar,   always_supported },
+};
+
+static const Kernel* active_kernel = NULL;
+
+static const Kernel* best_kernel(void) {
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if (kernels[i].supported()) return &kernels[i];
+    }
+    return &kernels[sizeof(kernels) / sizeof(kernels[0]) - 1];
+}
+
+// Force a kernel by name. Fails if it was not compiled in or the CPU lacks it.
+bool use_kernel(const char* name) {
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if (strcmp(kernels[i].name, name) == 0 && kernels[i].supported()) {
+            active_kernel = &kernels[i];
+            return true;
         }
-        p++;
     }
-#endif
+    return false;
+}
 
-    return in_word;
+const char* kernel_name(void) {
+    if (!active_kernel) active_kernel = best_kernel();
+    return active_kernel->name;
+}
+
+// The core logic for processing a buffer of data.
+// It takes the previous character's state to correctly handle words across buffer boundaries.
+bool process_buffer(const unsigned char* buffer, size_t size, Counts* counts, bool in_word_prev) {
+    if (!active_kernel) active_kernel = best_kernel();
+
+    // Byte count is trivial
+    counts->bytes += size;
+    return active_kernel->fn(buffer, size, counts, in_word_prev);
 }
 
 void process_file(const char* filename, FILE* fp, Counts* total_counts) {
     Counts file_counts = {0, 0, 0};
-    unsigned char buffer[BUFFER_SIZE];
+    static unsigned char buffer[BUFFER_SIZE];
     size_t bytes_read;
     bool in_word = false;
 
@@ -105,15 +321,32 @@ void process_file(const char* filename, FILE* fp, Counts* total_counts) {
     total_counts->bytes += file_counts.bytes;
 }
 
+#ifndef FAST_WC_NO_MAIN
 int main(int argc, char* argv[]) {
-    // Disable buffering on stdout for more immediate output
-    setvbuf(stdout, NULL, _IOLBF, 0);
+    // stdout stays fully buffered: the whole report leaves in one write
+
+    // FAST_WC_KERNEL=<name> pins a kernel, e.g. to benchmark one against another
+    const char* forced = getenv("FAST_WC_KERNEL");
+    if (forced && *forced && !use_kernel(forced)) {
+        fprintf(stderr, "fast_wc: kernel '%s' is not available on this CPU\n", forced);
+        return 1;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--print-kernel") == 0) {
+        if (!active_kernel) active_kernel = best_kernel();
+        printf("%s (%s)\n", active_kernel->name, active_kernel->level);
+        for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+            printf("  %-9s %-12s %s\n", kernels[i].name, kernels[i].level,
+                   kernels[i].supported() ? "supported" : "unsupported");
+        }
+        return 0;
+    }
 
     if (argc == 1) {
         // Process stdin
         Counts counts = {0, 0, 0};
         bool in_word = false;
-        unsigned char buffer[BUFFER_SIZE];
+        static unsigned char buffer[BUFFER_SIZE];
         size_t bytes_read;
 
         while ((bytes_read = fread(buffer, 1, BUFFER_SIZE, stdin)) > 0) {
@@ -139,3 +372,4 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
+#endif
@@ -0,0 +1,336 @@
+// pathological/patho.c
+// Adversarial-input performance suite for every wc entry. Each input class
+// is generated at doubling sizes, fed to each entry through a pipe or a
+// file, and the wall time and peak RSS are fitted against size on a log-log
+// scale: a slope near 1 is linear, anything well above it is the accidental
+// quadratic behaviour the contest README asks us to hunt.
+//   ./patho [--max=SIZE] [--steps=N] [--only=CLASS] [--timeout=SECS] NAME=BINARY ...
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#define MAX_ENTRIES 16
+#define MAX_STEPS 12
+#define SLOPE_FAIL 1.5     // time or memory exponent that counts as super-linear
+#define SLOPE_GROWS 0.5    // memory exponent of a pipe reader that keeps its input (a failure)
+#define MIN_FIT_SECS 0.005 // shorter runs are mostly exec and page-fault noise
+
+typedef enum { FEED_FILE, FEED_PIPE } feed_t;
+
+// One adversarial input: a byte pattern, how it is delivered and, for pipes,
+// how it is chopped into writes (so reads return short counts)
+typedef struct {
+    const char *name;
+    const char *what;
+    feed_t feed;
+    size_t write_size;   // 0: random 1..4096 per write
+    unsigned scale_shift; // sizes are divided by 2^shift (1-byte writes are slow)
+    char (*byte_at)(uint64_t off);
+} input_class_t;
+
+static char alt_byte(uint64_t off){ return off&1?' ':'a'; }
+static char line_byte(uint64_t off){ (void)off; return 'x'; }
+static char newline_byte(uint64_t off){ (void)off; return '\n'; }
+static char text_byte(uint64_t off){ return "lorem ipsum\tdolor sit\n"[off%22]; }
+
+static const input_class_t classes[]={
+    {"alt","alternating space/non-space",FEED_FILE,0,0,alt_byte},
+    {"alt-pipe","alternating space/non-space",FEED_PIPE,65536,0,alt_byte},
+    {"line","one line, no newline",FEED_FILE,0,0,line_byte},
+    {"line-pipe","one line, no newline",FEED_PIPE,65536,0,line_byte},
+    {"newlines","only newlines",FEED_FILE,0,0,newline_byte},
+    {"newlines-pipe","only newlines",FEED_PIPE,65536,0,newline_byte},
+    {"trickle","1-byte writes",FEED_PIPE,1,8,text_byte},
+    {"short","random short writes",FEED_PIPE,0,0,text_byte},
+};
+#define NCLASSES (sizeof(classes)/sizeof(classes[0]))
+
+typedef struct {
+    uint64_t lines,words,bytes;
+} counts_t;
+
+typedef struct {
+    double secs;
+    double rss_mb;
+    int status;  // 0 ok, or one of the RUN_ codes
+} run_t;
+
+enum { RUN_OK=0, RUN_TIMEOUT, RUN_CRASH, RUN_WRONG };
+static const char *run_status_names[]={"ok","TIMEOUT","CRASH","WRONG"};
+
+typedef struct {
+    const char *name;
+    const char *path;
+} entry_t;
+
+static volatile sig_atomic_t timed_out;
+static void on_alarm(int sig){ (void)sig; timed_out=1; }
+
+static double now(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static int parse_size(const char *s,uint64_t *out){
+    char *end;
+    unsigned long long v=strtoull(s,&end,10);
+    if(end==s) return -1;
+    switch(*end){
+        case 'G': v<<=10; /* fall through */
+        case 'M': v<<=10; /* fall through */
+        case 'K': v<<=10; end++; break;
+    }
+    if(*end) return -1;
+    *out=v;
+    return 0;
+}
+
+// Fill buf with bytes [off, off+n) of a class and count them the POSIX way
+static void generate(const input_class_t *ic,char *buf,size_t n,uint64_t off,counts_t *c,int *in_word){
+    for(size_t i=0;i<n;i++){
+        char ch=ic->byte_at(off+i);
+        int space=ch==' '||ch=='\n'||ch=='\t'||ch=='\r'||ch=='\v'||ch=='\f';
+        buf[i]=ch;
+        c->lines+=ch=='\n';
+        c->words+=!space&&!*in_word;
+        *in_word=!space;
+    }
+    c->bytes+=n;
+}
+
+static int write_file(const input_class_t *ic,const char *path,uint64_t size,counts_t *c){
+    enum { CHUNK=1<<20 };
+    char *buf=malloc(CHUNK);
+    int fd=open(path,O_WRONLY|O_CREAT|O_TRUNC,0644);
+    int in_word=0;
+    if(!buf||fd<0){perror(path);free(buf);if(fd>=0)close(fd);return -1;}
+    memset(c,0,sizeof(*c));
+    for(uint64_t off=0;off<size;off+=CHUNK){
+        size_t n=size-off<CHUNK?(size_t)(size-off):CHUNK;
+        generate(ic,buf,n,off,c,&in_word);
+        if(write(fd,buf,n)!=(ssize_t)n){perror("write");close(fd);free(buf);return -1;}
+    }
+    close(fd);
+    free(buf);
+    return 0;
+}
+
+// The output must mention the expected lines, words and bytes, whatever
+// the column layout of the entry
+static int has_number(const char *out,uint64_t want){
+    for(const char *p=out;*p;){
+        if(*p>='0'&&*p<='9'){
+            char *end;
+            unsigned long long v=strtoull(p,&end,10);
+            if(v==want) return 1;
+            p=end;
+        }else p++;
+    }
+    return 0;
+}
+
+// Run one entry on one input, streaming a pipe's bytes as they are generated
+static run_t run_one(const entry_t *e,const input_class_t *ic,uint64_t size,const char *file,
+                     const counts_t *file_counts,unsigned timeout){
+    run_t r={0,0,RUN_OK};
+    int in_pipe[2]={-1,-1},out_pipe[2];
+    counts_t c={0,0,0};
+    if(pipe(out_pipe)||(ic->feed==FEED_PIPE&&pipe(in_pipe))){perror("pipe");exit(2);}
+    double t0=now();
+    pid_t pid=fork();
+    if(pid<0){perror("fork");exit(2);}
+    if(pid==0){
+        int devnull=open("/dev/null",O_WRONLY);
+        if(ic->feed==FEED_PIPE){ dup2(in_pipe[0],STDIN_FILENO); close(in_pipe[0]); close(in_pipe[1]); }
+        dup2(out_pipe[1],STDOUT_FILENO);
+        if(devnull>=0) dup2(devnull,STDERR_FILENO);
+        close(out_pipe[0]); close(out_pipe[1]);
+        if(ic->feed==FEED_PIPE) execl(e->path,e->path,(char*)NULL);
+        else execl(e->path,e->path,file,(char*)NULL);
+        _exit(127);
+    }
+    close(out_pipe[1]);
+    timed_out=0;
+    alarm(timeout);
+
+    if(ic->feed==FEED_PIPE){
+        enum { CHUNK=1<<16 };
+        static char buf[CHUNK];
+        int in_word=0;
+        close(in_pipe[0]);
+        srand(42);
+        for(uint64_t off=0;off<size&&!timed_out;){
+            size_t n=size-off<CHUNK?(size_t)(size-off):CHUNK;
+            generate(ic,buf,n,off,&c,&in_word);
+            for(size_t done=0;done<n&&!timed_out;){
+                size_t w=ic->write_size?ic->write_size:1+(size_t)rand()%4096;
+                if(w>n-done) w=n-done;
+                ssize_t k=write(in_pipe[1],buf+done,w);
+                if(k<0){ if(errno==EINTR) continue; off=size; break; }  // reader gone
+                done+=(size_t)k;
+            }
+            off+=n;
+        }
+        close(in_pipe[1]);
+    }else{
+        c=*file_counts;
+    }
+
+    char out[4096];
+    size_t got=0;
+    while(!timed_out&&got<sizeof(out)-1){
+        ssize_t k=read(out_pipe[0],out+got,sizeof(out)-1-got);
+        if(k<0&&errno==EINTR) continue;
+        if(k<=0) break;
+        got+=(size_t)k;
+    }
+    out[got]='\0';
+    close(out_pipe[0]);
+
+    int status;
+    struct rusage ru;
+    if(timed_out) kill(pid,SIGKILL);
+    while(wait4(pid,&status,0,&ru)<0){
+        if(errno!=EINTR){perror("wait4");exit(2);}
+        if(timed_out) kill(pid,SIGKILL);
+    }
+    alarm(0);
+    r.secs=now()-t0;
+#ifdef __APPLE__
+    r.rss_mb=ru.ru_maxrss/(1024.0*1024.0);  // bytes on Darwin
+#else
+    r.rss_mb=ru.ru_maxrss/1024.0;           // KiB on Linux
+#endif
+    if(timed_out) r.status=RUN_TIMEOUT;
+    else if(!WIFEXITED(status)||WEXITSTATUS(status)!=0) r.status=RUN_CRASH;
+    else if(!has_number(out,c.lines)||!has_number(out,c.words)||!has_number(out,c.bytes)) r.status=RUN_WRONG;
+    return r;
+}
+
+// Least-squares slope of log(y) over log(x), using the points with y > floor
+static double loglog_slope(const uint64_t *x,const double *y,int n,double floor,int *used){
+    double sx=0,sy=0,sxx=0,sxy=0;
+    int k=0;
+    for(int i=0;i<n;i++){
+        if(y[i]<=floor) continue;
+        double lx=log((double)x[i]),ly=log(y[i]);
+        sx+=lx; sy+=ly; sxx+=lx*lx; sxy+=lx*ly; k++;
+    }
+    *used=k;
+    if(k<3) return NAN;
+    return (k*sxy-sx*sy)/(k*sxx-sx*sx);
+}
+
+// A fitted exponent, or "-" when there were too few points to fit one
+static const char *fmt_exp(double v,char *buf,size_t cap){
+    if(isnan(v)) return "-";
+    snprintf(buf,cap,"%.2f",v);
+    return buf;
+}
+
+static void usage(const char *prog){
+    fprintf(stderr,"Usage: %s [--max=SIZE] [--steps=N] [--only=CLASS] [--timeout=SECS] NAME=BINARY ...\n"
+                   "  SIZE takes K/M/G suffixes (default 64M); CLASS is one of:",prog);
+    for(size_t i=0;i<NCLASSES;i++) fprintf(stderr," %s",classes[i].name);
+    fputc('\n',stderr);
+}
+
+int main(int argc,char **argv){
+    uint64_t max=64ull<<20;
+    int steps=4;
+    unsigned timeout=60;
+    const char *only=NULL;
+    entry_t entries[MAX_ENTRIES];
+    int nentries=0;
+
+    for(int i=1;i<argc;i++){
+        const char *a=argv[i];
+        if(!strncmp(a,"--max=",6)){ if(parse_size(a+6,&max)||max<4096){usage(argv[0]);return 2;} }
+        else if(!strncmp(a,"--steps=",8)) steps=atoi(a+8);
+        else if(!strncmp(a,"--only=",7)) only=a+7;
+        else if(!strncmp(a,"--timeout=",10)) timeout=(unsigned)atoi(a+10);
+        else if(strchr(a,'=')&&a[0]!='-'&&nentries<MAX_ENTRIES){
+            char *eq=strchr(a,'=');
+            *eq='\0';
+            entries[nentries++]=(entry_t){a,eq+1};
+        }
+        else {usage(argv[0]);return 2;}
+    }
+    if(nentries==0||steps<1||steps>MAX_STEPS||timeout==0){usage(argv[0]);return 2;}
+
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler=on_alarm;  // no SA_RESTART: a blocked write or wait returns EINTR
+    sigaction(SIGALRM,&sa,NULL);
+    signal(SIGPIPE,SIG_IGN);
+
+    const char *tmp=getenv("TMPDIR");
+    char file[4096];
+    snprintf(file,sizeof(file),"%s/patho_input.%d",tmp?tmp:"/tmp",(int)getpid());
+
+    printf("%-22s %-14s %10s %9s %7s %9s %7s  %s\n",
+           "entry","input","max size","MB/s","t-exp","peak MB","m-exp","verdict");
+    int failures=0,unfit=0;
+    for(size_t ci=0;ci<NCLASSES;ci++){
+        const input_class_t *ic=&classes[ci];
+        if(only&&strcmp(only,ic->name)) continue;
+        uint64_t sizes[MAX_STEPS];
+        for(int s=0;s<steps;s++) sizes[s]=(max>>ic->scale_shift)>>(steps-1-s);
+        run_t runs[MAX_ENTRIES][MAX_STEPS];
+        int dead[MAX_ENTRIES]={0};
+
+        for(int s=0;s<steps;s++){
+            counts_t fc={0,0,0};
+            if(ic->feed==FEED_FILE&&write_file(ic,file,sizes[s],&fc)) return 2;
+            for(int e=0;e<nentries;e++){
+                if(dead[e]){ runs[e][s]=runs[e][s-1]; continue; }
+                runs[e][s]=run_one(&entries[e],ic,sizes[s],file,&fc,timeout);
+                // Best of two for the timing, so one scheduler hiccup is not a slope
+                if(runs[e][s].status==RUN_OK){
+                    run_t again=run_one(&entries[e],ic,sizes[s],file,&fc,timeout);
+                    if(again.status==RUN_OK&&again.secs<runs[e][s].secs) runs[e][s].secs=again.secs;
+                }
+                if(runs[e][s].status!=RUN_OK) dead[e]=1;
+            }
+            if(ic->feed==FEED_FILE) unlink(file);
+        }
+
+        for(int e=0;e<nentries;e++){
+            double t[MAX_STEPS],m[MAX_STEPS];
+            int last=steps-1,used_t,used_m;
+            for(int s=0;s<steps;s++){ t[s]=runs[e][s].secs; m[s]=runs[e][s].rss_mb; }
+            double texp=loglog_slope(sizes,t,steps,MIN_FIT_SECS,&used_t);
+            double mexp=loglog_slope(sizes,m,steps,0.0,&used_m);
+            // Mapped files show up in RSS, so only a pipe reader can be said to buffer
+            int grows=ic->feed==FEED_PIPE&&mexp>SLOPE_GROWS&&m[last]*1048576.0>0.5*(double)sizes[last];
+            const char *verdict="ok";
+            if(runs[e][last].status!=RUN_OK) verdict=run_status_names[runs[e][last].status];
+            else if(texp>SLOPE_FAIL) verdict="SUPER-LINEAR TIME";
+            else if(mexp>SLOPE_FAIL) verdict="SUPER-LINEAR MEMORY";
+            else if(grows) verdict="MEMORY GROWS WITH INPUT";
+            // NaN compares false above, so an unfitted time must not read as a pass
+            else if(isnan(texp)){ verdict="too fast"; unfit++; }
+            if(runs[e][last].status!=RUN_OK||texp>SLOPE_FAIL||mexp>SLOPE_FAIL||grows) failures++;
+            char tbuf[16],mbuf[16];
+            printf("%-22s %-14s %9.1fM %9.1f %7s %9.1f %7s  %s\n",entries[e].name,ic->name,
+                   sizes[last]/1048576.0,sizes[last]/1048576.0/t[last],fmt_exp(texp,tbuf,sizeof tbuf),
+                   m[last],fmt_exp(mexp,mbuf,sizeof mbuf),verdict);
+        }
+        fflush(stdout);
+    }
+    if(unfit) printf("%d entry/input pairs had fewer than 3 runs over %g s; raise --max to check them\n",
+                     unfit,MIN_FIT_SECS);
+    if(failures) printf("%d entry/input pairs flagged\n",failures);
+    return failures?1:0;
+}
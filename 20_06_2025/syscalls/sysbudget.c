@@ -0,0 +1,531 @@
+// syscalls/sysbudget.c
+// Syscall-budget suite for every wc entry. Each entry runs under a ptrace
+// tracer (what strace -f does) on fixed generated inputs. The tracer sees
+// every syscall of the process and its threads and children, along with
+// the arguments, so it can tell reads of the input from reads of shared
+// libraries. These budgets are asserted:
+//   reads/GiB    read-like syscalls on the input file, scaled to 1 GiB
+//   mmap         no mapping of an input file smaller than --mmap-min
+//   mm growth    brk/mremap/munmap/anonymous mmap calls may not grow with
+//                input size: a realloc per read shows up here
+//   writes       the whole report leaves in one write to stdout
+// A per-entry syscall profile (every syscall with its count, per input)
+// goes to --report=DIR.
+//   ./sysbudget [--size=SIZE] [--small=SIZE] [--mmap-min=SIZE] [--reads-per-gib=N]
+//               [--mm-growth=N] [--report=DIR] [--timeout=SECS] NAME=BINARY ...
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#define MAX_ENTRIES 16
+#define MAX_TRACEES 256   // threads and forked workers of one run
+#define MAX_FDS 1024
+#define MAX_NR 1024       // syscall numbers histogrammed
+#define GIB (1ull<<30)
+
+// Syscalls named in reports; anything else prints as its number
+static const struct { long nr; const char *name; } syscall_names[]={
+    {SYS_read,"read"},{SYS_write,"write"},{SYS_pread64,"pread64"},{SYS_pwrite64,"pwrite64"},
+    {SYS_readv,"readv"},{SYS_writev,"writev"},{SYS_preadv,"preadv"},{SYS_preadv2,"preadv2"},
+    {SYS_openat,"openat"},{SYS_close,"close"},{SYS_fstat,"fstat"},{SYS_newfstatat,"newfstatat"},
+    {SYS_statx,"statx"},{SYS_lseek,"lseek"},{SYS_mmap,"mmap"},{SYS_munmap,"munmap"},
+    {SYS_mremap,"mremap"},{SYS_mprotect,"mprotect"},{SYS_madvise,"madvise"},{SYS_brk,"brk"},
+    {SYS_fadvise64,"fadvise64"},{SYS_readahead,"readahead"},{SYS_ioctl,"ioctl"},
+    {SYS_fcntl,"fcntl"},{SYS_clone,"clone"},{SYS_clone3,"clone3"},{SYS_wait4,"wait4"},
+    {SYS_futex,"futex"},{SYS_exit,"exit"},{SYS_exit_group,"exit_group"},{SYS_execve,"execve"},
+    {SYS_rt_sigaction,"rt_sigaction"},{SYS_rt_sigprocmask,"rt_sigprocmask"},
+    {SYS_set_robust_list,"set_robust_list"},{SYS_set_tid_address,"set_tid_address"},
+    {SYS_rseq,"rseq"},{SYS_prlimit64,"prlimit64"},{SYS_getrandom,"getrandom"},
+    {SYS_faccessat,"faccessat"},{SYS_getdents64,"getdents64"},{SYS_sched_getaffinity,"sched_getaffinity"},
+    {SYS_sched_yield,"sched_yield"},{SYS_getpid,"getpid"},{SYS_gettid,"gettid"},
+    {SYS_sysinfo,"sysinfo"},{SYS_uname,"uname"},{SYS_io_uring_setup,"io_uring_setup"},
+    {SYS_io_uring_enter,"io_uring_enter"},{SYS_inotify_init1,"inotify_init1"},
+#ifdef SYS_arch_prctl
+    {SYS_arch_prctl,"arch_prctl"},
+#endif
+#ifdef SYS_open
+    {SYS_open,"open"},
+#endif
+#ifdef SYS_stat
+    {SYS_stat,"stat"},
+#endif
+#ifdef SYS_access
+    {SYS_access,"access"},
+#endif
+#ifdef SYS_fork
+    {SYS_fork,"fork"},
+#endif
+#ifdef SYS_vfork
+    {SYS_vfork,"vfork"},
+#endif
+};
+
+static const char *syscall_name(long nr,char *buf,size_t cap){
+    for(size_t i=0;i<sizeof(syscall_names)/sizeof(syscall_names[0]);i++)
+        if(syscall_names[i].nr==nr) return syscall_names[i].name;
+    snprintf(buf,cap,"syscall_%ld",nr);
+    return buf;
+}
+
+typedef enum { FEED_FILE, FEED_PIPE, FEED_FILES } feed_t;
+
+// One fixed input. Sizes are given as a fraction of --size, or are --small.
+typedef struct {
+    const char *name;
+    feed_t feed;
+    unsigned size_shift;  // --size >> shift; ignored for small inputs
+    int small;            // --small bytes
+} input_t;
+
+enum { IN_SMALL, IN_FILE_16TH, IN_FILE, IN_PIPE_16TH, IN_PIPE, IN_FILES, NINPUTS };
+static const input_t inputs[NINPUTS]={
+    {"small",FEED_FILE,0,1},
+    {"file/16",FEED_FILE,4,0},
+    {"file",FEED_FILE,0,0},
+    {"pipe/16",FEED_PIPE,4,0},
+    {"pipe",FEED_PIPE,0,0},
+    {"3 files",FEED_FILES,0,1},
+};
+
+typedef struct {
+    uint64_t lines,words,bytes;
+} counts_t;
+
+// What one traced run did
+typedef struct {
+    uint64_t calls[MAX_NR];
+    uint64_t total;
+    uint64_t in_reads,in_read_bytes;  // read-like syscalls on an input fd
+    uint64_t in_mmaps;                // mappings of an input fd
+    uint64_t mm_calls;                // brk, mremap, munmap, anonymous mmap
+    uint64_t out_writes;              // writes to stdout
+    int status;
+    double secs;
+} trace_t;
+
+enum { RUN_OK=0, RUN_TIMEOUT, RUN_CRASH, RUN_WRONG, RUN_NOTRACE };
+static const char *run_status_names[]={"ok","TIMEOUT","CRASH","WRONG","cannot trace"};
+
+typedef struct {
+    pid_t pid;
+    int seen;             // past its first stop
+    uint64_t nr,args[6];  // saved at entry: args are gone by the exit stop on arm64
+} tracee_t;
+
+typedef struct {
+    const char *name;
+    const char *path;
+} entry_t;
+
+static volatile sig_atomic_t timed_out;
+static void on_alarm(int sig){ (void)sig; timed_out=1; }
+
+static double now(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+static int parse_size(const char *s,uint64_t *out){
+    char *end;
+    unsigned long long v=strtoull(s,&end,10);
+    if(end==s) return -1;
+    switch(*end){
+        case 'G': v<<=10; /* fall through */
+        case 'M': v<<=10; /* fall through */
+        case 'K': v<<=10; end++; break;
+    }
+    if(*end) return -1;
+    *out=v;
+    return 0;
+}
+
+// Plain text, so every entry takes its ordinary path
+static void generate(char *buf,size_t n,uint64_t off,counts_t *c,int *in_word){
+    static const char text[]="lorem ipsum\tdolor sit\n";
+    for(size_t i=0;i<n;i++){
+        char ch=text[(off+i)%(sizeof(text)-1)];
+        int space=ch==' '||ch=='\n'||ch=='\t';
+        buf[i]=ch;
+        c->lines+=ch=='\n';
+        c->words+=!space&&!*in_word;
+        *in_word=!space;
+    }
+    c->bytes+=n;
+}
+
+static int write_file(const char *path,uint64_t size,counts_t *c){
+    enum { CHUNK=1<<20 };
+    char *buf=malloc(CHUNK);
+    int fd=open(path,O_WRONLY|O_CREAT|O_TRUNC,0644);
+    int in_word=0;
+    if(!buf||fd<0){perror(path);free(buf);if(fd>=0)close(fd);return -1;}
+    memset(c,0,sizeof(*c));
+    for(uint64_t off=0;off<size;off+=CHUNK){
+        size_t n=size-off<CHUNK?(size_t)(size-off):CHUNK;
+        generate(buf,n,off,c,&in_word);
+        if(write(fd,buf,n)!=(ssize_t)n){perror("write");close(fd);free(buf);return -1;}
+    }
+    close(fd);
+    free(buf);
+    return 0;
+}
+
+// Feeds a pipe in 1 MiB writes from its own process, so the tracer only
+// has to wait for stops
+static pid_t start_feeder(int fd,uint64_t size){
+    pid_t pid=fork();
+    if(pid<0){perror("fork");exit(2);}
+    if(pid) return pid;
+    enum { CHUNK=1<<20 };
+    static char buf[CHUNK];
+    counts_t c={0,0,0};
+    int in_word=0;
+    for(uint64_t off=0;off<size;off+=CHUNK){
+        size_t n=size-off<CHUNK?(size_t)(size-off):CHUNK;
+        generate(buf,n,off,&c,&in_word);
+        for(size_t done=0;done<n;){
+            ssize_t k=write(fd,buf+done,n-done);
+            if(k<0){ if(errno==EINTR) continue; _exit(0); }  // reader gone
+            done+=(size_t)k;
+        }
+    }
+    _exit(0);
+}
+
+static int has_number(const char *out,uint64_t want){
+    for(const char *p=out;*p;){
+        if(*p>='0'&&*p<='9'){
+            char *end;
+            unsigned long long v=strtoull(p,&end,10);
+            if(v==want) return 1;
+            p=end;
+        }else p++;
+    }
+    return 0;
+}
+
+static tracee_t *tracee_find(tracee_t *t,int n,pid_t pid){
+    for(int i=0;i<n;i++) if(t[i].pid==pid) return &t[i];
+    return NULL;
+}
+
+// NUL-terminated string at addr in the tracee, cut at cap-1 bytes
+static void peek_string(pid_t pid,uint64_t addr,char *buf,size_t cap){
+    size_t got=0;
+    while(got+1<cap){
+        errno=0;
+        long word=ptrace(PTRACE_PEEKDATA,pid,(void*)(uintptr_t)(addr+got),NULL);
+        if(errno) break;
+        for(size_t i=0;i<sizeof(word)&&got+1<cap;i++){
+            char ch=((const char*)&word)[i];
+            buf[got++]=ch;
+            if(!ch) return;
+        }
+    }
+    buf[got]='\0';
+}
+
+static int is_read_call(uint64_t nr){
+    return nr==SYS_read||nr==SYS_pread64||nr==SYS_readv||nr==SYS_preadv||nr==SYS_preadv2;
+}
+
+static int is_write_call(uint64_t nr){
+    return nr==SYS_write||nr==SYS_pwrite64||nr==SYS_writev;
+}
+
+// Book one finished syscall. input_fd marks the descriptors that refer to
+// an input: stdin for pipes, or whatever openat returned for an input path.
+static void account(trace_t *tr,const tracee_t *t,int64_t rval,uint8_t *input_fd,
+                    char *const *files,int nfiles){
+    uint64_t nr=t->nr,fd=t->args[0];
+    if(nr==SYS_openat&&rval>=0&&rval<MAX_FDS){
+        char path[4096];
+        peek_string(t->pid,t->args[1],path,sizeof(path));
+        input_fd[rval]=0;
+        for(int i=0;i<nfiles;i++) if(!strcmp(path,files[i])) input_fd[rval]=1;
+    }
+    if(is_read_call(nr)&&fd<MAX_FDS&&input_fd[fd]){
+        tr->in_reads++;
+        if(rval>0) tr->in_read_bytes+=(uint64_t)rval;
+    }
+    if(is_write_call(nr)&&fd==STDOUT_FILENO) tr->out_writes++;
+    if(nr==SYS_mmap){
+        uint64_t mfd=t->args[4];
+        if(t->args[3]&MAP_ANONYMOUS) tr->mm_calls++;
+        else if(mfd<MAX_FDS&&input_fd[mfd]) tr->in_mmaps++;
+    }
+    if(nr==SYS_brk||nr==SYS_mremap||nr==SYS_munmap) tr->mm_calls++;
+}
+
+// Run one entry on one input under ptrace, following threads and forks
+static void trace_one(const entry_t *e,const input_t *in,uint64_t size,char *const *files,int nfiles,
+                      const counts_t *want,unsigned timeout,trace_t *tr){
+    int in_pipe[2]={-1,-1},out_pipe[2];
+    memset(tr,0,sizeof(*tr));
+    if(pipe(out_pipe)||(in->feed==FEED_PIPE&&pipe(in_pipe))){perror("pipe");exit(2);}
+    // Let a reader ask for large reads and get them
+    if(in->feed==FEED_PIPE) fcntl(in_pipe[1],F_SETPIPE_SZ,1<<20);
+    double t0=now();
+    pid_t pid=fork();
+    if(pid<0){perror("fork");exit(2);}
+    if(pid==0){
+        int devnull=open("/dev/null",O_RDWR);
+        if(in->feed==FEED_PIPE) dup2(in_pipe[0],STDIN_FILENO);
+        else if(devnull>=0) dup2(devnull,STDIN_FILENO);
+        if(in->feed==FEED_PIPE){ close(in_pipe[0]); close(in_pipe[1]); }
+        dup2(out_pipe[1],STDOUT_FILENO);
+        if(devnull>=0){ dup2(devnull,STDERR_FILENO); close(devnull); }
+        close(out_pipe[0]); close(out_pipe[1]);
+        char *argv[8]={(char*)e->path};
+        if(in->feed!=FEED_PIPE) for(int i=0;i<nfiles;i++) argv[1+i]=files[i];
+        if(ptrace(PTRACE_TRACEME,0,NULL,NULL)) _exit(126);
+        raise(SIGSTOP);
+        execv(e->path,argv);
+        _exit(127);
+    }
+    close(out_pipe[1]);
+    pid_t feeder=-1;
+    if(in->feed==FEED_PIPE){
+        close(in_pipe[0]);
+        feeder=start_feeder(in_pipe[1],size);
+        close(in_pipe[1]);
+    }
+
+    static tracee_t tracees[MAX_TRACEES];
+    static uint8_t input_fd[MAX_FDS];
+    int ntracees=0,status=0,started=0;
+    memset(input_fd,0,sizeof(input_fd));
+    if(in->feed==FEED_PIPE) input_fd[STDIN_FILENO]=1;
+    timed_out=0;
+    alarm(timeout);
+    for(;;){
+        int st;
+        pid_t w=waitpid(-1,&st,__WALL);
+        if(w<0){
+            if(errno!=EINTR) break;  // nothing left to wait for
+            if(timed_out) kill(pid,SIGKILL);
+            continue;
+        }
+        if(w==feeder){ feeder=-1; continue; }
+        tracee_t *t=tracee_find(tracees,ntracees,w);
+        if(WIFEXITED(st)||WIFSIGNALED(st)){
+            if(w==pid) status=st;
+            if(t) *t=tracees[--ntracees];
+            if(w==pid&&!started) break;
+            continue;
+        }
+        if(!WIFSTOPPED(st)) continue;
+        int sig=WSTOPSIG(st),inject=0;
+        if(!t&&ntracees<MAX_TRACEES){  // the child, or a new thread or fork of it
+            t=&tracees[ntracees++];
+            memset(t,0,sizeof(*t));
+            t->pid=w;
+        }
+        if(w==pid&&!started){
+            started=1;
+            if(ptrace(PTRACE_SETOPTIONS,pid,NULL,(void*)(long)(PTRACE_O_TRACESYSGOOD|PTRACE_O_TRACEFORK|
+                      PTRACE_O_TRACEVFORK|PTRACE_O_TRACECLONE|PTRACE_O_TRACEEXEC|PTRACE_O_EXITKILL))){
+                kill(pid,SIGKILL);
+                tr->status=RUN_NOTRACE;
+            }
+        }else if(sig==(SIGTRAP|0x80)){
+            struct __ptrace_syscall_info si;
+            if(t&&ptrace(PTRACE_GET_SYSCALL_INFO,w,(void*)sizeof(si),&si)>0){
+                if(si.op==PTRACE_SYSCALL_INFO_ENTRY){
+                    t->nr=si.entry.nr;
+                    memcpy(t->args,si.entry.args,sizeof(t->args));
+                    if(t->nr<MAX_NR) tr->calls[t->nr]++;
+                    tr->total++;
+                }else if(si.op==PTRACE_SYSCALL_INFO_EXIT){
+                    account(tr,t,si.exit.rval,input_fd,files,nfiles);
+                }
+            }
+        }else if(sig==SIGTRAP&&(st>>16)){
+            // fork, clone or exec event: nothing to deliver
+        }else if(sig==SIGSTOP&&t&&!t->seen){
+            // first stop of a new thread or fork
+        }else{
+            inject=sig;
+        }
+        if(t) t->seen=1;
+        if(timed_out) kill(pid,SIGKILL);
+        ptrace(PTRACE_SYSCALL,w,NULL,(void*)(long)inject);
+    }
+    alarm(0);
+    if(feeder>0){ kill(feeder,SIGKILL); waitpid(feeder,NULL,0); }
+    tr->secs=now()-t0;
+
+    char out[4096];
+    size_t got=0;
+    for(;;){
+        ssize_t k=read(out_pipe[0],out+got,sizeof(out)-1-got);
+        if(k<0&&errno==EINTR) continue;
+        if(k<=0||(got+=(size_t)k)==sizeof(out)-1) break;
+    }
+    out[got]='\0';
+    close(out_pipe[0]);
+
+    if(tr->status) return;
+    if(timed_out) tr->status=RUN_TIMEOUT;
+    else if(!WIFEXITED(status)||WEXITSTATUS(status)!=0) tr->status=RUN_CRASH;
+    else if(!has_number(out,want->lines)||!has_number(out,want->words)||!has_number(out,want->bytes))
+        tr->status=RUN_WRONG;
+}
+
+// Every syscall of every run of one entry, most frequent first
+static void write_report(const char *dir,const entry_t *e,const trace_t *tr,const uint64_t *sizes){
+    char path[4096],name[32];
+    snprintf(path,sizeof(path),"%s/%s.txt",dir,e->name);
+    FILE *fp=fopen(path,"w");
+    if(!fp){perror(path);return;}
+    fprintf(fp,"%s (%s)\n",e->name,e->path);
+    for(int i=0;i<NINPUTS;i++){
+        const trace_t *t=&tr[i];
+        fprintf(fp,"\n%s, %llu bytes: %s, %llu syscalls in %.3f s\n",inputs[i].name,
+                (unsigned long long)sizes[i],run_status_names[t->status],(unsigned long long)t->total,t->secs);
+        fprintf(fp,"  input reads %llu (%llu bytes), input mmaps %llu, memory calls %llu, stdout writes %llu\n",
+                (unsigned long long)t->in_reads,(unsigned long long)t->in_read_bytes,
+                (unsigned long long)t->in_mmaps,(unsigned long long)t->mm_calls,
+                (unsigned long long)t->out_writes);
+        uint8_t done[MAX_NR]={0};
+        for(;;){
+            long best=-1;
+            for(long nr=0;nr<MAX_NR;nr++)
+                if(!done[nr]&&t->calls[nr]&&(best<0||t->calls[nr]>t->calls[best])) best=nr;
+            if(best<0) break;
+            done[best]=1;
+            fprintf(fp,"  %10llu  %s\n",(unsigned long long)t->calls[best],syscall_name(best,name,sizeof(name)));
+        }
+    }
+    fclose(fp);
+}
+
+// Append one budget failure to a verdict
+static void flag(char *verdict,size_t cap,size_t *len,const char *fmt,...){
+    va_list ap;
+    if(*len&&*len<cap) *len+=(size_t)snprintf(verdict+*len,cap-*len,"; ");
+    va_start(ap,fmt);
+    if(*len<cap) *len+=(size_t)vsnprintf(verdict+*len,cap-*len,fmt,ap);
+    va_end(ap);
+}
+
+static void usage(const char *prog){
+    fprintf(stderr,"Usage: %s [--size=SIZE] [--small=SIZE] [--mmap-min=SIZE] [--reads-per-gib=N]\n"
+                   "          [--mm-growth=N] [--report=DIR] [--timeout=SECS] NAME=BINARY ...\n"
+                   "  SIZE takes K/M/G suffixes (defaults 256M, 4K, 64K); N defaults 4096 and 16\n",prog);
+}
+
+int main(int argc,char **argv){
+    uint64_t size=256ull<<20,small=4096,mmap_min=64<<10;
+    uint64_t reads_per_gib=4096,mm_growth=16;
+    unsigned timeout=120;
+    const char *report=NULL;
+    entry_t entries[MAX_ENTRIES];
+    int nentries=0;
+
+    for(int i=1;i<argc;i++){
+        const char *a=argv[i];
+        if(!strncmp(a,"--size=",7)){ if(parse_size(a+7,&size)||size<(1u<<20)){usage(argv[0]);return 2;} }
+        else if(!strncmp(a,"--small=",8)){ if(parse_size(a+8,&small)||!small){usage(argv[0]);return 2;} }
+        else if(!strncmp(a,"--mmap-min=",11)){ if(parse_size(a+11,&mmap_min)){usage(argv[0]);return 2;} }
+        else if(!strncmp(a,"--reads-per-gib=",16)) reads_per_gib=strtoull(a+16,NULL,10);
+        else if(!strncmp(a,"--mm-growth=",12)) mm_growth=strtoull(a+12,NULL,10);
+        else if(!strncmp(a,"--report=",9)) report=a+9;
+        else if(!strncmp(a,"--timeout=",10)) timeout=(unsigned)atoi(a+10);
+        else if(strchr(a,'=')&&a[0]!='-'&&nentries<MAX_ENTRIES){
+            char *eq=strchr(a,'=');
+            *eq='\0';
+            entries[nentries++]=(entry_t){a,eq+1};
+        }
+        else {usage(argv[0]);return 2;}
+    }
+    if(nentries==0||timeout==0||reads_per_gib==0){usage(argv[0]);return 2;}
+    if(report&&mkdir(report,0755)&&errno!=EEXIST){perror(report);return 2;}
+
+    struct sigaction sa;
+    memset(&sa,0,sizeof(sa));
+    sa.sa_handler=on_alarm;  // no SA_RESTART: a blocked waitpid returns EINTR
+    sigaction(SIGALRM,&sa,NULL);
+    signal(SIGPIPE,SIG_IGN);
+
+    // The corpus: one small file and the two large ones, written once
+    const char *tmp=getenv("TMPDIR");
+    char paths[3][4096];
+    uint64_t file_sizes[3]={small,size>>4,size};
+    counts_t file_counts[3];
+    for(int i=0;i<3;i++){
+        snprintf(paths[i],sizeof(paths[i]),"%s/sysbudget_input%d.%d",tmp?tmp:"/tmp",i,(int)getpid());
+        if(write_file(paths[i],file_sizes[i],&file_counts[i])) return 2;
+    }
+    char *small_files[3]={paths[0],paths[0],paths[0]};
+    counts_t three={file_counts[0].lines*3,file_counts[0].words*3,file_counts[0].bytes*3};
+
+    printf("%-22s %-8s %9s %9s %9s %10s %9s %9s %7s  %s\n","entry","input","size","syscalls",
+           "in-reads","reads/GiB","in-mmaps","mm-calls","writes","verdict");
+    int failures=0;
+    for(int ei=0;ei<nentries;ei++){
+        const entry_t *e=&entries[ei];
+        trace_t tr[NINPUTS];
+        uint64_t sizes[NINPUTS];
+        for(int i=0;i<NINPUTS;i++){
+            const input_t *in=&inputs[i];
+            char *file[1];
+            const counts_t *want;
+            int nfiles=1;
+            if(in->feed==FEED_FILES){ sizes[i]=small*3; want=&three; nfiles=3; }
+            else{
+                int f=in->small?0:in->size_shift?1:2;
+                sizes[i]=in->small?small:size>>in->size_shift;
+                file[0]=paths[f];
+                want=&file_counts[f];
+            }
+            trace_one(e,in,sizes[i],in->feed==FEED_FILES?small_files:file,nfiles,want,timeout,&tr[i]);
+        }
+
+        for(int i=0;i<NINPUTS;i++){
+            const trace_t *t=&tr[i];
+            char verdict[256]="ok";
+            size_t vl=0;
+            uint64_t per_gib=(t->in_reads*GIB+sizes[i]-1)/sizes[i];
+#define FLAG(...) flag(verdict,sizeof(verdict),&vl,__VA_ARGS__)
+            if(t->status!=RUN_OK) FLAG("%s",run_status_names[t->status]);
+            else{
+                // Pipe reads are sized by the pipe and the scheduler, so only files are held to it
+                if(inputs[i].feed==FEED_FILE&&sizes[i]>=(1u<<20)&&per_gib>reads_per_gib)
+                    FLAG("reads/GiB over %llu",(unsigned long long)reads_per_gib);
+                if(inputs[i].feed!=FEED_PIPE&&small<mmap_min&&inputs[i].small&&t->in_mmaps)
+                    FLAG("mmap of a %llu-byte file",(unsigned long long)small);
+                if(t->out_writes!=1) FLAG("%llu writes to stdout",(unsigned long long)t->out_writes);
+                if((i==IN_FILE||i==IN_PIPE)&&tr[i-1].status==RUN_OK&&t->mm_calls>tr[i-1].mm_calls+mm_growth)
+                    FLAG("memory calls grow %llu -> %llu",(unsigned long long)tr[i-1].mm_calls,
+                         (unsigned long long)t->mm_calls);
+            }
+#undef FLAG
+            if(vl) failures++;
+            char rate[24]="-";  // meaningless for a few KiB
+            if(sizes[i]>=(1u<<20)) snprintf(rate,sizeof(rate),"%llu",(unsigned long long)per_gib);
+            printf("%-22s %-8s %8.1fM %9llu %9llu %10s %9llu %9llu %7llu  %s\n",e->name,inputs[i].name,
+                   sizes[i]/1048576.0,(unsigned long long)t->total,(unsigned long long)t->in_reads,
+                   rate,(unsigned long long)t->in_mmaps,
+                   (unsigned long long)t->mm_calls,(unsigned long long)t->out_writes,verdict);
+        }
+        if(report) write_report(report,e,tr,sizes);
+        fflush(stdout);
+    }
+    for(int i=0;i<3;i++) unlink(paths[i]);
+    if(failures) printf("%d entry/input pairs over budget\n",failures);
+    return failures?1:0;
+}